@@ -0,0 +1,332 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+#include <ItemEventBatcher.h>
+
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Minimal stand-ins for the engine types that the cores pass around. The cores only ever store
+ * and forward pointers to them, so all they need is an identity.
+ */
+namespace RE {
+    class TESForm {
+    public:
+        Core::FormID formID = 0;
+    };
+
+    class TESObjectREFR : public TESForm {};
+}  // namespace RE
+
+/**
+ * Host implementations of the engine interfaces, for driving the cores without the game.
+ */
+namespace MockEngine {
+
+    /**
+     * Form lookups in a fixed set of forms, created up front.
+     */
+    class MockFormLookup : public Core::IFormLookup {
+
+    public:
+        void AddForm(Core::FormID formID) { forms.try_emplace(formID).first->second.formID = formID; }
+
+        void AddReference(Core::FormID formID) {
+            references.try_emplace(formID).first->second.formID = formID;
+        }
+
+        void AddFormList(Core::FormID formListID, std::vector<Core::FormID> formIDs) {
+            formLists[formListID] = std::unordered_set<Core::FormID>(formIDs.begin(), formIDs.end());
+        }
+
+        void AddPlayerTeammate(Core::FormID formID) { teammates.insert(formID); }
+
+        virtual RE::TESForm* LookupForm(Core::FormID formID) const override {
+            const auto it = forms.find(formID);
+            return it != forms.end() ? const_cast<RE::TESForm*>(&it->second) : nullptr;
+        }
+
+        virtual RE::TESObjectREFR* LookupReference(Core::FormID formID) const override {
+            const auto it = references.find(formID);
+            return it != references.end() ? const_cast<RE::TESObjectREFR*>(&it->second) : nullptr;
+        }
+
+        virtual bool FormListHasForm(Core::FormID formListID, Core::FormID formID) const override {
+            const auto it = formLists.find(formListID);
+            return it != formLists.end() && it->second.contains(formID);
+        }
+
+        virtual bool IsPlayer(Core::FormID formID) const override { return formID == PlayerFormID; }
+
+        virtual bool IsPlayerTeammate(Core::FormID formID) const override { return teammates.contains(formID); }
+
+        /** Same form ID as the player's reference in the game */
+        static constexpr Core::FormID PlayerFormID = 0x14;
+
+    private:
+        std::unordered_map<Core::FormID, RE::TESForm> forms;
+        std::unordered_map<Core::FormID, RE::TESObjectREFR> references;
+        std::unordered_map<Core::FormID, std::unordered_set<Core::FormID>> formLists;
+        std::unordered_set<Core::FormID> teammates;
+    };
+
+    /**
+     * Inventories that hold whatever was put in them up front.
+     */
+    class MockInventoryLookup : public Core::IInventoryLookup {
+
+    public:
+        void SetItemCount(Core::FormID container, Core::FormID item, std::int32_t itemCount) {
+            itemCounts[(static_cast<std::uint64_t>(container) << 32) | item] = itemCount;
+        }
+
+        virtual std::int32_t GetItemCount(Core::FormID container, Core::FormID item) const override {
+            const auto it = itemCounts.find((static_cast<std::uint64_t>(container) << 32) | item);
+            return it != itemCounts.end() ? it->second : 0;
+        }
+
+    private:
+        std::unordered_map<std::uint64_t, std::int32_t> itemCounts;
+    };
+
+    /**
+     * Every reference has a script attached, with its form ID as its handle.
+     */
+    class MockHandlePolicy : public Core::IHandlePolicy {
+
+    public:
+        virtual Core::VMHandle GetHandleForReference(const RE::TESObjectREFR* reference) override {
+            return reference ? reference->formID : 0;
+        }
+
+        virtual Core::VMHandle GetHandleForForm(const RE::TESForm* form) override { return form ? form->formID : 0; }
+
+        virtual bool IsValidHandle(Core::VMHandle handle) const override { return handle != 0; }
+    };
+
+    /**
+     * Event sender that only counts what it would have sent.
+     */
+    class CountingEventSender : public Core::IEventSender {
+
+    public:
+        virtual bool IsReady() const override { return true; }
+
+        virtual void SendItemEvent(Core::ItemEventKind, Core::VMHandle, const Core::ItemEventPayload& payload) override {
+            ++numEvents;
+            numItems += payload.baseItems.size();
+        }
+
+        virtual void SendItemCountEvent(Core::VMHandle, RE::TESForm*, std::int32_t, std::int32_t) override {
+            ++numItemCountEvents;
+        }
+
+        std::size_t numEvents = 0;
+        std::size_t numItems = 0;
+        std::size_t numItemCountEvents = 0;
+    };
+
+    /**
+     * Event sender that keeps a copy of everything it would have sent, for checking it afterwards.
+     */
+    class RecordingEventSender : public Core::IEventSender {
+
+    public:
+        struct SentItemEvent {
+            Core::ItemEventKind kind;
+            Core::VMHandle handle;
+            std::vector<Core::FormID> baseItems;
+            std::vector<std::int32_t> itemCounts;
+            std::vector<Core::VMHandle> receivers;
+            std::vector<Core::VMHandle> excludedReceivers;
+        };
+
+        struct SentItemCountEvent {
+            Core::VMHandle handle;
+            Core::FormID baseItem;
+            std::int32_t threshold;
+            std::int32_t itemCount;
+        };
+
+        virtual bool IsReady() const override { return true; }
+
+        virtual void SendItemEvent(Core::ItemEventKind kind, Core::VMHandle handle,
+                                   const Core::ItemEventPayload& payload) override {
+            auto& event = itemEvents.emplace_back(SentItemEvent{kind, handle, {}, payload.itemCounts,
+                                                                {payload.receivers.begin(), payload.receivers.end()},
+                                                                {payload.excludedReceivers.begin(),
+                                                                 payload.excludedReceivers.end()}});
+            for (const auto baseItem : payload.baseItems) {
+                event.baseItems.push_back(baseItem ? baseItem->formID : 0);
+            }
+        }
+
+        virtual void SendItemCountEvent(Core::VMHandle handle, RE::TESForm* baseItem, std::int32_t threshold,
+                                        std::int32_t itemCount) override {
+            itemCountEvents.push_back({handle, baseItem ? baseItem->formID : 0, threshold, itemCount});
+        }
+
+        std::vector<SentItemEvent> itemEvents;
+        std::vector<SentItemCountEvent> itemCountEvents;
+    };
+
+    /**
+     * Task queue that holds on to the tasks until the end of the (simulated) frame. Like the SKSE task
+     * interface, it also runs the tasks that running tasks queue up in the same frame; only tasks queued
+     * up for the next frame wait for it.
+     */
+    class FrameTaskQueue : public Core::ITaskQueue {
+
+    public:
+        virtual void AddTask(std::function<void()> task) override { tasks.push_back(std::move(task)); }
+
+        virtual void AddTaskNextFrame(std::function<void()> task) override {
+            nextFrameTasks.push_back(std::move(task));
+        }
+
+        /**
+         * Runs all the tasks queued up during this frame, including those that they queue up in turn, and
+         * then makes the tasks queued up for the next frame the tasks of the next call.
+         */
+        void RunFrame() {
+            // Bounded, so that a task that keeps queueing itself up fails the caller instead of hanging it
+            for (std::size_t pass = 0; !tasks.empty() && pass < MaxPassesPerFrame; ++pass) {
+                runningTasks.swap(tasks);
+                for (auto& task : runningTasks) {
+                    task();
+                }
+                runningTasks.clear();
+            }
+            overran = overran || !tasks.empty();
+
+            ++frameNumber;
+            tasks.insert(tasks.end(), std::make_move_iterator(nextFrameTasks.begin()),
+                         std::make_move_iterator(nextFrameTasks.end()));
+            nextFrameTasks.clear();
+        }
+
+        [[nodiscard]] virtual std::uint64_t GetFrameNumber() const override { return frameNumber; }
+
+        /**
+         * Drops all the tasks queued up during this frame, without running them.
+         */
+        void DiscardFrame() {
+            tasks.clear();
+            nextFrameTasks.clear();
+        }
+
+        /** Did tasks ever keep queueing up tasks in the same frame, beyond MaxPassesPerFrame? */
+        [[nodiscard]] bool Overran() const { return overran; }
+
+        static constexpr std::size_t MaxPassesPerFrame = 64;
+
+    private:
+        std::vector<std::function<void()>> tasks;
+        std::vector<std::function<void()>> runningTasks;
+        std::vector<std::function<void()>> nextFrameTasks;
+        std::uint64_t frameNumber = 0;
+        bool overran = false;
+    };
+
+    /**
+     * Cosave kept in memory. Form IDs always resolve to themselves.
+     */
+    class InMemoryCosave : public Core::ISerializationInterface {
+
+    public:
+        using Core::ISerializationInterface::ReadRecordData;
+        using Core::ISerializationInterface::WriteRecordData;
+
+        virtual bool OpenRecord(std::uint32_t type, std::uint32_t version) override {
+            records.push_back({type, version, {}});
+            return true;
+        }
+
+        virtual bool WriteRecordData(const void* buf, std::uint32_t length) override {
+            if (records.empty()) {
+                return false;
+            }
+            auto& data = records.back().data;
+            const auto bytes = static_cast<const std::byte*>(buf);
+            data.insert(data.end(), bytes, bytes + length);
+            return true;
+        }
+
+        virtual bool GetNextRecordInfo(std::uint32_t& type, std::uint32_t& version, std::uint32_t& length) override {
+            if (nextRecord >= records.size()) {
+                return false;
+            }
+            currentRecord = nextRecord++;
+            readOffset = 0;
+            type = records[currentRecord].type;
+            version = records[currentRecord].version;
+            length = static_cast<std::uint32_t>(records[currentRecord].data.size());
+            return true;
+        }
+
+        virtual std::uint32_t ReadRecordData(void* buf, std::uint32_t length) override {
+            const auto& data = records[currentRecord].data;
+            const auto available = static_cast<std::uint32_t>(data.size() - readOffset);
+            const auto toRead = length < available ? length : available;
+            std::memcpy(buf, data.data() + readOffset, toRead);
+            readOffset += toRead;
+            return toRead;
+        }
+
+        virtual bool ResolveFormID(Core::FormID oldFormID, Core::FormID& newFormID) override {
+            newFormID = oldFormID;
+            return true;
+        }
+
+        /**
+         * Starts reading the records from the beginning again.
+         */
+        void Rewind() {
+            nextRecord = 0;
+            currentRecord = 0;
+            readOffset = 0;
+        }
+
+        void Clear() {
+            records.clear();
+            Rewind();
+        }
+
+        [[nodiscard]] std::size_t SizeInBytes() const {
+            std::size_t size = 0;
+            for (const auto& record : records) {
+                size += record.data.size();
+            }
+            return size;
+        }
+
+    private:
+        struct Record {
+            std::uint32_t type;
+            std::uint32_t version;
+            std::vector<std::byte> data;
+        };
+
+        std::vector<Record> records;
+        std::size_t nextRecord = 0;
+        std::size_t currentRecord = 0;
+        std::size_t readOffset = 0;
+    };
+
+    /**
+     * All the mocks that an item event batcher needs, wired together.
+     */
+    struct MockItemEventBatcher {
+        MockFormLookup forms;
+        MockHandlePolicy handles;
+        CountingEventSender sender;
+        FrameTaskQueue tasks;
+
+        Core::ItemEventBatcher batcher{{forms, handles, sender, tasks}};
+    };
+}  // namespace MockEngine
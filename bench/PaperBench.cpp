@@ -0,0 +1,246 @@
+#include "MockEngine.h"
+#include "SyntheticEvents.h"
+
+#include <HitEventDeduplicator.h>
+#include <InventoryEventFilter.h>
+#include <InventoryEventGrouping.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+using namespace MockEngine;
+using namespace SyntheticEvents;
+
+namespace {
+    /** Number of elements in the arrays passed to the filter-helper natives */
+    constexpr std::size_t FilterArraySize = 10000;
+
+    /**
+     * Creates a batcher with mocks that know about all the containers, actors and items that
+     * the synthetic events refer to.
+     */
+    std::unique_ptr<MockItemEventBatcher> MakeBatcher(std::uint32_t numContainers, std::uint32_t numItems,
+                                                      std::uint32_t numActors = 0) {
+        auto mock = std::make_unique<MockItemEventBatcher>();
+        for (std::uint32_t i = 0; i < numContainers; ++i) {
+            mock->forms.AddReference(FirstContainerID + i);
+        }
+        for (std::uint32_t i = 0; i < numActors; ++i) {
+            mock->forms.AddReference(FirstActorID + i);
+        }
+        for (std::uint32_t i = 0; i < numItems; ++i) {
+            mock->forms.AddForm(FirstItemID + i);
+        }
+        return mock;
+    }
+
+    void RecordEvents(Core::ItemEventBatcher& batcher, const std::vector<ContainerChangedEvent>& events) {
+        for (const auto& event : events) {
+            batcher.RecordEvent(event.oldContainer, event.newContainer, event.baseObj, event.itemCount);
+        }
+    }
+
+    /**
+     * One frame of N containers exchanging M items each: batching all the container-changed events,
+     * and dispatching them as batched events at the end of the frame.
+     */
+    void BM_ContainerChurn(benchmark::State& state) {
+        const auto numContainers = static_cast<std::uint32_t>(state.range(0));
+        const auto numItems = static_cast<std::uint32_t>(state.range(1));
+        const bool withTransfers = state.range(2) != 0;
+
+        auto mock = MakeBatcher(numContainers, numItems);
+        if (withTransfers) {
+            // Half of the containers receive item-transferred events instead
+            for (std::uint32_t i = 0; i < numContainers; i += 2) {
+                mock->batcher.RegisterForItemsTransferred(FirstContainerID + i, FirstContainerID + i);
+            }
+        }
+
+        const auto events =
+            SyntheticEventGenerator().ContainerChurn(numContainers, numItems, std::size_t{numContainers} * numItems);
+
+        for (auto _ : state) {
+            RecordEvents(mock->batcher, events);
+            mock->tasks.RunFrame();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+        state.counters["sentEvents"] =
+            benchmark::Counter(static_cast<double>(mock->sender.numEvents), benchmark::Counter::kAvgIterations);
+    }
+
+    /**
+     * One frame in which numActors actors all switch outfits.
+     */
+    void BM_OutfitSwaps(benchmark::State& state) {
+        const auto numActors = static_cast<std::uint32_t>(state.range(0));
+        const auto numItemsPerOutfit = static_cast<std::uint32_t>(state.range(1));
+
+        auto mock = MakeBatcher(0, numItemsPerOutfit * 2, numActors);
+        const auto events = SyntheticEventGenerator().OutfitSwaps(numActors, numItemsPerOutfit);
+
+        for (auto _ : state) {
+            RecordEvents(mock->batcher, events);
+            mock->tasks.RunFrame();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+    }
+
+    /**
+     * One frame of an area-of-effect attack, where the engine sends several hit events per (aggressor, target).
+     */
+    void BM_AoEHitStorm(benchmark::State& state) {
+        const auto numAggressors = static_cast<std::uint32_t>(state.range(0));
+        const auto numTargets = static_cast<std::uint32_t>(state.range(1));
+        const auto hitsPerTarget = static_cast<std::uint32_t>(state.range(2));
+
+        std::vector<RE::TESObjectREFR> actors(numAggressors + numTargets);
+        for (std::uint32_t i = 0; i < actors.size(); ++i) {
+            actors[i].formID = FirstActorID + i;
+        }
+
+        const auto events = SyntheticEventGenerator().AoEHitStorm(numAggressors, numTargets, hitsPerTarget);
+
+        Core::HitEventDeduplicator deduplicator;
+        float applicationRuntime = 0.0f;
+        std::size_t numImpacts = 0;
+
+        for (auto _ : state) {
+            // Every iteration is a new frame
+            applicationRuntime += 1.0f / 60.0f;
+
+            for (const auto& event : events) {
+                const auto target = &actors[event.target - FirstActorID];
+                const auto cause = &actors[event.cause - FirstActorID];
+
+                if (!deduplicator.IsDuplicate(target, cause, applicationRuntime)) {
+                    deduplicator.RecordHit(target, cause, applicationRuntime);
+                    ++numImpacts;
+                }
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+        state.counters["impacts"] =
+            benchmark::Counter(static_cast<double>(numImpacts), benchmark::Counter::kAvgIterations);
+    }
+
+    /**
+     * Saving a large backlog of pending events to the cosave, and loading it back in.
+     */
+    void BM_CosaveRoundTrip(benchmark::State& state) {
+        constexpr std::uint32_t NumContainers = 256;
+        constexpr std::uint32_t NumItems = 512;
+        const auto backlogSize = static_cast<std::size_t>(state.range(0));
+
+        auto mock = MakeBatcher(NumContainers, NumItems);
+        for (std::uint32_t i = 0; i < NumContainers; i += 4) {
+            mock->batcher.RegisterForItemsTransferred(FirstContainerID + i, FirstContainerID + i);
+        }
+
+        RecordEvents(mock->batcher, SyntheticEventGenerator().ContainerChurn(NumContainers, NumItems, backlogSize));
+        mock->tasks.DiscardFrame();
+
+        InMemoryCosave cosave;
+        for (auto _ : state) {
+            cosave.Clear();
+            mock->batcher.Save(cosave);
+
+            mock->batcher.Revert();
+
+            std::uint32_t type;
+            std::uint32_t version;
+            std::uint32_t length;
+            cosave.Rewind();
+            while (cosave.GetNextRecordInfo(type, version, length)) {
+                mock->batcher.LoadRecord(cosave, type);
+            }
+            mock->batcher.FinishLoad();
+            mock->tasks.DiscardFrame();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * backlogSize));
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * cosave.SizeInBytes()));
+    }
+
+    /**
+     * GroupInventoryEventBySource on an array of 10k containers.
+     */
+    void BM_GroupInventoryEventBySource(benchmark::State& state) {
+        const auto numContainers = static_cast<std::uint32_t>(state.range(0));
+        const auto containers = SyntheticEventGenerator().ItemArray(FilterArraySize, numContainers);
+
+        for (auto _ : state) {
+            auto grouping = Core::GroupInventoryEventIndices<Core::FormID>(
+                containers.size(), [&](const std::size_t i) { return containers[i]; });
+            benchmark::DoNotOptimize(grouping);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * containers.size()));
+    }
+
+    /**
+     * Matching an array of 10k items against inventory event filters with items and form lists.
+     */
+    void BM_ItemPassesInventoryFilterLists(benchmark::State& state) {
+        constexpr std::uint32_t NumItems = 4096;
+        const auto numFilterItems = static_cast<std::uint32_t>(state.range(0));
+        const auto numFormLists = static_cast<std::uint32_t>(state.range(1));
+
+        SyntheticEventGenerator generator;
+        MockFormLookup forms;
+
+        const auto filterItems = generator.ItemArray(numFilterItems, NumItems);
+        std::vector<Core::FormID> formLists;
+        for (std::uint32_t i = 0; i < numFormLists; ++i) {
+            formLists.push_back(FirstFormListID + i);
+            forms.AddFormList(FirstFormListID + i, generator.ItemArray(64, NumItems));
+        }
+
+        const auto items = generator.ItemArray(FilterArraySize, NumItems);
+
+        for (auto _ : state) {
+            std::size_t numPassed = 0;
+            for (const auto item : items) {
+                if (Core::ItemPassesInventoryFilterLists(item, filterItems, formLists, forms)) {
+                    ++numPassed;
+                }
+            }
+            benchmark::DoNotOptimize(numPassed);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * items.size()));
+    }
+}  // namespace
+
+BENCHMARK(BM_ContainerChurn)
+    ->ArgNames({"containers", "items", "transfers"})
+    ->Args({10, 100, 0})
+    ->Args({100, 100, 0})
+    ->Args({1000, 20, 0})
+    ->Args({100, 100, 1});
+BENCHMARK(BM_OutfitSwaps)->ArgNames({"actors", "outfitItems"})->Args({1, 8})->Args({20, 8})->Args({100, 12});
+BENCHMARK(BM_AoEHitStorm)
+    ->ArgNames({"aggressors", "targets", "hitsPerTarget"})
+    ->Args({1, 10, 3})
+    ->Args({4, 30, 3})
+    ->Args({10, 50, 2});
+BENCHMARK(BM_CosaveRoundTrip)->ArgNames({"backlog"})->Arg(1000)->Arg(100000);
+BENCHMARK(BM_GroupInventoryEventBySource)->ArgNames({"containers"})->Arg(16)->Arg(1024);
+BENCHMARK(BM_ItemPassesInventoryFilterLists)->ArgNames({"items", "formLists"})->Args({16, 0})->Args({16, 8});
+
+int main(int argc, char** argv) {
+    // Lets compare_to_baseline.py tell whether two runs measured the same kind of build
+    benchmark::AddCustomContext("paper_build_type", PAPER_BENCH_BUILD_TYPE);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
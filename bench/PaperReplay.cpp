@@ -0,0 +1,281 @@
+#include "MockEngine.h"
+
+#include <EquipStateTracker.h>
+#include <EventRecorder.h>
+#include <HitEventDeduplicator.h>
+#include <HitTelemetry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Replays an event log written by the event recorder (see StartPaperEventRecording) through the
+ * engine-independent cores, with the mock engine from the benchmarks:
+ *
+ *     paper_replay <event log> [--paced] [--repeat N]
+ *
+ * By default, frames are replayed back to back as fast as possible. With --paced, every frame starts
+ * at the same time (relative to the start of the replay) as it did in the recorded session.
+ */
+using namespace MockEngine;
+using namespace Recording;
+
+namespace {
+    /**
+     * Read-only memory mapping of a whole file.
+     */
+    class MappedFile {
+
+    public:
+        explicit MappedFile(const char* path) {
+#ifdef _WIN32
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+                return;
+            }
+
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) {
+                return;
+            }
+
+            const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                contents = {static_cast<const std::byte*>(view), static_cast<std::size_t>(fileSize.QuadPart)};
+            }
+#else
+            descriptor = open(path, O_RDONLY);
+            if (descriptor < 0) {
+                return;
+            }
+
+            struct stat fileInfo;
+            if (fstat(descriptor, &fileInfo) != 0 || fileInfo.st_size == 0) {
+                return;
+            }
+
+            const auto view = mmap(nullptr, static_cast<std::size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE,
+                                   descriptor, 0);
+            if (view != MAP_FAILED) {
+                contents = {static_cast<const std::byte*>(view), static_cast<std::size_t>(fileInfo.st_size)};
+            }
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (!contents.empty()) {
+                UnmapViewOfFile(contents.data());
+            }
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            if (file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+#else
+            if (!contents.empty()) {
+                munmap(const_cast<std::byte*>(contents.data()), contents.size());
+            }
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] std::span<const std::byte> Contents() const { return contents; }
+
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+        std::span<const std::byte> contents;
+    };
+
+    struct ReplayStats {
+        std::size_t numFrames = 0;
+        std::size_t numContainerEvents = 0;
+        std::size_t numHitEvents = 0;
+        std::size_t numDuplicateHits = 0;
+        std::size_t numEquipEvents = 0;
+        std::size_t numEquipEventsSent = 0;
+    };
+
+    /**
+     * Lets the mocks know about every form that the recorded events refer to.
+     */
+    void RegisterForms(MockFormLookup& forms, std::span<const RecordedEvent> events) {
+        const auto addReference = [&forms](Core::FormID formID) {
+            if (formID != 0) {
+                forms.AddReference(formID);
+            }
+        };
+
+        for (const auto& event : events) {
+            if (event.type == RecordedEventType::kContainerChanged) {
+                addReference(event.forms[0]);
+                addReference(event.forms[1]);
+                forms.AddForm(event.forms[2]);
+            } else if (event.type == RecordedEventType::kHit) {
+                addReference(event.forms[0]);
+                addReference(event.forms[1]);
+            }
+        }
+    }
+
+    /**
+     * Converts the recorded flags of a TESHitEvent to the flags that the hit telemetry keeps.
+     */
+    std::uint8_t ToHitFlags(std::int32_t recordedFlags) {
+        // TESHitEvent::Flag: kPowerAttack = 1 << 0, kSneakAttack = 1 << 1, kBashAttack = 1 << 2, kHitBlocked = 1 << 3
+        std::uint8_t flags = 0;
+        if (recordedFlags & (1 << 0)) {
+            flags |= Core::HitFlags::kPowerAttack;
+        }
+        if (recordedFlags & (1 << 1)) {
+            flags |= Core::HitFlags::kSneakAttack;
+        }
+        if (recordedFlags & (1 << 2)) {
+            flags |= Core::HitFlags::kBashAttack;
+        }
+        if (recordedFlags & (1 << 3)) {
+            flags |= Core::HitFlags::kHitBlocked;
+        }
+        return flags;
+    }
+
+    ReplayStats Replay(MockItemEventBatcher& mock, std::span<const RecordedEvent> events, bool paced) {
+        ReplayStats stats;
+        Core::HitEventDeduplicator hitDeduplicator;
+        Core::HitTelemetry hitTelemetry;
+        Core::EquipStateTracker equipStates;
+        std::vector<Core::EquipChange> equipChanges;
+
+        const auto start = std::chrono::steady_clock::now();
+        float applicationRuntime = 0.0f;
+
+        for (const auto& event : events) {
+            switch (event.type) {
+                case RecordedEventType::kFrame:
+                    if (paced) {
+                        std::this_thread::sleep_until(start + std::chrono::nanoseconds(event.timestamp));
+                    }
+                    mock.tasks.RunFrame();
+                    equipStates.AdvanceFrame(equipChanges);
+                    stats.numEquipEventsSent += equipChanges.size();
+                    equipChanges.clear();
+                    ++stats.numFrames;
+                    applicationRuntime = static_cast<float>(event.timestamp) / 1e9f;
+                    break;
+                case RecordedEventType::kContainerChanged:
+                    mock.batcher.RecordEvent(event.forms[0], event.forms[1], event.forms[2], event.value);
+                    ++stats.numContainerEvents;
+                    break;
+                case RecordedEventType::kHit: {
+                    const auto target = mock.forms.LookupReference(event.forms[0]);
+                    const auto cause = mock.forms.LookupReference(event.forms[1]);
+                    if (hitDeduplicator.IsDuplicate(target, cause, applicationRuntime)) {
+                        ++stats.numDuplicateHits;
+                    } else {
+                        hitDeduplicator.RecordHit(target, cause, applicationRuntime);
+                    }
+                    if (event.forms[0] != 0 && event.forms[1] != 0) {
+                        hitTelemetry.RecordHit(event.forms[1], event.forms[0], ToHitFlags(event.value),
+                                               static_cast<std::uint32_t>(event.timestamp / 1000000));
+                    }
+                    ++stats.numHitEvents;
+                    break;
+                }
+                case RecordedEventType::kEquip:
+                    if (equipStates.RecordEquip(event.forms[0], event.forms[1], event.value != 0)) {
+                        ++stats.numEquipEventsSent;
+                    }
+                    ++stats.numEquipEvents;
+                    break;
+            }
+        }
+
+        mock.tasks.RunFrame();
+        equipStates.AdvanceFrame(equipChanges);
+        stats.numEquipEventsSent += equipChanges.size();
+        return stats;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    bool paced = false;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--paced") {
+            paced = true;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s <event log> [--paced] [--repeat N]\n", argv[0]);
+        return 2;
+    }
+
+    const MappedFile file(path);
+    const auto events = ReadEventLog(file.Contents());
+    if (events.empty()) {
+        std::fprintf(stderr, "%s is not a valid (or is an empty) event log.\n", path);
+        return 1;
+    }
+
+    MockItemEventBatcher mock;
+    RegisterForms(mock.forms, events);
+
+    for (int i = 0; i < repeat; ++i) {
+        mock.sender.numEvents = 0;
+        mock.sender.numItems = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto stats = Replay(mock, events, paced);
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        std::printf("Replay %d: %zu frames, %zu container events (%zu batched events sent, %zu items), "
+                    "%zu hits (%zu duplicates), %zu equips (%zu sent) in %.3f ms\n",
+                    i + 1, stats.numFrames, stats.numContainerEvents, mock.sender.numEvents, mock.sender.numItems,
+                    stats.numHitEvents, stats.numDuplicateHits, stats.numEquipEvents, stats.numEquipEventsSent,
+                    elapsed.count());
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace SyntheticEvents {
+
+    /** First form IDs of the different kinds of synthetic forms, so they never collide */
+    constexpr Core::FormID FirstContainerID = 0x01000000;
+    constexpr Core::FormID FirstItemID = 0x02000000;
+    constexpr Core::FormID FirstActorID = 0x03000000;
+    constexpr Core::FormID FirstFormListID = 0x04000000;
+
+    /**
+     * A container-changed event, as received from the engine.
+     */
+    struct ContainerChangedEvent {
+        Core::FormID oldContainer;
+        Core::FormID newContainer;
+        Core::FormID baseObj;
+        std::int32_t itemCount;
+    };
+
+    /**
+     * A hit event, as received from the engine (only the fields that the de-duplication looks at).
+     */
+    struct HitEvent {
+        Core::FormID target;
+        Core::FormID cause;
+    };
+
+    /**
+     * Deterministic generator of synthetic event streams, so that every run of a
+     * benchmark processes exactly the same events.
+     */
+    class SyntheticEventGenerator {
+
+    public:
+        explicit SyntheticEventGenerator(std::uint32_t seed = 0x50415045) : rng(seed) {}
+
+        /**
+         * Items moving around between numContainers containers, from a pool of numItems items: mostly transfers
+         * between two containers, with some items entering or leaving the world (e.g., picked up or dropped).
+         */
+        std::vector<ContainerChangedEvent> ContainerChurn(std::uint32_t numContainers, std::uint32_t numItems,
+                                                          std::size_t numEvents) {
+            std::uniform_int_distribution<std::uint32_t> containerDist(0, numContainers - 1);
+            std::uniform_int_distribution<std::uint32_t> itemDist(0, numItems - 1);
+            std::uniform_int_distribution<std::int32_t> countDist(1, 10);
+            std::uniform_int_distribution<int> kindDist(0, 9);
+
+            std::vector<ContainerChangedEvent> events;
+            events.reserve(numEvents);
+            for (std::size_t i = 0; i < numEvents; ++i) {
+                auto oldContainer = FirstContainerID + containerDist(rng);
+                auto newContainer = FirstContainerID + containerDist(rng);
+
+                const auto kind = kindDist(rng);
+                if (kind == 0) {
+                    oldContainer = 0;
+                } else if (kind == 1) {
+                    newContainer = 0;
+                }
+
+                events.push_back({oldContainer, newContainer, FirstItemID + itemDist(rng), countDist(rng)});
+            }
+
+            return events;
+        }
+
+        /**
+         * Outfit swaps of numActors actors: every actor loses the numItemsPerOutfit items of its old outfit,
+         * and gains the numItemsPerOutfit items of its new outfit.
+         */
+        std::vector<ContainerChangedEvent> OutfitSwaps(std::uint32_t numActors, std::uint32_t numItemsPerOutfit) {
+            std::vector<ContainerChangedEvent> events;
+            events.reserve(static_cast<std::size_t>(numActors) * numItemsPerOutfit * 2);
+            for (std::uint32_t actor = 0; actor < numActors; ++actor) {
+                const auto actorID = FirstActorID + actor;
+                for (std::uint32_t item = 0; item < numItemsPerOutfit; ++item) {
+                    events.push_back({actorID, 0, FirstItemID + item, 1});
+                }
+                for (std::uint32_t item = 0; item < numItemsPerOutfit; ++item) {
+                    events.push_back({0, actorID, FirstItemID + numItemsPerOutfit + item, 1});
+                }
+            }
+
+            return events;
+        }
+
+        /**
+         * An area-of-effect attack by numAggressors aggressors on numTargets targets, where the engine
+         * sends hitsPerTarget hit events for every (aggressor, target) pair in the same frame.
+         */
+        std::vector<HitEvent> AoEHitStorm(std::uint32_t numAggressors, std::uint32_t numTargets,
+                                          std::uint32_t hitsPerTarget) {
+            std::vector<HitEvent> events;
+            events.reserve(static_cast<std::size_t>(numAggressors) * numTargets * hitsPerTarget);
+            for (std::uint32_t hit = 0; hit < hitsPerTarget; ++hit) {
+                for (std::uint32_t aggressor = 0; aggressor < numAggressors; ++aggressor) {
+                    for (std::uint32_t target = 0; target < numTargets; ++target) {
+                        events.push_back({FirstActorID + numAggressors + target, FirstActorID + aggressor});
+                    }
+                }
+            }
+
+            std::shuffle(events.begin(), events.end(), rng);
+            return events;
+        }
+
+        /**
+         * numElements random item form IDs, from a pool of numItems items.
+         */
+        std::vector<Core::FormID> ItemArray(std::size_t numElements, std::uint32_t numItems) {
+            std::uniform_int_distribution<std::uint32_t> itemDist(0, numItems - 1);
+
+            std::vector<Core::FormID> items;
+            items.reserve(numElements);
+            for (std::size_t i = 0; i < numElements; ++i) {
+                items.push_back(FirstItemID + itemDist(rng));
+            }
+
+            return items;
+        }
+
+    private:
+        std::mt19937 rng;
+    };
+}  // namespace SyntheticEvents
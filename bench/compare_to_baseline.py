@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Compares the JSON output of paper_bench against a baseline, and fails if any benchmark got
+slower than the baseline by more than the threshold.
+
+    paper_bench --benchmark_out=results.json --benchmark_out_format=json
+    python3 compare_to_baseline.py baseline.json results.json --threshold 10
+
+If the benchmarks were run with repetitions, the medians are compared. Timings are only comparable
+between runs on the same machine, of optimized builds of the same type; for any other pair of runs,
+the comparison is printed for information only and never fails. To gate changes on it, record a
+baseline on your own machine first (the paper_bench_baseline target).
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_times(path):
+    """Returns a map from benchmark name to (time, time unit)."""
+    with open(path, encoding="utf-8") as f:
+        results = json.load(f)
+
+    times = {}
+    medians = {}
+    for benchmark in results["benchmarks"]:
+        if benchmark.get("error_occurred"):
+            continue
+
+        run_type = benchmark.get("run_type", "iteration")
+        if run_type == "aggregate":
+            if benchmark.get("aggregate_name") == "median":
+                medians[benchmark["run_name"]] = (benchmark["cpu_time"], benchmark["time_unit"])
+        elif benchmark.get("repetitions", 1) <= 1:
+            times[benchmark.get("run_name", benchmark["name"])] = (benchmark["cpu_time"], benchmark["time_unit"])
+
+    times.update(medians)
+    return times
+
+
+def load_context(path):
+    with open(path, encoding="utf-8") as f:
+        return json.load(f).get("context", {})
+
+
+# What has to match for timings of two runs to be comparable
+CONTEXT_KEYS = ["host_name", "num_cpus", "mhz_per_cpu", "library_build_type", "paper_build_type"]
+OPTIMIZED_BUILD_TYPES = {"Release", "RelWithDebInfo", "MinSizeRel"}
+
+
+def why_not_comparable(baseline_context, results_context):
+    """Returns the reasons why the timings of the two runs cannot be compared (empty if they can)."""
+    reasons = []
+    for key in CONTEXT_KEYS:
+        if baseline_context.get(key) != results_context.get(key):
+            reasons.append(f"{key} differs (baseline: {baseline_context.get(key)}, "
+                           f"current: {results_context.get(key)})")
+
+    for name, context in (("baseline", baseline_context), ("current", results_context)):
+        if context.get("paper_build_type") not in OPTIMIZED_BUILD_TYPES:
+            reasons.append(f"{name} run is not of an optimized build "
+                           f"(paper_build_type: {context.get('paper_build_type')})")
+
+    return reasons
+
+
+UNITS_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def to_ns(time_and_unit):
+    time, unit = time_and_unit
+    return time * UNITS_TO_NS[unit]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON output of paper_bench to compare against")
+    parser.add_argument("results", help="JSON output of paper_bench to check")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: %(default)s)")
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline)
+    results = load_times(args.results)
+    not_comparable = why_not_comparable(load_context(args.baseline), load_context(args.results))
+
+    regressions = []
+    print(f"{'Benchmark':<70} {'Baseline':>12} {'Current':>12} {'Change':>8}")
+    for name, result in sorted(results.items()):
+        if name not in baseline:
+            print(f"{name:<70} {'-':>12} {to_ns(result):>10.0f}ns {'new':>8}")
+            continue
+
+        baseline_ns = to_ns(baseline[name])
+        result_ns = to_ns(result)
+        change = (result_ns - baseline_ns) / baseline_ns * 100.0
+        print(f"{name:<70} {baseline_ns:>10.0f}ns {result_ns:>10.0f}ns {change:>+7.1f}%")
+
+        if change > args.threshold:
+            regressions.append((name, change))
+
+    for name in sorted(baseline.keys() - results.keys()):
+        print(f"{name:<70} missing from results")
+
+    if not_comparable:
+        print("\nThese timings are not comparable, so this comparison is for information only:")
+        for reason in not_comparable:
+            print(f"  {reason}")
+        return 0
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed by more than {args.threshold}%:")
+        for name, change in regressions:
+            print(f"  {name}: {change:+.1f}%")
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
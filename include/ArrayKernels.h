@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Single-pass kernels over the parallel arrays of batched events, for natives that replace loops that
+ * scripts would otherwise write in Papyrus. One native pass saves the interpreted bytecode of a loop
+ * body per element. They read their input through size() and operator[] only, so they work directly on
+ * the VM's arrays without copying them first, and read every element only once.
+ */
+namespace Core {
+
+    /**
+     * Returns the sum of the given values, clamped to the range of Papyrus ints.
+     */
+    template <class Array>
+    std::int32_t SaturatingSum(const Array& values) {
+        // No overflow before clamping: even 2^32 ints fit in 64 bits
+        std::int64_t sum = 0;
+        const std::size_t numValues = values.size();
+        for (std::size_t i = 0; i < numValues; ++i) {
+            sum += values[i];
+        }
+
+        return static_cast<std::int32_t>(std::clamp<std::int64_t>(sum, std::numeric_limits<std::int32_t>::min(),
+                                                                  std::numeric_limits<std::int32_t>::max()));
+    }
+
+    /**
+     * Returns the indices [0, numElements) for which the predicate holds, in order.
+     */
+    template <class Predicate>
+    std::vector<std::int32_t> IndicesWhere(const std::size_t numElements, Predicate predicate) {
+        std::vector<std::int32_t> indices;
+        for (std::size_t i = 0; i < numElements; ++i) {
+            if (predicate(i)) {
+                indices.push_back(static_cast<std::int32_t>(i));
+            }
+        }
+
+        return indices;
+    }
+
+    /**
+     * Returns the distinct keys returned by getKey for the indices [0, numElements), in order of first
+     * occurrence. Elements with the given null key are left out.
+     */
+    template <class Key, class GetKey>
+    std::vector<Key> UniqueKeys(const std::size_t numElements, const Key nullKey, GetKey getKey) {
+        std::unordered_set<Key> seenKeys;
+        seenKeys.reserve(numElements);
+
+        std::vector<Key> keys;
+        for (std::size_t i = 0; i < numElements; ++i) {
+            const Key key = getKey(i);
+            if (key != nullKey && seenKeys.insert(key).second) {
+                keys.push_back(key);
+            }
+        }
+
+        return keys;
+    }
+
+    /**
+     * Result of reducing the elements of an event's arrays by some key: the index of the first occurrence
+     * of every distinct key (in order of first occurrence), with the sum of the values of all elements
+     * that share that key.
+     */
+    struct KeyTotals {
+        std::vector<std::int32_t> firstIndices;
+        std::vector<std::int32_t> totals;
+    };
+
+    /**
+     * Reduces the indices [0, numElements) by the keys returned by getKey, summing the values returned by
+     * getValue (clamped to the range of Papyrus ints). Elements with the given null key are left out.
+     */
+    template <class Key, class GetKey, class GetValue>
+    KeyTotals TotalsByKey(const std::size_t numElements, const Key nullKey, GetKey getKey, GetValue getValue) {
+        std::unordered_map<Key, std::size_t> keyIDs;
+        keyIDs.reserve(numElements);
+
+        KeyTotals result;
+        std::vector<std::int64_t> totals;
+
+        for (std::size_t i = 0; i < numElements; ++i) {
+            const Key key = getKey(i);
+            if (key == nullKey) {
+                continue;
+            }
+
+            const auto [it, inserted] = keyIDs.try_emplace(key, totals.size());
+            if (inserted) {
+                result.firstIndices.push_back(static_cast<std::int32_t>(i));
+                totals.push_back(0);
+            }
+
+            totals[it->second] += getValue(i);
+        }
+
+        result.totals.reserve(totals.size());
+        for (const auto total : totals) {
+            result.totals.push_back(static_cast<std::int32_t>(std::clamp<std::int64_t>(
+                total, std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max())));
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns the indices of the given values, stably sorted by value: elements with equal values keep
+     * their original order.
+     */
+    template <class Array>
+    std::vector<std::int32_t> StableSortedIndices(const Array& values, const bool descending) {
+        // Sorting (value, index) pairs reads every value once, and the index doubles as the tie-breaker
+        const std::size_t numValues = values.size();
+        std::vector<std::pair<std::int32_t, std::int32_t>> keyedIndices;
+        keyedIndices.reserve(numValues);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            keyedIndices.emplace_back(values[i], static_cast<std::int32_t>(i));
+        }
+
+        if (descending) {
+            std::sort(keyedIndices.begin(), keyedIndices.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+            });
+        } else {
+            std::sort(keyedIndices.begin(), keyedIndices.end());
+        }
+
+        std::vector<std::int32_t> indices;
+        indices.reserve(numValues);
+        for (const auto& keyedIndex : keyedIndices) {
+            indices.push_back(keyedIndex.second);
+        }
+
+        return indices;
+    }
+
+    /**
+     * Returns the elements of the first array followed by those of the second.
+     */
+    template <class T, class FirstArray, class SecondArray>
+    std::vector<T> Concatenate(const FirstArray& first, const SecondArray& second) {
+        std::vector<T> result;
+        result.reserve(first.size() + second.size());
+        for (std::size_t i = 0; i < first.size(); ++i) {
+            result.push_back(first[i]);
+        }
+        for (std::size_t i = 0; i < second.size(); ++i) {
+            result.push_back(second[i]);
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns the elements in [start, end) of the given array. The range is clamped to the array, and a
+     * negative end means the end of the array.
+     */
+    template <class T, class Array>
+    std::vector<T> Slice(const Array& values, const std::int32_t start, const std::int32_t end) {
+        const auto numValues = static_cast<std::int64_t>(values.size());
+        const auto first = std::clamp<std::int64_t>(start, 0, numValues);
+        const auto last = (end < 0) ? numValues : std::clamp<std::int64_t>(end, first, numValues);
+
+        std::vector<T> result;
+        result.reserve(static_cast<std::size_t>(last - first));
+        for (auto i = first; i < last; ++i) {
+            result.push_back(values[static_cast<std::size_t>(i)]);
+        }
+
+        return result;
+    }
+}  // namespace Core
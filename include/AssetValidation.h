@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * Kinds of asset paths, which forms store relative to different folders of the Data directory.
+     */
+    enum class AssetKind : std::uint8_t { kModel, kTexture };
+
+    /**
+     * Returns the path of the given asset relative to the Data directory, as the resource streams expect
+     * it: with backslashes, and with the meshes\ or textures\ prefix that forms usually leave out. Returns
+     * an empty string for empty paths.
+     */
+    [[nodiscard]] std::string NormalizeAssetPath(std::string_view path, AssetKind kind);
+
+    /**
+     * Collects the asset paths of many forms and checks them against the installed resources. Every
+     * distinct path is checked only once, however many forms use it, and the checks are spread over
+     * worker threads.
+     */
+    class AssetPathValidator {
+
+    public:
+        /** Checks whether a normalized path is an installed resource. Called from worker threads. */
+        using ExistsFunction = std::function<bool(const std::string&)>;
+
+        /**
+         * Adds an asset path used by the form at the given index. Empty paths are ignored.
+         */
+        void AddPath(std::size_t formIndex, std::string_view path, AssetKind kind);
+
+        /**
+         * Returns the number of distinct paths added so far.
+         */
+        [[nodiscard]] std::size_t NumPaths() const { return paths.size(); }
+
+        /**
+         * Returns the indices of the forms that use at least one path that does not exist, in ascending
+         * order.
+         */
+        [[nodiscard]] std::vector<std::int32_t> FindFormsWithMissingAssets(const ExistsFunction& exists) const;
+
+    private:
+        /** Every distinct normalized path, in order of first use */
+        std::vector<std::string> paths;
+        /** Index of every path in paths */
+        std::unordered_map<std::string, std::uint32_t> pathIndices;
+        /** (form index, path index) for every use of a path */
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> uses;
+    };
+}  // namespace Core
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+#include <PerfStats.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace Core {
+
+    struct ItemEventBatch;
+
+    /**
+     * Priority classes of the receivers of batched events, from highest to lowest priority.
+     */
+    enum class DispatchClass : std::uint8_t { kPlayer, kFollower, kRegistered, kOther, kTotal };
+
+    /**
+     * A batch that is ready to be sent, with what the scheduler needs to order it.
+     */
+    struct ScheduledBatch {
+        /** Key of the batch in its map (a container, or a pair of containers for transfers) */
+        std::uint64_t key;
+        ItemEventBatch* batch;
+        DispatchClass dispatchClass;
+    };
+
+    /**
+     * Decides in which order batched inventory events are sent, so that the player's scripts do not wait
+     * behind hundreds of NPC containers when a frame's batches do not all fit in the dispatch budget. The
+     * player goes first, then followers, then references that scripts registered as high priority, and
+     * then everything else, in round-robin order so that no container waits forever. Records the time
+     * that batches spent in the queue per priority class.
+     */
+    class DispatchScheduler {
+
+    public:
+        explicit DispatchScheduler(const IFormLookup& forms);
+        DispatchScheduler(const DispatchScheduler&) = delete;
+        DispatchScheduler(DispatchScheduler&&) = delete;
+
+        DispatchScheduler& operator=(const DispatchScheduler&) = delete;
+        DispatchScheduler& operator=(DispatchScheduler&&) = delete;
+
+        /**
+         * Returns the priority class of the given container.
+         */
+        [[nodiscard]] DispatchClass Classify(FormID container) const;
+
+        /**
+         * Returns the priority class of a pair of containers: the highest class of the two.
+         */
+        [[nodiscard]] DispatchClass ClassifyPair(FormID source, FormID dest) const;
+
+        /**
+         * Orders the given ready batches by priority class, with the lowest class in round-robin order
+         * after the given cursor, which is advanced past the batches that fit in the budget. Returns how
+         * many of the batches (from the front) are to be sent this frame.
+         */
+        static std::size_t Schedule(std::vector<ScheduledBatch>& batches, std::uint32_t budget,
+                                    std::uint64_t& roundRobinCursor);
+
+        /**
+         * Records how long a batch of the given class waited between its first event and being sent.
+         */
+        void RecordQueueLatency(DispatchClass dispatchClass, std::chrono::steady_clock::duration latency) {
+            PAPER_STATS_RECORD_LATENCY(*queueLatencies[static_cast<std::size_t>(dispatchClass)], latency);
+        }
+
+        /**
+         * Makes the given reference go before all other references except the player and followers.
+         */
+        void RegisterHighPriority(FormID reference);
+
+        /**
+         * Makes the given reference an ordinary reference again.
+         */
+        void UnregisterHighPriority(FormID reference);
+
+        /**
+         * Forgets all high-priority references.
+         */
+        void Revert();
+
+        /**
+         * Writes the high-priority references to the cosave.
+         */
+        void Save(ISerializationInterface& serde);
+
+        /**
+         * Reads the cosave record of the given type, if it is one of ours. Returns false if the record
+         * belongs to someone else.
+         */
+        bool LoadRecord(ISerializationInterface& serde, std::uint32_t type);
+
+        static constexpr std::uint32_t HighPriorityRecord = MakeRecordType("IPRI");
+
+    private:
+        const IFormLookup& forms;
+
+        /** References that scripts registered as high priority */
+        std::unordered_set<FormID> highPriorityReferences;
+        /** Mutex for access to the high-priority references */
+        mutable std::mutex highPriorityReferencesMutex;
+        /** Are there any high-priority references? Lets classifying skip the lock. */
+        std::atomic<bool> haveHighPriorityReferences = false;
+
+        /** Histograms of queue latencies, per priority class */
+        std::array<PerfStats::LatencyHistogram*, static_cast<std::size_t>(DispatchClass::kTotal)> queueLatencies;
+    };
+}  // namespace Core
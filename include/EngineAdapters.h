@@ -0,0 +1,79 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <EngineInterfaces.h>
+
+namespace EngineAdapters {
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+    /**
+     * Form lookups through the game's form map.
+     */
+    class SkyrimFormLookup : public Core::IFormLookup {
+
+    public:
+        virtual RE::TESForm* LookupForm(Core::FormID formID) const override;
+        virtual RE::TESObjectREFR* LookupReference(Core::FormID formID) const override;
+        virtual bool FormListHasForm(Core::FormID formListID, Core::FormID formID) const override;
+        virtual bool IsPlayer(Core::FormID formID) const override;
+        virtual bool IsPlayerTeammate(Core::FormID formID) const override;
+    };
+
+    /**
+     * Item counts straight from the inventories of references.
+     */
+    class SkyrimInventoryLookup : public Core::IInventoryLookup {
+
+    public:
+        virtual std::int32_t GetItemCount(Core::FormID container, Core::FormID item) const override;
+    };
+
+    /**
+     * Handle lookups through our VM handle cache, backed by the VM's handle policy.
+     */
+    class SkyrimHandlePolicy : public Core::IHandlePolicy {
+
+    public:
+        virtual Core::VMHandle GetHandleForReference(const RE::TESObjectREFR* reference) override;
+        virtual Core::VMHandle GetHandleForForm(const RE::TESForm* form) override;
+        virtual bool IsValidHandle(Core::VMHandle handle) const override;
+    };
+
+    /**
+     * Wrapper around the SKSE serialization interface that we receive in the cosave callbacks.
+     */
+    class SkyrimSerializationInterface : public Core::ISerializationInterface {
+
+    public:
+        explicit SkyrimSerializationInterface(SKSE::SerializationInterface* serde) : serde(serde) {}
+        SkyrimSerializationInterface() = delete;
+
+        using Core::ISerializationInterface::ReadRecordData;
+        using Core::ISerializationInterface::WriteRecordData;
+
+        virtual bool OpenRecord(std::uint32_t type, std::uint32_t version) override;
+        virtual bool WriteRecordData(const void* buf, std::uint32_t length) override;
+        virtual bool GetNextRecordInfo(std::uint32_t& type, std::uint32_t& version, std::uint32_t& length) override;
+        virtual std::uint32_t ReadRecordData(void* buf, std::uint32_t length) override;
+        virtual bool ResolveFormID(Core::FormID oldFormID, Core::FormID& newFormID) override;
+
+    private:
+        SKSE::SerializationInterface* serde;
+    };
+
+    /**
+     * Tasks queued up through the SKSE task interface, or run by the frame hook for the next frame.
+     */
+    class SkyrimTaskQueue : public Core::ITaskQueue {
+
+    public:
+        virtual void AddTask(std::function<void()> task) override;
+        virtual void AddTaskNextFrame(std::function<void()> task) override;
+        [[nodiscard]] virtual std::uint64_t GetFrameNumber() const override;
+    };
+
+#pragma warning(pop)
+}  // namespace EngineAdapters
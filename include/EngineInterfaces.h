@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * The engine types that the engine-independent cores pass around. The cores only ever store
+ * and forward pointers to them, so forward declarations are enough. The plugin build sees the
+ * full definitions from CommonLibSSE; host builds (e.g., benchmarks) provide their own.
+ */
+namespace RE {
+    class TESForm;
+    class TESObjectREFR;
+}
+
+/**
+ * Thin interfaces between the engine-independent cores of PAPER (batching, de-duplication,
+ * filtering and serialization) and the game engine. The plugin implements these on top of
+ * CommonLibSSE (see EngineAdapters.h); host builds can implement them without the game.
+ */
+namespace Core {
+
+    /** Same representation as RE::FormID */
+    using FormID = std::uint32_t;
+    /** Same representation as RE::VMHandle */
+    using VMHandle = std::uint64_t;
+
+    /**
+     * Looking up forms by their IDs.
+     */
+    class IFormLookup {
+    public:
+        virtual ~IFormLookup() = default;
+
+        /** Returns the form with the given ID, or nullptr if there is no such form. */
+        virtual RE::TESForm* LookupForm(FormID formID) const = 0;
+
+        /** Returns the reference with the given ID, or nullptr if there is no such reference. */
+        virtual RE::TESObjectREFR* LookupReference(FormID formID) const = 0;
+
+        /** Does the form list with the given ID contain the form with the given ID? */
+        virtual bool FormListHasForm(FormID formListID, FormID formID) const = 0;
+
+        /** Is the reference with the given ID the player? */
+        virtual bool IsPlayer(FormID formID) const = 0;
+
+        /** Is the reference with the given ID an actor that follows the player? */
+        virtual bool IsPlayerTeammate(FormID formID) const = 0;
+    };
+
+    /**
+     * Counting items in the inventories of references.
+     */
+    class IInventoryLookup {
+    public:
+        virtual ~IInventoryLookup() = default;
+
+        /** Returns how many of the given item the given container holds (0 if either does not exist). */
+        virtual std::int32_t GetItemCount(FormID container, FormID item) const = 0;
+    };
+
+    /**
+     * The VM's policy for handles of script objects.
+     */
+    class IHandlePolicy {
+    public:
+        virtual ~IHandlePolicy() = default;
+
+        /** Returns the VM handle for the given reference (may be an empty handle). */
+        virtual VMHandle GetHandleForReference(const RE::TESObjectREFR* reference) = 0;
+
+        /** Returns the VM handle for the given form of any type, e.g. a quest (may be an empty handle). */
+        virtual VMHandle GetHandleForForm(const RE::TESForm* form) = 0;
+
+        /** Is the given handle a valid, non-empty handle? */
+        virtual bool IsValidHandle(VMHandle handle) const = 0;
+    };
+
+    /**
+     * The kinds of batched inventory events that PAPER sends.
+     */
+    enum class ItemEventKind : std::uint8_t { kAdded, kRemoved, kTransferred, kGlobalMovement };
+
+    struct ItemEventPayload;
+
+    /**
+     * Sending events to scripts in the VM.
+     */
+    class IEventSender {
+    public:
+        virtual ~IEventSender() = default;
+
+        /** Is the VM available to send events to? */
+        virtual bool IsReady() const = 0;
+
+        /** Sends a batched inventory event of the given kind, with the given payload, to the given handle. */
+        virtual void SendItemEvent(ItemEventKind kind, VMHandle handle, const ItemEventPayload& payload) = 0;
+
+        /** Sends an item count threshold event, for the given item and threshold, to the given handle. */
+        virtual void SendItemCountEvent(VMHandle handle, RE::TESForm* baseItem, std::int32_t threshold,
+                                        std::int32_t itemCount) = 0;
+    };
+
+    /**
+     * The cosave serialization interface (mirrors SKSE::SerializationInterface).
+     */
+    class ISerializationInterface {
+    public:
+        virtual ~ISerializationInterface() = default;
+
+        virtual bool OpenRecord(std::uint32_t type, std::uint32_t version) = 0;
+        virtual bool WriteRecordData(const void* buf, std::uint32_t length) = 0;
+        virtual bool GetNextRecordInfo(std::uint32_t& type, std::uint32_t& version, std::uint32_t& length) = 0;
+        virtual std::uint32_t ReadRecordData(void* buf, std::uint32_t length) = 0;
+        virtual bool ResolveFormID(FormID oldFormID, FormID& newFormID) = 0;
+
+        template <class T>
+        bool WriteRecordData(const T& data) {
+            return WriteRecordData(&data, sizeof(T));
+        }
+
+        template <class T>
+        std::uint32_t ReadRecordData(T& data) {
+            return ReadRecordData(&data, sizeof(T));
+        }
+    };
+
+    /**
+     * Queue of tasks to run on the game's main thread.
+     */
+    class ITaskQueue {
+    public:
+        virtual ~ITaskQueue() = default;
+
+        /**
+         * Queues up a task to run as soon as possible. A task queued up by a running task may still run in
+         * the same frame, so tasks that wait for later frames must not queue themselves up again with this.
+         */
+        virtual void AddTask(std::function<void()> task) = 0;
+
+        /** Queues up a task to run once the current frame has ended. */
+        virtual void AddTaskNextFrame(std::function<void()> task) = 0;
+
+        /** Number of the current frame, advanced once per frame at the frame boundary. */
+        [[nodiscard]] virtual std::uint64_t GetFrameNumber() const = 0;
+    };
+
+    /**
+     * Builds a cosave record type from four characters, stored in the same byte order as
+     * _byteswap_ulong('ABCD') produces.
+     */
+    constexpr std::uint32_t MakeRecordType(const char (&chars)[5]) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(chars[0])) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(chars[1])) << 8) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(chars[2])) << 16) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(chars[3])) << 24);
+    }
+}  // namespace Core
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * A change of the magic (spells and shouts) that an actor has equipped.
+     */
+    struct EquipChange {
+        FormID actor;
+        FormID form;
+        bool equipped;
+    };
+
+    /**
+     * Engine-independent core of the suppression of equip event storms. The game re-equips the spells and
+     * shouts of every actor while a game is loaded, and of actors whose cells are attached. During such
+     * suppression windows, equip events are held back, and once the window of an actor closes, only the
+     * changes compared to the last known state of the actor are reported. The last known state of all
+     * actors is kept in the cosave, so loading a game does not report anything that did not change. The
+     * window of an actor without a known state (e.g., after loading a game without our cosave record, or
+     * for an actor that was forgotten) only seeds its state, without reporting anything.
+     */
+    class EquipStateTracker {
+
+    public:
+        /**
+         * Records an equip event. Returns true if it should be sent right away, or false if it is held
+         * back because the actor is in a suppression window.
+         */
+        bool RecordEquip(FormID actor, FormID form, bool equipped);
+
+        /**
+         * Opens the suppression window for all actors, until EndLoadWindow is called.
+         */
+        void BeginLoadWindow();
+
+        /**
+         * Lets the suppression window for all actors close after the given number of frames.
+         */
+        void EndLoadWindow(std::uint32_t frames);
+
+        /**
+         * Opens a suppression window for the given actor, for the given number of frames.
+         */
+        void BeginActorWindow(FormID actor, std::uint32_t frames);
+
+        /**
+         * Advances all suppression windows by one frame, and appends the real changes of the actors
+         * whose windows closed to the given vector. Returns true if any windows are still open.
+         */
+        bool AdvanceFrame(std::vector<EquipChange>& changes);
+
+        /**
+         * Forgets the state, held-back events and window of the given actor, e.g. once its cell detaches.
+         */
+        void ForgetActor(FormID actor);
+
+        /**
+         * Forgets the states of all actors and all held-back events. Keeps the windows open.
+         */
+        void Revert();
+
+        /**
+         * Writes the last known states to the cosave.
+         */
+        void Save(ISerializationInterface& serde);
+
+        /**
+         * Reads the cosave record of the given type, if it is one of ours. Returns false if the record
+         * belongs to someone else.
+         */
+        bool LoadRecord(ISerializationInterface& serde, std::uint32_t type);
+
+        static constexpr std::uint32_t EquipStatesRecord = MakeRecordType("EQST");
+
+    private:
+        /**
+         * Sets whether the actor has the form equipped in its last known state. Returns true if that changed
+         * anything. Caller must hold the lock.
+         */
+        bool ApplyToKnownState(FormID actor, FormID form, bool equipped);
+
+        /**
+         * Is the given actor in a suppression window? Caller must hold the lock.
+         */
+        bool IsInWindow(FormID actor) const;
+
+        /** The spells and shouts that every actor with a known state had equipped, as far as we know */
+        std::unordered_map<FormID, std::vector<FormID>> knownStates;
+
+        /** Events held back per actor: whether each form it (un)equipped ended up equipped */
+        std::unordered_map<FormID, std::vector<std::pair<FormID, bool>>> heldBackEvents;
+
+        /** Is the suppression window for all actors open? */
+        bool loadWindowOpen = false;
+        /** Frames until the suppression window for all actors closes, once the game has been loaded */
+        std::uint32_t loadWindowFramesLeft = 0;
+        /** Is the game still loading? The load window does not close before it is done. */
+        bool loading = false;
+
+        /** Frames until the suppression windows of single actors close */
+        std::unordered_map<FormID, std::uint32_t> actorWindows;
+
+        std::mutex mutex;
+    };
+}  // namespace Core
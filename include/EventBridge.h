@@ -0,0 +1,454 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <EngineAdapters.h>
+#include <EventRecorder.h>
+#include <EventTargets.h>
+#include <Logging.h>
+#include <Profiling.h>
+#include <Settings.h>
+#include <VMHandleCache.h>
+
+#include <algorithm>
+#include <concepts>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Generic event sinks that forward engine events to Papyrus. A sink is declared by a definition:
+ *
+ *     struct MyEventDefinition {
+ *         using Event = RE::TESSomeEvent;
+ *         static constexpr PerfStats::Handler StatsHandler = PerfStats::Handler::kSomething;
+ *         static constexpr const char* ProfileName = "Something.ProcessEvent";
+ *
+ *         static bool IsEnabled(const Core::Settings& settings);
+ *
+ *         // Optional: records the raw event while the event recorder is running
+ *         static void Record(Recording::EventRecorder& recorder, const Event& event);
+ *
+ *         // Optional: sees every event, even while the bridge is disabled (e.g., to keep caches up to date)
+ *         void Observe(const Event& event);
+ *
+ *         // Calls emit(target, eventName, args...) for every Papyrus event to send, if any. The
+ *         // event name must be a static RE::BSFixedString.
+ *         template <class Emit>
+ *         void Project(const Event& event, Emit&& emit);
+ *     };
+ *
+ * and an EventBridge<MyEventDefinition, Policy> is the sink, where the policy decides how the projected
+ * events are sent: immediately (ImmediatePolicy) or batched per target and frame (BatchedPolicy). Target
+ * handle lookups, the filter on scripts that handle the event and the stats are shared by all bridges.
+ */
+namespace EventBridges {
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+    inline void CountStat(PerfStats::Handler handler, std::atomic<std::uint64_t> PerfStats::HandlerCounters::*counter,
+                          std::uint64_t amount) {
+#if PAPER_ENABLE_STATS
+        PerfStats::AddCount(handler, counter, amount);
+#endif
+    }
+
+    /**
+     * Returns the handle of the given reference, or 0 if no script is bound to it.
+     */
+    inline RE::VMHandle GetTargetHandle(RE::SkyrimVM* vm, const RE::TESObjectREFR* target) {
+        const auto handle = VMHandles::VMHandleCache::GetSingleton().GetHandleForObject(
+            vm, static_cast<RE::VMTypeID>(target->GetFormType()), target);
+        return handle != vm->handlePolicy.EmptyHandle() ? handle : 0;
+    }
+
+    /**
+     * Sends every projected event to its target right away, on the thread that the engine sent the event on.
+     */
+    template <PerfStats::Handler StatsHandler>
+    class ImmediatePolicy {
+
+    public:
+        template <class... Args>
+        void Dispatch(RE::TESObjectREFR* target, const RE::BSFixedString& eventName, Args... args) {
+            auto vm = RE::SkyrimVM::GetSingleton();
+            if (!vm || !target) {
+                return;
+            }
+
+            const auto handle = GetTargetHandle(vm, target);
+            if (!handle) {
+                return;
+            }
+
+            auto eventArgs = RE::MakeFunctionArguments(std::move(args)...);
+            CountStat(StatsHandler, &PerfStats::HandlerCounters::eventsDispatched, 1);
+            CountStat(StatsHandler, &PerfStats::HandlerCounters::variablesPacked, sizeof...(Args));
+
+            EventTargets::TargetedEventFilter filter(eventName);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &const_cast<RE::BSFixedString&>(eventName), eventArgs, &filter);
+        }
+    };
+
+    /**
+     * How the batched policy holds on to an argument until the end of the frame. Forms are stored by
+     * their IDs and looked up again when the batch is sent, in case they were deleted in the meantime.
+     */
+    template <class T>
+    struct BatchedArgument {
+        static_assert(!std::is_same_v<T, bool>, "Papyrus bool[] arguments are not supported in batches");
+
+        using Stored = T;
+
+        static Stored Store(T value) { return value; }
+        static T Resolve(Stored stored) { return stored; }
+        static void ResolveLoaded(SKSE::SerializationInterface*, Stored&) {}
+    };
+
+    template <class T>
+        requires std::derived_from<T, RE::TESForm>
+    struct BatchedArgument<T*> {
+        using Stored = RE::FormID;
+
+        static Stored Store(const T* form) { return form ? form->formID : 0; }
+        static T* Resolve(Stored formID) { return formID ? RE::TESForm::LookupByID<T>(formID) : nullptr; }
+
+        /** Resolves a form ID read from the cosave; forms that no longer exist become None. */
+        static void ResolveLoaded(SKSE::SerializationInterface* serde, Stored& formID) {
+            if (formID && !serde->ResolveFormID(formID, formID)) {
+                formID = 0;
+            }
+        }
+    };
+
+    /**
+     * Collects the projected events of a frame per target and event name, and sends one event per
+     * target with an array per argument (in the same order) from a task at the start of the next frame.
+     */
+    template <PerfStats::Handler StatsHandler, class... Args>
+    class BatchedPolicy {
+        static_assert(sizeof...(Args) > 0, "Batched events need at least one argument");
+
+    public:
+        void Dispatch(RE::TESObjectREFR* target, const RE::BSFixedString& eventName, Args... args) {
+            auto vm = RE::SkyrimVM::GetSingleton();
+            if (!vm || !target || !GetTargetHandle(vm, target)) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lockGuard(pendingMutex);
+
+                auto& columns = pending[{target->formID, &eventName}].columns;
+                AppendRow(columns, std::index_sequence_for<Args...>{}, args...);
+
+                if (haveQueuedUpTask) {
+                    return;
+                }
+                haveQueuedUpTask = true;
+            }
+
+            tasks.AddTaskNextFrame([this]() { this->SendBatches(); });
+        }
+
+        /**
+         * Discards all pending batches.
+         */
+        void Clear() {
+            std::lock_guard<std::mutex> lockGuard(pendingMutex);
+            pending.clear();
+        }
+
+        /**
+         * Writes the pending batches to the cosave, as a record of the given type. Event names are written as
+         * their index in eventNames, which must list every event name that is dispatched through this policy.
+         */
+        void Save(SKSE::SerializationInterface* serde, std::uint32_t type,
+                  std::span<const RE::BSFixedString* const> eventNames) {
+            static_assert((std::is_trivially_copyable_v<typename BatchedArgument<Args>::Stored> && ...),
+                          "Only batches of trivially copyable arguments can be written to the cosave");
+
+            std::lock_guard<std::mutex> lockGuard(pendingMutex);
+
+            if (!serde->OpenRecord(type, 0)) {
+                Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+                return;
+            }
+
+            std::size_t numBatches = pending.size();
+            serde->WriteRecordData(numBatches);
+            for (const auto& [key, batch] : pending) {
+                const auto nameIndex = static_cast<std::uint32_t>(
+                    std::find(eventNames.begin(), eventNames.end(), key.eventName) - eventNames.begin());
+                serde->WriteRecordData(key.target);
+                serde->WriteRecordData(nameIndex);
+
+                std::size_t numRows = std::get<0>(batch.columns).size();
+                serde->WriteRecordData(numRows);
+                std::apply(
+                    [serde](const auto&... columns) {
+                        (serde->WriteRecordData(columns.data(),
+                                                static_cast<std::uint32_t>(columns.size() * sizeof(columns[0]))),
+                         ...);
+                    },
+                    batch.columns);
+            }
+        }
+
+        /**
+         * Reads pending batches written by Save from a record of the given length, and queues up the task to
+         * send them. A truncated or corrupt record drops the batches from where it stops making sense.
+         */
+        void Load(SKSE::SerializationInterface* serde, std::uint32_t length,
+                  std::span<const RE::BSFixedString* const> eventNames) {
+            {
+                std::lock_guard<std::mutex> lockGuard(pendingMutex);
+
+                RecordReader reader{serde, length};
+                std::size_t numBatches;
+                if (!reader.Read(&numBatches, sizeof(numBatches))) {
+                    numBatches = 0;
+                }
+
+                for (; numBatches > 0; --numBatches) {
+                    RE::FormID target;
+                    std::uint32_t nameIndex;
+                    std::size_t numRows;
+                    if (!reader.Read(&target, sizeof(target)) || !reader.Read(&nameIndex, sizeof(nameIndex)) ||
+                        !reader.Read(&numRows, sizeof(numRows)) || numRows > reader.remaining / RowSize) {
+                        Logging::error(Logging::Category::kCosave, "Dropping the rest of a corrupt record of batches.");
+                        break;
+                    }
+
+                    Columns columns;
+                    const bool readColumns = std::apply(
+                        [&reader, numRows](auto&... column) {
+                            return (LoadColumn<Args>(reader, column, numRows) && ...);
+                        },
+                        columns);
+                    if (!readColumns) {
+                        Logging::error(Logging::Category::kCosave, "Dropping the rest of a corrupt record of batches.");
+                        break;
+                    }
+
+                    if (!serde->ResolveFormID(target, target) || nameIndex >= eventNames.size()) {
+                        continue;
+                    }
+
+                    auto& batch = pending[{target, eventNames[nameIndex]}];
+                    batch.columns = std::move(columns);
+                }
+
+                if (pending.empty() || haveQueuedUpTask) {
+                    return;
+                }
+                haveQueuedUpTask = true;
+            }
+
+            tasks.AddTaskNextFrame([this]() { this->SendBatches(); });
+        }
+
+    private:
+        using Columns = std::tuple<std::vector<typename BatchedArgument<Args>::Stored>...>;
+
+        /**
+         * Target and event name. Event names are the definitions' static strings, so their addresses identify them.
+         */
+        struct BatchKey {
+            RE::FormID target;
+            const RE::BSFixedString* eventName;
+
+            bool operator==(const BatchKey&) const = default;
+        };
+
+        struct BatchKeyHash {
+            std::size_t operator()(const BatchKey& key) const {
+                return std::hash<RE::FormID>()(key.target) ^ (std::hash<const void*>()(key.eventName) << 1);
+            }
+        };
+
+        struct Batch {
+            Columns columns;
+        };
+
+        template <std::size_t... Indices>
+        static void AppendRow(Columns& columns, std::index_sequence<Indices...>, Args... args) {
+            (std::get<Indices>(columns).push_back(BatchedArgument<Args>::Store(args)), ...);
+        }
+
+        template <std::size_t... Indices>
+        static void Send(RE::SkyrimVM* vm, RE::VMHandle handle, RE::BSFixedString& eventName, const Columns& columns,
+                         std::index_sequence<Indices...>) {
+            auto eventArgs = RE::MakeFunctionArguments(ResolveColumn<Args>(std::get<Indices>(columns))...);
+            EventTargets::TargetedEventFilter filter(eventName);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &eventName, eventArgs, &filter);
+        }
+
+        /** Size of one row of arguments in the cosave */
+        static constexpr std::size_t RowSize = (sizeof(typename BatchedArgument<Args>::Stored) + ...);
+
+        /**
+         * Reads a record without reading past its end.
+         */
+        struct RecordReader {
+            SKSE::SerializationInterface* serde;
+            std::uint32_t remaining;
+
+            bool Read(void* buf, std::size_t size) {
+                if (size > remaining || serde->ReadRecordData(buf, static_cast<std::uint32_t>(size)) != size) {
+                    remaining = 0;
+                    return false;
+                }
+                remaining -= static_cast<std::uint32_t>(size);
+                return true;
+            }
+        };
+
+        template <class T>
+        static bool LoadColumn(RecordReader& reader, std::vector<typename BatchedArgument<T>::Stored>& column,
+                               std::size_t numRows) {
+            column.resize(numRows);
+            if (!reader.Read(column.data(), numRows * sizeof(column[0]))) {
+                return false;
+            }
+            for (auto& stored : column) {
+                BatchedArgument<T>::ResolveLoaded(reader.serde, stored);
+            }
+            return true;
+        }
+
+        template <class T>
+        static std::vector<T> ResolveColumn(const std::vector<typename BatchedArgument<T>::Stored>& column) {
+            std::vector<T> resolved;
+            resolved.reserve(column.size());
+            for (const auto stored : column) {
+                resolved.push_back(BatchedArgument<T>::Resolve(stored));
+            }
+            return resolved;
+        }
+
+        void SendBatches() {
+            PAPER_PROFILE_SCOPE("EventBridge.SendBatches", "task");
+
+            decltype(pending) batches;
+            {
+                std::lock_guard<std::mutex> lockGuard(pendingMutex);
+                batches.swap(pending);
+                haveQueuedUpTask = false;
+            }
+
+            auto vm = RE::SkyrimVM::GetSingleton();
+            if (!vm) {
+                return;
+            }
+
+            for (const auto& [key, batch] : batches) {
+                const auto target = RE::TESForm::LookupByID<RE::TESObjectREFR>(key.target);
+                if (!target) {
+                    continue;
+                }
+
+                const auto handle = GetTargetHandle(vm, target);
+                if (!handle) {
+                    continue;
+                }
+
+                const auto numRows = std::get<0>(batch.columns).size();
+                CountStat(StatsHandler, &PerfStats::HandlerCounters::eventsDispatched, 1);
+                // Every column is packed as one array argument, with one variable per row
+                CountStat(StatsHandler, &PerfStats::HandlerCounters::variablesPacked,
+                          sizeof...(Args) + sizeof...(Args) * numRows);
+
+                Send(vm, handle, const_cast<RE::BSFixedString&>(*key.eventName), batch.columns,
+                     std::index_sequence_for<Args...>{});
+            }
+        }
+
+        std::unordered_map<BatchKey, Batch, BatchKeyHash> pending;
+        std::mutex pendingMutex;
+        /** Did we already queue up a task to send the pending batches? */
+        bool haveQueuedUpTask = false;
+
+        EngineAdapters::SkyrimTaskQueue tasks;
+    };
+
+    /**
+     * Singleton event sink for the events declared by Definition, sent according to Policy.
+     */
+    template <class Definition, class Policy = ImmediatePolicy<Definition::StatsHandler>>
+    class __declspec(dllexport) EventBridge : public RE::BSTEventSink<typename Definition::Event> {
+
+    public:
+        using Event = typename Definition::Event;
+
+        /**
+         * Overridden from RE::BSTEventSink. Lets us process events received from the game engine.
+         */
+        virtual RE::BSEventNotifyControl ProcessEvent(const Event* a_event,
+                                                      RE::BSTEventSource<Event>* a_eventSource) override {
+            PAPER_PROFILE_SCOPE(Definition::ProfileName, "sink");
+
+            if constexpr (requires(Recording::EventRecorder& recorder) { Definition::Record(recorder, *a_event); }) {
+                auto& recorder = Recording::EventRecorder::GetSingleton();
+                if (a_event && recorder.IsRecording()) {
+                    Definition::Record(recorder, *a_event);
+                }
+            }
+
+            if constexpr (requires(Definition& definition) { definition.Observe(*a_event); }) {
+                if (a_event) {
+                    definition.Observe(*a_event);
+                }
+            }
+
+            if (a_event && Definition::IsEnabled(Core::GetSettings())) {
+                CountStat(Definition::StatsHandler, &PerfStats::HandlerCounters::eventsSeen, 1);
+
+                bool emitted = false;
+                definition.Project(*a_event, [&](RE::TESObjectREFR* target, const RE::BSFixedString& eventName,
+                                                 auto&&... args) {
+                    emitted = true;
+                    policy.Dispatch(target, eventName, std::forward<decltype(args)>(args)...);
+                });
+
+                if (!emitted) {
+                    CountStat(Definition::StatsHandler, &PerfStats::HandlerCounters::eventsFiltered, 1);
+                }
+            }
+
+            // Let other code process the same event next
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        /**
+         * Get the singleton instance of this bridge.
+         */
+        [[nodiscard]] static EventBridge& GetSingleton() noexcept {
+            static EventBridge instance;
+            return instance;
+        }
+
+        [[nodiscard]] Definition& GetDefinition() noexcept { return definition; }
+        [[nodiscard]] Policy& GetPolicy() noexcept { return policy; }
+
+    private:
+        EventBridge() = default;
+        EventBridge(const EventBridge&) = delete;
+        EventBridge(EventBridge&&) = delete;
+        ~EventBridge() = default;
+
+        EventBridge& operator=(const EventBridge&) = delete;
+        EventBridge& operator=(EventBridge&&) = delete;
+
+        Definition definition;
+        Policy policy;
+    };
+#pragma warning(pop)
+}  // namespace EventBridges
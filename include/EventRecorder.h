@@ -0,0 +1,126 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Recording {
+
+    enum class RecordedEventType : std::uint8_t { kFrame, kContainerChanged, kHit, kEquip };
+
+    /**
+     * One fixed-size record of an event log. Which fields are used depends on the type:
+     * - kFrame: timestamp (nanoseconds since the recording started)
+     * - kContainerChanged: forms = {oldContainer, newContainer, baseObj}, value = itemCount
+     * - kHit: forms = {target, cause, source, projectile}, value = flags
+     * - kEquip: forms = {actor, baseObject}, value = equipped
+     */
+    struct RecordedEvent {
+        RecordedEventType type;
+        std::uint8_t reserved[3];
+        std::int32_t value;
+        union {
+            Core::FormID forms[4];
+            std::int64_t timestamp;
+        };
+    };
+    static_assert(sizeof(RecordedEvent) == 24);
+
+    /**
+     * Header at the start of every event log, followed by the records up to the end of the file.
+     */
+    struct EventLogHeader {
+        char magic[4];
+        std::uint32_t version;
+    };
+
+    inline constexpr char EventLogMagic[4] = {'P', 'A', 'E', 'L'};
+    inline constexpr std::uint32_t EventLogVersion = 1;
+
+    /**
+     * Returns the records in the given contents of an event log (e.g., a memory-mapped file), or an empty
+     * span if it is not a valid event log. A truncated last record is ignored.
+     */
+    std::span<const RecordedEvent> ReadEventLog(std::span<const std::byte> contents);
+
+    /**
+     * Records the raw engine events that our sinks receive, with frame boundaries, into an append-only
+     * binary event log. Recording only costs a relaxed atomic load while it is not running. Records are
+     * buffered, and written to the file by a background thread.
+     */
+    class EventRecorder {
+
+    public:
+        [[nodiscard]] static EventRecorder& GetSingleton() noexcept;
+
+        [[nodiscard]] bool IsRecording() const { return recording.load(std::memory_order_relaxed); }
+
+        /**
+         * Sets the directory that event logs are written to.
+         */
+        void SetOutputDirectory(std::filesystem::path directory);
+
+        /**
+         * Starts recording into a new file, and returns its path (or an empty path if it could not be opened).
+         * Stops any recording that was already running first.
+         */
+        std::filesystem::path Start();
+
+        /**
+         * Stops recording, and writes everything that was recorded to the file.
+         */
+        void Stop();
+
+        void RecordFrame();
+        void RecordContainerChanged(Core::FormID oldContainer, Core::FormID newContainer, Core::FormID baseObj,
+                                    std::int32_t itemCount);
+        void RecordHit(Core::FormID target, Core::FormID cause, Core::FormID source, Core::FormID projectile,
+                       std::uint32_t flags);
+        void RecordEquip(Core::FormID actor, Core::FormID baseObject, bool equipped);
+
+    private:
+        EventRecorder() = default;
+        EventRecorder(const EventRecorder&) = delete;
+        EventRecorder(EventRecorder&&) = delete;
+        ~EventRecorder();
+
+        EventRecorder& operator=(const EventRecorder&) = delete;
+        EventRecorder& operator=(EventRecorder&&) = delete;
+
+        /** Number of buffered records at which the writer thread is woken up */
+        static constexpr std::size_t FlushThreshold = 4096;
+
+        void Append(const RecordedEvent& event);
+
+        /**
+         * Body of the writer thread: writes buffered records until recording stops.
+         */
+        void WriteLoop();
+
+        std::atomic<bool> recording = false;
+
+        std::filesystem::path outputDirectory;
+        std::uint32_t numRecordings = 0;
+        std::chrono::steady_clock::time_point start;
+
+        /** Records that still have to be written */
+        std::vector<RecordedEvent> buffer;
+        std::mutex bufferMutex;
+        std::condition_variable bufferReady;
+
+        std::ofstream file;
+        std::thread writer;
+        /** Serializes Start and Stop */
+        std::mutex controlMutex;
+    };
+}  // namespace Recording
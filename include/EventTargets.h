@@ -0,0 +1,101 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+namespace EventTargets {
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+    /**
+     * Our singleton cache of which script types define which event functions. This lets us
+     * send our events only to script objects that actually have a handler for them, instead
+     * of making the VM queue up calls for every script bound to a handle (and all the aliases
+     * and active magic effects the event is relayed to).
+     */
+    class __declspec(dllexport) EventTargetCache {
+
+    public:
+
+        /**
+         * Get the singleton instance of the <code>EventTargetCache</code>.
+         */
+        [[nodiscard]] static EventTargetCache& GetSingleton() noexcept;
+
+        /**
+         * Does any script bound to the given handle define a function with the given event name?
+         */
+        bool HandleHasEventHandler(RE::VMHandle handle, const RE::BSFixedString& eventName);
+
+        /**
+         * Does the given script type (or any of its parents) define a function with the given event name?
+         */
+        bool TypeHasEventHandler(RE::BSScript::ObjectTypeInfo* typeInfo, const RE::BSFixedString& eventName);
+
+        /**
+         * Do we only send events to handles with scripts that define a handler for them?
+         */
+        [[nodiscard]] bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+        void SetEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+
+    private:
+        EventTargetCache() = default;
+        EventTargetCache(const EventTargetCache&) = delete;
+        EventTargetCache(EventTargetCache&&) = delete;
+        ~EventTargetCache() = default;
+
+        EventTargetCache& operator=(const EventTargetCache&) = delete;
+        EventTargetCache& operator=(EventTargetCache&&) = delete;
+
+        /**
+         * Key for the cache: a script type and an event name. Fixed strings are interned,
+         * so the pointer to the string's data identifies the event.
+         */
+        struct TypeEventKey {
+            const RE::BSScript::ObjectTypeInfo* typeInfo;
+            const char* eventName;
+
+            bool operator==(const TypeEventKey&) const = default;
+        };
+
+        struct TypeEventKeyHash {
+            std::size_t operator()(const TypeEventKey& key) const {
+                return std::hash<const void*>()(key.typeInfo) ^ (std::hash<const void*>()(key.eventName) << 1);
+            }
+        };
+
+        struct CachedResult {
+            /** Keeps the script type alive, so its address cannot be reused for a different type */
+            RE::BSTSmartPointer<RE::BSScript::ObjectTypeInfo> typeInfo;
+            bool hasEventHandler;
+        };
+
+        std::unordered_map<TypeEventKey, CachedResult, TypeEventKeyHash> cache;
+        std::shared_mutex cacheMutex;
+
+        std::atomic<bool> enabled = true;
+    };
+
+    /**
+     * Filter that only lets an event through to handles with scripts that define a handler for it,
+     * optionally followed by another filter.
+     */
+    struct TargetedEventFilter : RE::SkyrimVM::ISendEventFilter {
+        TargetedEventFilter(const RE::BSFixedString& eventName, RE::SkyrimVM::ISendEventFilter* nextFilter = nullptr)
+            : eventName(eventName), nextFilter(nextFilter){};
+        TargetedEventFilter() = delete;
+
+        const RE::BSFixedString& eventName;
+        RE::SkyrimVM::ISendEventFilter* nextFilter;
+
+        virtual bool matchesFilter(RE::VMHandle handle) override {
+            auto& eventTargets = EventTargetCache::GetSingleton();
+            if (eventTargets.IsEnabled() && !eventTargets.HandleHasEventHandler(handle, eventName)) {
+                return false;
+            }
+
+            return !nextFilter || nextFilter->matchesFilter(handle);
+        }
+    };
+#pragma warning(pop)
+}  // namespace EventTargets
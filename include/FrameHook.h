@@ -0,0 +1,26 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace FrameHook {
+
+    /**
+     * Hooks the game's main loop, to let the trace and event recorders know about frame boundaries, and to
+     * run the tasks queued up for the next frame.
+     */
+    void Install();
+
+    /**
+     * Queues up a task to run on the main thread at the next frame boundary. Unlike tasks of the SKSE task
+     * interface, a task that queues itself up again this way runs at most once per frame.
+     */
+    void AddTaskNextFrame(std::function<void()> task);
+
+    /**
+     * Number of the current frame, advanced by the hook at every frame boundary.
+     */
+    std::uint64_t GetFrameNumber();
+}  // namespace FrameHook
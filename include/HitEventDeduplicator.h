@@ -0,0 +1,49 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <vector>
+
+namespace Core {
+
+    /** 
+     * Data about recently-processed OnHit events, so we can avoid 
+     * spamming multiple events for a single hit in a short timespan.
+     */
+    struct RecentHitEventData {
+
+        RecentHitEventData(const RE::TESObjectREFR* target, const RE::TESObjectREFR* cause, float applicationRuntime)
+            : target(target), cause(cause), applicationRuntime(applicationRuntime) {}
+
+        /** The target that was hit */
+        const RE::TESObjectREFR* target;
+        /** The cause / aggressor of the hit */
+        const RE::TESObjectREFR* cause;
+        /** Runtime of the Skyrim application at the time the event was received */
+        float applicationRuntime;
+
+    };
+
+    /**
+     * Engine-independent core of the de-duplication of OnImpact events: the engine may send several
+     * hit events for a single hit (e.g., for enchantments on weapons), all in the same frame.
+     */
+    class HitEventDeduplicator {
+
+    public:
+        /**
+         * Forgets about hits from earlier frames, and returns true if we already recorded a hit
+         * for the same target and cause in the frame with the given application runtime.
+         */
+        bool IsDuplicate(const RE::TESObjectREFR* target, const RE::TESObjectREFR* cause, float applicationRuntime);
+
+        /**
+         * Remembers a hit that we processed in the frame with the given application runtime.
+         */
+        void RecordHit(const RE::TESObjectREFR* target, const RE::TESObjectREFR* cause, float applicationRuntime);
+
+    private:
+        /** Keep track of recently-processed hit events here. */
+        std::vector<RecentHitEventData> recentHits;
+    };
+}  // namespace Core
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * Flags of a hit, as kept by the hit telemetry.
+     */
+    enum HitFlags : std::uint8_t {
+        kPowerAttack = 1 << 0,
+        kSneakAttack = 1 << 1,
+        kBashAttack = 1 << 2,
+        kHitBlocked = 1 << 3,
+    };
+
+    /**
+     * Engine-independent store of the recent hits of every (aggressor, target) pair, so that scripts can
+     * query hit rates, blocked hits and the last attackers of actors natively, instead of attaching OnHit
+     * scripts to every actor. Pairs live in a fixed-size ring table: once it is full, a new pair replaces
+     * the pair that was added longest ago (the number of pairs is a setting, and changing it forgets all
+     * recorded hits). Every pair keeps its last HitsPerPair hits. Times are in milliseconds of application
+     * runtime, which is the same for all hits in a frame.
+     */
+    class HitTelemetry {
+
+    public:
+        /** Number of hits that are kept per (aggressor, target) pair */
+        static constexpr std::size_t HitsPerPair = 16;
+
+        /**
+         * Records a hit with the given flags. Several hits of the same pair in the same frame (e.g., for
+         * enchanted weapons) are recorded as one.
+         */
+        void RecordHit(FormID aggressor, FormID target, std::uint8_t flags, std::uint32_t now);
+
+        /**
+         * Returns the aggressors that hit the given target in the given window before now, most recent first.
+         */
+        [[nodiscard]] std::vector<FormID> GetRecentAttackers(FormID target, std::uint32_t now,
+                                                             std::uint32_t window) const;
+
+        /**
+         * Returns the number of hits per second of the given aggressor on the given target, over the
+         * given window before now. Rates above HitsPerPair hits per window are not told apart.
+         */
+        [[nodiscard]] float GetHitRate(FormID aggressor, FormID target, std::uint32_t now,
+                                       std::uint32_t window) const;
+
+        /**
+         * Returns the fraction of the hits of the given aggressor on the given target in the given window
+         * before now that were blocked (0 if there were none).
+         */
+        [[nodiscard]] float GetBlockedRatio(FormID aggressor, FormID target, std::uint32_t now,
+                                            std::uint32_t window) const;
+
+        /**
+         * Returns the number of consecutive power attacks that the most recent hits of the given aggressor
+         * on the given target were.
+         */
+        [[nodiscard]] std::int32_t GetPowerAttackStreak(FormID aggressor, FormID target) const;
+
+        /**
+         * Forgets all recorded hits.
+         */
+        void Revert();
+
+    private:
+        struct HitSample {
+            std::uint32_t time;
+            std::uint8_t flags;
+        };
+
+        /**
+         * The recent hits of one (aggressor, target) pair, in a ring buffer.
+         */
+        struct PairSlot {
+            std::uint64_t key = 0;
+            std::array<HitSample, HitsPerPair> hits{};
+            /** Index of the most recent hit */
+            std::uint8_t newest = 0;
+            std::uint8_t numHits = 0;
+
+            [[nodiscard]] const HitSample& Hit(std::size_t age) const {
+                return hits[(newest + HitsPerPair - age) % HitsPerPair];
+            }
+        };
+
+        static std::uint64_t MakePairKey(FormID aggressor, FormID target) {
+            return (static_cast<std::uint64_t>(aggressor) << 32) | static_cast<std::uint64_t>(target);
+        }
+
+        /**
+         * Returns the slot of the given pair, or nullptr if it has none. Caller must hold the lock.
+         */
+        const PairSlot* FindSlot(FormID aggressor, FormID target) const;
+
+        /**
+         * Calls the given function with the flags of every hit of the pair in the window before now.
+         * Returns the number of such hits. Caller must hold the lock.
+         */
+        template <class Visit>
+        std::size_t VisitHitsInWindow(const PairSlot& slot, std::uint32_t now, std::uint32_t window,
+                                      Visit&& visit) const;
+
+        /** The ring table of pairs; empty until the first hit */
+        std::vector<PairSlot> slots;
+        /** Slot of every pair in the ring table */
+        std::unordered_map<std::uint64_t, std::uint32_t> slotIndices;
+        /** The slot that the next new pair takes */
+        std::size_t nextSlot = 0;
+
+        mutable std::mutex mutex;
+    };
+}  // namespace Core
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+namespace Core {
+
+    /**
+     * Does an item with the given form ID pass the given inventory event filter lists? An item passes if
+     * it is one of the filtered items, or is contained in one of the filtered form lists.
+     */
+    template <class ItemRange, class ItemListRange>
+    bool ItemPassesInventoryFilterLists(const FormID itemID, const ItemRange& itemsForFiltering,
+                                        const ItemListRange& itemListsForFiltering, const IFormLookup& forms) {
+        for (auto it = itemsForFiltering.begin(); it != itemsForFiltering.end(); ++it) {
+            if ((*it) == itemID) {
+                return true;
+            }
+        }
+
+        for (auto it = itemListsForFiltering.begin(); it != itemListsForFiltering.end(); ++it) {
+            if (forms.FormListHasForm(*it, itemID)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}  // namespace Core
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * Result of grouping the indices of an inventory event's arrays by some key. Indices that
+     * share a key are stored contiguously (in their original order) in groupedIndices, and
+     * group k occupies the range [groupOffsets[k], groupOffsets[k + 1]) of that array.
+     */
+    struct InventoryEventGrouping {
+        std::vector<std::int32_t> groupedIndices;
+        std::vector<std::int32_t> groupOffsets;
+    };
+
+    /**
+     * The counting sort that the groupings below share: given the group of every element (-1 for
+     * elements that are left out) and the size of every group, stores the indices of the elements
+     * by group. The sizes are used up as write cursors.
+     */
+    inline InventoryEventGrouping ScatterIntoGroups(const std::vector<std::int32_t>& elementGroups,
+                                                    std::vector<std::int32_t>& groupSizes) {
+        InventoryEventGrouping grouping;
+
+        grouping.groupOffsets.reserve(groupSizes.size() + 1);
+        grouping.groupOffsets.push_back(0);
+        for (const auto groupSize : groupSizes) {
+            grouping.groupOffsets.push_back(grouping.groupOffsets.back() + groupSize);
+        }
+
+        std::copy(grouping.groupOffsets.begin(), grouping.groupOffsets.end() - 1, groupSizes.begin());
+        grouping.groupedIndices.resize(grouping.groupOffsets.back());
+        for (std::size_t i = 0; i < elementGroups.size(); ++i) {
+            if (elementGroups[i] >= 0) {
+                grouping.groupedIndices[groupSizes[elementGroups[i]]++] = static_cast<std::int32_t>(i);
+            }
+        }
+
+        return grouping;
+    }
+
+    /**
+     * Groups the indices [0, numElements) by the keys returned by getKey, in a single pass over
+     * the elements followed by a counting sort. Groups are ordered by first occurrence of their key.
+     */
+    template <class Key, class GetKey>
+    InventoryEventGrouping GroupInventoryEventIndices(const std::size_t numElements, GetKey getKey) {
+        std::unordered_map<Key, std::int32_t> groupIDs;
+        std::vector<std::int32_t> elementGroups;
+        std::vector<std::int32_t> groupSizes;
+        elementGroups.reserve(numElements);
+
+        for (std::size_t i = 0; i < numElements; ++i) {
+            const auto [it, inserted] = groupIDs.try_emplace(getKey(i), static_cast<std::int32_t>(groupSizes.size()));
+            if (inserted) {
+                groupSizes.push_back(0);
+            }
+
+            elementGroups.push_back(it->second);
+            ++groupSizes[it->second];
+        }
+
+        return ScatterIntoGroups(elementGroups, groupSizes);
+    }
+
+    /**
+     * Groups the indices [0, numElements) into numGroups groups in a fixed order: group k holds the
+     * elements for which getGroup returns k, and may be empty. Elements for which getGroup returns an
+     * empty optional are left out.
+     */
+    template <class GetGroup>
+    InventoryEventGrouping GroupInventoryEventIndicesInto(const std::size_t numElements, const std::size_t numGroups,
+                                                          GetGroup getGroup) {
+        std::vector<std::int32_t> elementGroups;
+        std::vector<std::int32_t> groupSizes(numGroups, 0);
+        elementGroups.reserve(numElements);
+
+        for (std::size_t i = 0; i < numElements; ++i) {
+            const std::optional<std::size_t> group = getGroup(i);
+            elementGroups.push_back(group ? static_cast<std::int32_t>(*group) : -1);
+            if (group) {
+                ++groupSizes[*group];
+            }
+        }
+
+        return ScatterIntoGroups(elementGroups, groupSizes);
+    }
+}  // namespace Core
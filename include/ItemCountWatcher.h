@@ -0,0 +1,128 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * The engine services that the item count watcher uses.
+     */
+    struct ItemCountWatcherServices {
+        IFormLookup& forms;
+        IInventoryLookup& inventory;
+        IHandlePolicy& handles;
+        IEventSender& sender;
+        ITaskQueue& tasks;
+    };
+
+    /**
+     * Engine-independent core of the OnItemCountThresholdCrossed events: keeps running counts of watched
+     * items in watched containers, seeded once from the inventory and then updated from the same
+     * container-changed events that feed the item event batcher. Once per frame, every watched threshold
+     * that the count crossed (in either direction) since the previous frame is reported to the container.
+     */
+    class ItemCountWatcher {
+
+    public:
+        explicit ItemCountWatcher(ItemCountWatcherServices services) : services(services) {}
+        ItemCountWatcher(const ItemCountWatcher&) = delete;
+        ItemCountWatcher(ItemCountWatcher&&) = delete;
+
+        ItemCountWatcher& operator=(const ItemCountWatcher&) = delete;
+        ItemCountWatcher& operator=(ItemCountWatcher&&) = delete;
+
+        /**
+         * Watches the count of the given item in the given container for crossings of the given threshold:
+         * the count going from below the threshold to at least the threshold, or the other way around.
+         * Must be called on the main thread, or while it is blocked, since it reads the inventory.
+         */
+        void Watch(FormID container, FormID item, std::int32_t threshold);
+
+        /**
+         * Stops watching for crossings of the given threshold. Counts are dropped once no threshold
+         * of the item in the container is watched anymore.
+         */
+        void Unwatch(FormID container, FormID item, std::int32_t threshold);
+
+        /**
+         * Updates the counts for a change of itemCount items of baseObj, from oldContainer to newContainer
+         * (either of which may be 0), and queues up the task to report crossed thresholds.
+         */
+        void RecordEvent(FormID oldContainer, FormID newContainer, FormID baseObj, std::int32_t itemCount);
+
+        void SendItemCountEvents();
+
+        /**
+         * Discards all watches.
+         */
+        void Revert();
+
+        /**
+         * Writes all watches to the cosave.
+         */
+        void Save(ISerializationInterface& serde);
+
+        /**
+         * Reads the cosave record of the given type, if it is one of ours. Returns false if the record
+         * belongs to someone else.
+         */
+        bool LoadRecord(ISerializationInterface& serde, std::uint32_t type);
+
+        /**
+         * Called once all the records of a cosave have been read: queues up re-seeding the counts of the
+         * loaded watches from the inventories, since they are not stored in the cosave.
+         */
+        void FinishLoad();
+
+        static constexpr std::uint32_t ItemCountWatchesRecord = MakeRecordType("ICWT");
+
+    private:
+        /**
+         * A watched item in a watched container.
+         */
+        struct WatchedCount {
+            /** Running count of the item in the container */
+            std::int32_t itemCount = 0;
+            /** Count at the time we last checked the thresholds */
+            std::int32_t reportedCount = 0;
+            /** Thresholds to report crossings of */
+            std::vector<std::int32_t> thresholds;
+        };
+
+        static constexpr std::uint64_t MakeWatchKey(FormID container, FormID item) {
+            return (static_cast<std::uint64_t>(container) << 32) | item;
+        }
+
+        /**
+         * Adds the given delta to the count of the item in the container, if it is watched. Caller must hold
+         * the lock on the watches.
+         */
+        void ApplyDelta(FormID container, FormID item, std::int32_t delta);
+
+        /**
+         * Sets all the counts to what the inventories hold right now, without reporting any crossings.
+         */
+        void SeedCounts();
+
+        ItemCountWatcherServices services;
+
+        /** Watched counts, per (container, item) key */
+        std::unordered_map<std::uint64_t, WatchedCount> watches;
+        /** Keys of the watched counts that changed since we last checked their thresholds */
+        std::unordered_set<std::uint64_t> changedWatches;
+        /** Mutex for access to the watches */
+        std::mutex watchesMutex;
+        /** Is anything watched at all? Lets the sink skip the lock for the vast majority of events. */
+        std::atomic<bool> haveWatches = false;
+
+        /** Did we already queue up a task to check the thresholds of changed counts? */
+        bool haveQueuedUpTask = false;
+    };
+}  // namespace Core
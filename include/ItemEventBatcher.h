@@ -0,0 +1,514 @@
+#pragma once
+
+#include <DispatchScheduler.h>
+#include <EngineInterfaces.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * Data for an event to be processed.
+     */
+    struct ItemEvent {
+        ItemEvent(FormID otherContainer, FormID baseObj, std::int32_t itemCount)
+            : otherContainer(otherContainer), baseObj(baseObj), itemCount(itemCount) {}
+        ItemEvent() = delete;
+
+        FormID otherContainer;
+        FormID baseObj;
+        std::int32_t itemCount;
+    };
+
+    /**
+     * The pending events of one container (or pair of containers, for transfers), with what is needed to
+     * tell when its batching window closes. Allocator-aware, so that its events are allocated from the
+     * same arena as the map that holds it.
+     */
+    struct ItemEventBatch {
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        using Clock = std::chrono::steady_clock;
+
+        explicit ItemEventBatch(const allocator_type& alloc) : events(alloc), opened(Clock::now()) {}
+        ItemEventBatch(const ItemEventBatch& other, const allocator_type& alloc)
+            : events(other.events, alloc), opened(other.opened), framesWaited(other.framesWaited) {}
+        ItemEventBatch(ItemEventBatch&& other, const allocator_type& alloc)
+            : events(std::move(other.events), alloc), opened(other.opened), framesWaited(other.framesWaited) {}
+
+        std::pmr::vector<ItemEvent> events;
+        /** When the first event of this batch was recorded */
+        Clock::time_point opened;
+        /** Number of frames that this batch has waited for its batching window */
+        std::uint32_t framesWaited = 0;
+    };
+
+    /**
+     * Map from keys (containers) to batched item events. All its storage is allocated from one of two
+     * monotonic arenas. After dispatching, the batches that have to wait for later frames are moved into
+     * the other arena, and everything in the current one is released in one go, so once the arenas' initial
+     * buffers are large enough for a frame's worth of events, batching them does not allocate, and
+     * batches that wait for multiple frames do not keep the arena from being released.
+     */
+    template <class Key>
+    class BatchedItemEventsMap {
+
+    public:
+        using Map = std::pmr::unordered_map<Key, ItemEventBatch>;
+
+        BatchedItemEventsMap() = default;
+        BatchedItemEventsMap(const BatchedItemEventsMap&) = delete;
+        BatchedItemEventsMap(BatchedItemEventsMap&&) = delete;
+
+        BatchedItemEventsMap& operator=(const BatchedItemEventsMap&) = delete;
+        BatchedItemEventsMap& operator=(BatchedItemEventsMap&&) = delete;
+
+        ItemEventBatch& operator[](const Key key) { return (*Current().map)[key]; }
+
+        auto begin() { return Current().map->begin(); }
+        auto end() { return Current().map->end(); }
+        auto begin() const { return Current().map->begin(); }
+        auto end() const { return Current().map->end(); }
+
+        [[nodiscard]] std::size_t size() const { return Current().map->size(); }
+        [[nodiscard]] bool empty() const { return Current().map->empty(); }
+
+        /**
+         * Removes all the batched events, and releases everything that was allocated from the arena.
+         */
+        void clear() { Current().Reset(); }
+
+        /**
+         * Keeps only the batches for which keep(key, batch) returns true, by moving them into the other
+         * arena. Everything else in the current arena is released, and the two arenas swap roles.
+         */
+        template <class Keep>
+        void RetainIf(Keep&& keep) {
+            auto& next = *halves[1 - current].map;
+            for (auto& [key, batch] : *Current().map) {
+                if (keep(key, batch)) {
+                    next.emplace(key, std::move(batch));
+                }
+            }
+
+            Current().Reset();
+            current = 1 - current;
+        }
+
+    private:
+        /** Size of the buffer that each arena allocates from before it needs to go to the heap */
+        static constexpr std::size_t InitialBufferSize = 64 * 1024;
+
+        struct Half {
+            Half() : arena(initialBuffer.data(), initialBuffer.size()) { map.emplace(&arena); }
+
+            void Reset() {
+                map.reset();
+                arena.release();
+                map.emplace(&arena);
+            }
+
+            alignas(std::max_align_t) std::array<std::byte, InitialBufferSize> initialBuffer;
+            std::pmr::monotonic_buffer_resource arena;
+            std::optional<Map> map;
+        };
+
+        Half& Current() { return halves[current]; }
+        const Half& Current() const { return halves[current]; }
+
+        /** The two arenas with their maps; all batches live in the current one, and the other one is empty */
+        std::array<Half, 2> halves;
+        std::size_t current = 0;
+    };
+
+    /**
+     * Reusable arrays holding the arguments for one batched inventory event. They keep their
+     * capacity between events, so filling them does not allocate after the first few frames.
+     */
+    struct ItemEventPayload {
+        std::vector<RE::TESForm*> baseItems;
+        std::vector<std::int32_t> itemCounts;
+        std::vector<RE::TESObjectREFR*> otherContainers;
+        /** Only used for global item movement events */
+        std::vector<RE::TESObjectREFR*> containers;
+
+        /** Only used for item-transferred events */
+        RE::TESObjectREFR* sourceContainer = nullptr;
+        /** Only used for item-transferred events */
+        RE::TESObjectREFR* destContainer = nullptr;
+
+        /** If not empty, only the objects (the container or its aliases) with these handles receive the event */
+        std::span<const VMHandle> receivers;
+        /** Objects with these handles do not receive the event, even though it is sent to their container */
+        std::span<const VMHandle> excludedReceivers;
+
+        void clear() {
+            baseItems.clear();
+            itemCounts.clear();
+            otherContainers.clear();
+            containers.clear();
+            sourceContainer = nullptr;
+            destContainer = nullptr;
+            receivers = {};
+            excludedReceivers = {};
+        }
+    };
+
+    /**
+     * One change of the inventory of a container, as reported in global item movement events. The count
+     * is positive for items added to the container, and negative for items removed from it.
+     */
+    struct ItemMovement {
+        FormID container;
+        FormID otherContainer;
+        FormID baseObj;
+        std::int32_t itemCount;
+    };
+
+    /**
+     * The filter of a form registered for global item movement events. With an empty filter, all items pass.
+     */
+    struct GlobalItemMovementFilter {
+        /** Items that pass the filter */
+        std::vector<FormID> items;
+        /** Form lists whose items pass the filter */
+        std::vector<FormID> itemLists;
+
+        [[nodiscard]] bool IsEmpty() const { return items.empty() && itemLists.empty(); }
+    };
+
+    /**
+     * The engine services that the item event batcher uses.
+     */
+    struct ItemEventBatcherServices {
+        IFormLookup& forms;
+        IHandlePolicy& handles;
+        IEventSender& sender;
+        ITaskQueue& tasks;
+    };
+
+    /**
+     * Engine-independent core of the OnBatchItems* events: batches up container-changed events per container
+     * (or per pair of containers, for transfers), dispatches them as one event per container, and reads / writes
+     * pending batches from / to the cosave.
+     */
+    class ItemEventBatcher {
+
+    public:
+        explicit ItemEventBatcher(ItemEventBatcherServices services) : services(services) {}
+        ItemEventBatcher(const ItemEventBatcher&) = delete;
+        ItemEventBatcher(ItemEventBatcher&&) = delete;
+
+        ItemEventBatcher& operator=(const ItemEventBatcher&) = delete;
+        ItemEventBatcher& operator=(ItemEventBatcher&&) = delete;
+
+        /**
+         * Records a change of itemCount items of baseObj, from oldContainer to newContainer
+         * (either of which may be 0), and queues up the tasks to dispatch it.
+         */
+        void RecordEvent(FormID oldContainer, FormID newContainer, FormID baseObj, std::int32_t itemCount);
+
+        void SendItemAddedEvents();
+        void SendItemRemovedEvents();
+        void SendItemTransferredEvents();
+        void SendGlobalItemMovementEvents();
+
+        /**
+         * Registers the object with the given handle (the container itself, or one of its aliases) for
+         * OnBatchItemsTransferred events of the given container. Moves between this container and another
+         * container will no longer be sent to the scripts attached to that object as OnBatchItemsAdded /
+         * OnBatchItemsRemoved events; the scripts attached to the container's other objects still receive them.
+         */
+        void RegisterForItemsTransferred(FormID container, VMHandle receiver);
+
+        /**
+         * Unregisters the object with the given handle from OnBatchItemsTransferred events of the given container.
+         */
+        void UnregisterForItemsTransferred(FormID container, VMHandle receiver);
+
+        /**
+         * Registers the given form (e.g., a quest) for a single, frame-batched OnGlobalItemMovement event
+         * with the changes of all inventories in the world whose items pass the given filter. Registering
+         * again replaces the filter.
+         */
+        void RegisterForGlobalItemMovement(FormID receiver, GlobalItemMovementFilter filter);
+
+        /**
+         * Unregisters the given form from OnGlobalItemMovement events.
+         */
+        void UnregisterForGlobalItemMovement(FormID receiver);
+
+        /**
+         * Makes the events of the given container go before those of all other containers except the
+         * player and followers, when not all batches can be sent in the same frame.
+         */
+        void RegisterHighPriority(FormID container);
+
+        /**
+         * Makes the given container an ordinary container again for the order in which events are sent.
+         */
+        void UnregisterHighPriority(FormID container);
+
+        /**
+         * Gives the given container its own batching window: its batches are sent once their first event
+         * is at least the given number of milliseconds old, instead of after the global batching window.
+         * A negative number of milliseconds makes the container use the global window again.
+         */
+        void SetBatchWindow(FormID container, std::int32_t milliseconds);
+
+        /**
+         * Discards all pending events and registrations.
+         */
+        void Revert();
+
+        /**
+         * Writes all pending events and registrations to the cosave.
+         */
+        void Save(ISerializationInterface& serde);
+
+        /**
+         * Reads the record of the given type from the cosave, if it is one of ours.
+         * Returns false if the record belongs to someone else.
+         */
+        bool LoadRecord(ISerializationInterface& serde, std::uint32_t type);
+
+        /**
+         * Queues up the tasks to dispatch any events that were read from the cosave.
+         */
+        void FinishLoad();
+
+        /**
+         * Key for the map of batched item-transferred events: source container in the
+         * high bits, destination container in the low bits.
+         */
+        static std::uint64_t MakeTransferKey(FormID source, FormID dest) {
+            return (static_cast<std::uint64_t>(source) << 32) | static_cast<std::uint64_t>(dest);
+        }
+
+        static constexpr std::uint32_t ItemsAddedRecord = MakeRecordType("IAEV");
+        static constexpr std::uint32_t ItemsRemovedRecord = MakeRecordType("IREV");
+        static constexpr std::uint32_t ItemsTransferredRecord = MakeRecordType("ITEV");
+        static constexpr std::uint32_t TransferRegistrationsRecord = MakeRecordType("TREG");
+        static constexpr std::uint32_t GlobalMovementRegistrationsRecord = MakeRecordType("GMRG");
+        static constexpr std::uint32_t BatchWindowsRecord = MakeRecordType("IBWN");
+
+    private:
+        /**
+         * Is any object of the given container registered for OnBatchItemsTransferred events?
+         * Caller must hold the lock on transferRegistrationsMutex.
+         */
+        bool IsRegisteredForItemsTransferred(FormID container) const;
+
+        /**
+         * Replaces the contents of the given vector with the handles of the objects registered for
+         * OnBatchItemsTransferred events of the given container.
+         */
+        void GetTransferReceivers(FormID container, std::vector<VMHandle>& receivers) const;
+
+        /**
+         * Resolves a handle from a cosave: the form ID in its lower half may have changed.
+         */
+        bool ResolveLoadedHandle(ISerializationInterface& serde, VMHandle handle, VMHandle& newHandle);
+
+        /**
+         * How long batches wait before they are sent: until both the number of frames and the duration
+         * have passed.
+         */
+        struct BatchWindow {
+            std::uint32_t frames;
+            std::chrono::milliseconds duration;
+        };
+
+        /**
+         * Returns the batching window of the given container: its own window if it has one, or the
+         * global window from the settings otherwise.
+         */
+        BatchWindow GetBatchWindow(FormID container, const BatchWindow& globalWindow) const;
+
+        /**
+         * Returns the batching window of a pair of containers: the shortest of their windows, so that
+         * neither of them waits longer for its events than it asked for.
+         */
+        BatchWindow GetBatchWindow(std::uint64_t transferKey, const BatchWindow& globalWindow) const;
+
+        /**
+         * Returns true if the given batch can be sent now: its window has passed, or it already reached
+         * the max batch size. Counts another frame of waiting for the batch if not.
+         */
+        static bool IsBatchReady(ItemEventBatch& batch, const BatchWindow& window, std::uint32_t maxBatchSize,
+                                 ItemEventBatch::Clock::time_point now);
+
+        /**
+         * The containers that one kind of event was sent to in a frame, counted against
+         * maxContainersPerFrame.
+         */
+        struct FrameBudget {
+            std::uint64_t frame = 0;
+            std::uint32_t numSent = 0;
+        };
+
+        /**
+         * Returns how many more containers the given budget allows events to be sent to in the current
+         * frame, starting it over if the frame changed since it was last used.
+         */
+        std::uint32_t GetRemainingBudget(FrameBudget& budget, std::uint32_t maxPerFrame) const;
+
+        /**
+         * Orders the ready batches, and returns how many of them fit in what is left of the budget for
+         * the current frame, which they are taken from.
+         */
+        std::size_t ScheduleWithinBudget(FrameBudget& budget, std::uint64_t& roundRobinCursor);
+
+        /**
+         * Appends an event to the pending events of a container, unless they are already at the cap.
+         */
+        static void AppendEvent(ItemEventBatch& batch, FormID otherContainer, FormID baseObj, std::int32_t itemCount);
+
+        /**
+         * Sends one batched event per container in the given map whose batching window has passed (up to
+         * the dispatch budget, in the order of the scheduler), and removes them from the map. Returns false
+         * if some containers are left for later frames.
+         */
+        bool SendItemEvents(ItemEventKind kind, BatchedItemEventsMap<FormID>& eventsMap, FrameBudget& budget,
+                            std::uint64_t& roundRobinCursor);
+
+        /**
+         * A batched item-added / item-removed event that is ready to be prepared and sent: the handle of its
+         * container, and its payload, presized for the events of its batch.
+         */
+        struct PreparedItemEvent {
+            VMHandle handle = 0;
+            const std::pmr::vector<ItemEvent>* events = nullptr;
+            ItemEventPayload payload;
+            /** Objects of the container that receive its moves as item-transferred events instead */
+            std::vector<VMHandle> transferReceivers;
+        };
+
+        /**
+         * Sends a prepared event of a container with objects registered for item-transferred events: all of
+         * it to the other objects, and only the events without another container to the registered ones.
+         */
+        void SendWithoutTransfers(ItemEventKind kind, PreparedItemEvent& prepared);
+
+        /**
+         * Fills the presized payload of the given event from its batch: the form lookups of all its events.
+         * Only touches the given event, so events of different containers can be prepared in parallel.
+         */
+        void PreparePayload(PreparedItemEvent& prepared) const;
+
+        /**
+         * Adds the events of a container in one of the batched maps to the pending global item movements,
+         * if anything is registered for them. Caller must hold the lock on the map.
+         */
+        void CollectItemMovements(FormID container, const std::pmr::vector<ItemEvent>& events, bool removed);
+
+        /**
+         * Queues up the task to send global item movement events, if there are any pending movements.
+         */
+        void QueueGlobalItemMovementTask();
+
+        void SaveItemEventsMap(ISerializationInterface& serde, std::uint32_t type,
+                               const BatchedItemEventsMap<FormID>& eventsMap);
+        void LoadItemEventsMap(ISerializationInterface& serde, BatchedItemEventsMap<FormID>& eventsMap);
+
+        /**
+         * Resolves a form ID read from the cosave, counting it if it could not be found.
+         */
+        bool ResolveLoadedFormID(ISerializationInterface& serde, FormID formID, FormID& newFormID);
+
+        ItemEventBatcherServices services;
+
+        /** Decides which containers get their events first */
+        DispatchScheduler scheduler{services.forms};
+        /** The batches that are ready to be sent in the current send task, reused between frames */
+        std::vector<ScheduledBatch> readyBatches;
+
+        /** Map of batched item-added events, to be processed */
+        BatchedItemEventsMap<FormID> batchedItemAddedEventsMap;
+        /** Map of batched item-removed events, to be processed */
+        BatchedItemEventsMap<FormID> batchedItemRemovedEventsMap;
+        /** Mutex for access to map with item-added events to be processed */
+        std::mutex batchedItemAddedEventsMapMutex;
+        /** Mutex for access to map with item-removed events to be processed */
+        std::mutex batchedItemRemovedEventsMapMutex;
+        /** Did we already queue up a task to process item-added events? */
+        bool haveQueuedUpTaskAddedEvents = false;
+        /** Did we already queue up a task to process item-removed events? */
+        bool haveQueuedUpTaskRemovedEvents = false;
+        /** Where the round-robin order of ordinary containers continues, for item-added events */
+        std::uint64_t roundRobinCursorAddedEvents = 0;
+        /** Where the round-robin order of ordinary containers continues, for item-removed events */
+        std::uint64_t roundRobinCursorRemovedEvents = 0;
+        /** The containers sent item-added events to in the current frame */
+        FrameBudget frameBudgetAddedEvents;
+        /** The containers sent item-removed events to in the current frame */
+        FrameBudget frameBudgetRemovedEvents;
+
+        /** Map of batched item-transferred events (keyed by source and destination container), to be processed */
+        BatchedItemEventsMap<std::uint64_t> batchedItemTransferredEventsMap;
+        /** Mutex for access to map with item-transferred events to be processed */
+        std::mutex batchedItemTransferredEventsMapMutex;
+        /** Did we already queue up a task to process item-transferred events? */
+        bool haveQueuedUpTaskTransferredEvents = false;
+        /** Where the round-robin order of ordinary pairs of containers continues, for item-transferred events */
+        std::uint64_t roundRobinCursorTransferredEvents = 0;
+        /** The pairs of containers sent item-transferred events to in the current frame */
+        FrameBudget frameBudgetTransferredEvents;
+
+        /** Containers with the handles of their objects that registered for OnBatchItemsTransferred events */
+        std::unordered_map<FormID, std::vector<VMHandle>> transferRegistrations;
+        /** Mutex for access to the objects registered for item-transferred events */
+        mutable std::mutex transferRegistrationsMutex;
+
+        /** Containers with their own batching window, in milliseconds */
+        std::unordered_map<FormID, std::uint32_t> batchWindows;
+        /** Mutex for access to the containers with their own batching window */
+        mutable std::mutex batchWindowsMutex;
+        /** Does any container have its own batching window? Lets the send tasks skip looking them up. */
+        std::atomic<bool> haveBatchWindows = false;
+
+        /** Forms registered for OnGlobalItemMovement events, with their filters */
+        std::unordered_map<FormID, GlobalItemMovementFilter> globalMovementRegistrations;
+        /** Mutex for access to the forms registered for global item movement events */
+        mutable std::mutex globalMovementRegistrationsMutex;
+        /** Is anything registered for global item movement events? Lets the send tasks skip collecting movements. */
+        std::atomic<bool> haveGlobalMovementRegistrations = false;
+
+        /** Movements collected from the batched maps, to be sent in global item movement events */
+        std::vector<ItemMovement> pendingItemMovements;
+        /** The movements that the global item movement task is currently sending */
+        std::vector<ItemMovement> itemMovementsBeingSent;
+        /** Mutex for access to the pending global item movements */
+        std::mutex pendingItemMovementsMutex;
+        /** Did we already queue up a task to send global item movement events? */
+        bool haveQueuedUpTaskGlobalMovements = false;
+
+        /** Reusable payload for the batched inventory event that is currently being sent */
+        ItemEventPayload itemEventPayload;
+        /** Reusable handles of the objects registered for item-transferred events of one container */
+        std::vector<VMHandle> transferReceivers;
+        /**
+         * The item-added / item-removed events of the current send task, one per container. Kept between
+         * frames, so that the payloads keep their capacity.
+         */
+        std::vector<PreparedItemEvent> preparedItemEvents;
+        /** Reusable payload with all the movements of a global item movement event, before filtering */
+        ItemEventPayload globalMovementPayload;
+
+        /** Did the last cosave we loaded contain pending events of each kind? */
+        bool loadedItemAddedEvents = false;
+        bool loadedItemRemovedEvents = false;
+        bool loadedItemTransferredEvents = false;
+        /** Number of form IDs in the cosave we are loading that could not be resolved */
+        std::size_t numUnresolvedFormIDs = 0;
+    };
+}  // namespace Core
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Logging {
+
+    /**
+     * Categories of log messages. Every category gets its own logger (named as in CategoryNames),
+     * so that their levels can be changed separately at runtime.
+     */
+    enum class Category : std::uint8_t { kGeneral, kEvents, kCosave, kStats, kTrace, kTotal };
+
+    inline constexpr std::string_view CategoryNames[] = {"Global", "Events", "Cosave", "Stats", "Trace"};
+
+    /** Number of messages that fit in the queue of the background logging thread */
+    inline constexpr std::size_t QueueSize = 8192;
+    /** How often the background thread flushes the sinks */
+    inline constexpr auto FlushInterval = std::chrono::seconds(3);
+    /** Identical messages logged within this window of each other are only written once */
+    inline constexpr auto DuplicateWindow = std::chrono::seconds(5);
+
+    /**
+     * Creates the loggers of all categories, writing to the given sinks. The loggers are asynchronous:
+     * formatting and writing happen on a background thread, and when its queue is full the oldest
+     * messages are dropped, so logging never blocks the calling thread. Sinks are flushed periodically,
+     * and immediately after errors. The logger of kGeneral becomes the default logger.
+     */
+    void Initialize(std::vector<spdlog::sink_ptr> sinks, spdlog::level::level_enum level);
+
+    /**
+     * Returns the logger of the given category (the default logger if Initialize was never called).
+     */
+    [[nodiscard]] spdlog::logger& Get(Category category);
+
+    /**
+     * Sets the level of the category with the given name (case-insensitive), or of all categories
+     * if the name is empty. Returns false if there is no such category.
+     */
+    bool SetLevel(std::string_view categoryName, spdlog::level::level_enum level);
+
+    /**
+     * Logs a message of the given category at the level of the function's name, such as
+     * Logging::error(Logging::Category::kCosave, "..."), with the file and line it was logged from (like
+     * CommonLibSSE's logger:: functions do for the default logger).
+     */
+#define PAPER_MAKE_CATEGORY_LOGGER(a_func, a_level)                                                                  \
+    template <class... Args>                                                                                         \
+    struct [[maybe_unused]] a_func {                                                                                 \
+        a_func() = delete;                                                                                           \
+        explicit a_func(Category category, spdlog::format_string_t<Args...> fmt, Args&&... args,                     \
+                        std::source_location location = std::source_location::current()) {                          \
+            Get(category).log(spdlog::source_loc{location.file_name(), static_cast<int>(location.line()),           \
+                                                 location.function_name()},                                          \
+                              spdlog::level::a_level, fmt, std::forward<Args>(args)...);                             \
+        }                                                                                                            \
+    };                                                                                                               \
+    template <class... Args>                                                                                         \
+    a_func(Category, spdlog::format_string_t<Args...>, Args&&...) -> a_func<Args...>;
+
+    PAPER_MAKE_CATEGORY_LOGGER(trace, trace);
+    PAPER_MAKE_CATEGORY_LOGGER(debug, debug);
+    PAPER_MAKE_CATEGORY_LOGGER(info, info);
+    PAPER_MAKE_CATEGORY_LOGGER(warn, warn);
+    PAPER_MAKE_CATEGORY_LOGGER(error, err);
+    PAPER_MAKE_CATEGORY_LOGGER(critical, critical);
+
+#undef PAPER_MAKE_CATEGORY_LOGGER
+}  // namespace Logging
@@ -2,6 +2,11 @@
 
 #include <RE/Skyrim.h>
 
+#include <EngineAdapters.h>
+#include <ItemCountWatcher.h>
+#include <ItemEventBatcher.h>
+#include <PerfStats.h>
+
 namespace OnContainerChangedEvents {
 #pragma warning(push)
 #pragma warning(disable : 4251)
@@ -13,17 +18,104 @@ namespace OnContainerChangedEvents {
         return *(reinterpret_cast<T*>((uintptr_t)object + offset.offset()));
     }
 
-    /** 
-     * Data for an event to be processed.
+    /**
+     * Arguments for OnBatchItemsAdded / OnBatchItemsRemoved events, packed straight from a payload.
+     * Unlike RE::MakeFunctionArguments(), this does not copy the arrays or allocate a new object per event.
+     */
+    class ItemEventArguments : public RE::BSScript::IFunctionArguments {
+
+    public:
+        virtual bool operator()(RE::BSScrapArray<RE::BSScript::Variable>& a_dst) const override {
+            a_dst.resize(3);
+            a_dst[0].Pack(payload->baseItems);
+            a_dst[1].Pack(payload->itemCounts);
+            a_dst[2].Pack(payload->otherContainers);
+            PAPER_STATS_COUNT(kContainerChanged, variablesPacked, 3 + 3 * payload->baseItems.size());
+            return true;
+        }
+
+        /** The payload of the event currently being sent */
+        const Core::ItemEventPayload* payload = nullptr;
+    };
+
+    /**
+     * Arguments for OnBatchItemsTransferred events, packed straight from a payload.
+     */
+    class ItemTransferEventArguments : public RE::BSScript::IFunctionArguments {
+
+    public:
+        virtual bool operator()(RE::BSScrapArray<RE::BSScript::Variable>& a_dst) const override {
+            a_dst.resize(4);
+            a_dst[0].Pack(payload->sourceContainer);
+            a_dst[1].Pack(payload->destContainer);
+            a_dst[2].Pack(payload->baseItems);
+            a_dst[3].Pack(payload->itemCounts);
+            PAPER_STATS_COUNT(kContainerChanged, variablesPacked, 4 + 2 * payload->baseItems.size());
+            return true;
+        }
+
+        /** The payload of the event currently being sent */
+        const Core::ItemEventPayload* payload = nullptr;
+    };
+
+    /**
+     * Arguments for OnGlobalItemMovement events, packed straight from a payload.
+     */
+    class GlobalItemMovementEventArguments : public RE::BSScript::IFunctionArguments {
+
+    public:
+        virtual bool operator()(RE::BSScrapArray<RE::BSScript::Variable>& a_dst) const override {
+            a_dst.resize(4);
+            a_dst[0].Pack(payload->containers);
+            a_dst[1].Pack(payload->otherContainers);
+            a_dst[2].Pack(payload->baseItems);
+            a_dst[3].Pack(payload->itemCounts);
+            PAPER_STATS_COUNT(kContainerChanged, variablesPacked, 4 + 4 * payload->baseItems.size());
+            return true;
+        }
+
+        /** The payload of the event currently being sent */
+        const Core::ItemEventPayload* payload = nullptr;
+    };
+
+    /**
+     * Filter that only lets batched inventory events through to scripts if at least one of the
+     * items matches their inventory event filters (if they have any), and if the event is meant
+     * for them (see the receivers of the payload). It references the base items and receivers of
+     * the event being sent, rather than holding a copy of them.
      */
-    struct ItemEvent {
-        ItemEvent(RE::FormID otherContainer, RE::FormID baseObj, std::int32_t itemCount)
-            : otherContainer(otherContainer), baseObj(baseObj), itemCount(itemCount) {}
-        ItemEvent() = delete;
-
-        RE::FormID otherContainer;
-        RE::FormID baseObj;
-        std::int32_t itemCount;
+    struct ItemEventsFilter : RE::SkyrimVM::ISendEventFilter {
+        ItemEventsFilter() = default;
+        explicit ItemEventsFilter(std::span<RE::TESForm* const> baseItems) : baseItems(baseItems){};
+
+        std::span<RE::TESForm* const> baseItems;
+        std::span<const Core::VMHandle> receivers;
+        std::span<const Core::VMHandle> excludedReceivers;
+
+        virtual bool matchesFilter(RE::VMHandle handle) override;
+    };
+
+    /**
+     * Sends the batched inventory events of the item event batcher to the VM.
+     */
+    class SkyrimItemEventSender : public Core::IEventSender {
+
+    public:
+        virtual bool IsReady() const override;
+        virtual void SendItemEvent(Core::ItemEventKind kind, Core::VMHandle handle,
+                                   const Core::ItemEventPayload& payload) override;
+        virtual void SendItemCountEvent(Core::VMHandle handle, RE::TESForm* baseItem, std::int32_t threshold,
+                                        std::int32_t itemCount) override;
+
+    private:
+        /** Arguments for item-added / item-removed events */
+        ItemEventArguments itemEventArguments;
+        /** Arguments for item-transferred events */
+        ItemTransferEventArguments itemTransferEventArguments;
+        /** Arguments for global item movement events */
+        GlobalItemMovementEventArguments globalItemMovementEventArguments;
+        /** Filter for the batched inventory event that is currently being sent */
+        ItemEventsFilter itemEventsFilter;
     };
 
     /**
@@ -55,10 +147,15 @@ namespace OnContainerChangedEvents {
         static void OnGameSaved(SKSE::SerializationInterface* serde);
 
         /**
-         * The serialization handler for loading data from a cosave.
+         * Reads the cosave record of the given type, if it is one of ours. Returns false
+         * if the record belongs to someone else.
          */
-        static void OnGameLoaded(SKSE::SerializationInterface* serde);
+        static bool OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type);
 
+        /**
+         * Called once all the records of a cosave have been read.
+         */
+        static void OnGameLoaded();
 
         /**
          * Does an item with the given form ID pass the given inventory event filter lists?
@@ -66,21 +163,56 @@ namespace OnContainerChangedEvents {
         static bool ItemPassesInventoryFilterLists(const RE::FormID itemID,
                                                    const RE::SkyrimVM::InventoryEventFilterLists* filterLists);
 
-        void SendItemAddedEvents();
-        void SendItemRemovedEvents();
-
-        /** Map of batched item-added events, to be processed */
-        std::unordered_map<RE::FormID, std::vector<ItemEvent>> batchedItemAddedEventsMap;
-        /** Map of batched item-removed events, to be processed */
-        std::unordered_map<RE::FormID, std::vector<ItemEvent>> batchedItemRemovedEventsMap;
-        /** Mutex for access to map with item-added events to be processed */
-        std::mutex batchedItemAddedEventsMapMutex;
-        /** Mutex for access to map with item-removed events to be processed */
-        std::mutex batchedItemRemovedEventsMapMutex;
-        /** Did we already queue up a task to process item-added events? */
-        bool haveQueuedUpTaskAddedEvents = false;
-        /** Did we already queue up a task to process item-removed events? */
-        bool haveQueuedUpTaskRemovedEvents = false;
+        /**
+         * Registers the object with the given handle (the container itself, or one of its aliases) for
+         * OnBatchItemsTransferred events of the given container. Moves between this container and another
+         * container will no longer be sent to the scripts attached to that object as OnBatchItemsAdded /
+         * OnBatchItemsRemoved events.
+         */
+        void RegisterForItemsTransferred(RE::FormID container, RE::VMHandle receiver);
+
+        /**
+         * Unregisters the object with the given handle from OnBatchItemsTransferred events of the given container.
+         */
+        void UnregisterForItemsTransferred(RE::FormID container, RE::VMHandle receiver);
+
+        /**
+         * Makes the inventory events of the given container go before those of ordinary containers.
+         */
+        void RegisterHighPriority(RE::FormID container);
+
+        /**
+         * Makes the given container an ordinary container again for the order of inventory events.
+         */
+        void UnregisterHighPriority(RE::FormID container);
+
+        /**
+         * Gives the given container its own batching window in milliseconds for its inventory events, or
+         * makes it use the global window again if the number of milliseconds is negative.
+         */
+        void SetBatchWindow(RE::FormID container, std::int32_t milliseconds);
+
+        /**
+         * Registers the given form for OnGlobalItemMovement events, with the changes of all inventories
+         * whose items pass the given filter (all items if the filter is empty).
+         */
+        void RegisterForGlobalItemMovement(RE::FormID receiver, Core::GlobalItemMovementFilter filter);
+
+        /**
+         * Unregisters the given form from OnGlobalItemMovement events.
+         */
+        void UnregisterForGlobalItemMovement(RE::FormID receiver);
+
+        /**
+         * Watches the count of the given item in the given container, for OnItemCountThresholdCrossed
+         * events whenever it crosses the given threshold.
+         */
+        void WatchItemCount(RE::FormID container, RE::FormID item, std::int32_t threshold);
+
+        /**
+         * Stops watching the count of the given item in the given container for the given threshold.
+         */
+        void UnwatchItemCount(RE::FormID container, RE::FormID item, std::int32_t threshold);
 
     private:
         OnContainerChangedEventHandler() = default;
@@ -91,48 +223,16 @@ namespace OnContainerChangedEvents {
         OnContainerChangedEventHandler& operator=(const OnContainerChangedEventHandler&) = delete;
         OnContainerChangedEventHandler& operator=(OnContainerChangedEventHandler&&) = delete;
 
-    };
+        EngineAdapters::SkyrimFormLookup forms;
+        EngineAdapters::SkyrimInventoryLookup inventory;
+        EngineAdapters::SkyrimHandlePolicy handles;
+        SkyrimItemEventSender sender;
+        EngineAdapters::SkyrimTaskQueue tasks;
 
-    struct ItemEventsFilter : RE::SkyrimVM::ISendEventFilter {
-        ItemEventsFilter(const std::vector<RE::TESForm*> baseItems) : baseItems(baseItems){};
-        ItemEventsFilter() = delete;
-
-        const std::vector<RE::TESForm*> baseItems;
-
-        virtual bool matchesFilter(RE::VMHandle handle) override {
-            auto vm = RE::SkyrimVM::GetSingleton();
-
-            //const auto& constInventoryEventFilterMapLock =
-            //    GetManualRelocateMemberVariable<RE::BSSpinLock>(vm, REL::VariantOffset(0x8940, 0x8940, 0x8960));
-
-            //auto& inventoryEventFilterMapLock = const_cast<RE::BSSpinLock&>(constInventoryEventFilterMapLock);
-            //RE::BSSpinLockGuard locker(inventoryEventFilterMapLock);
-
-            const auto& inventoryEventFilterMap =
-                GetManualRelocateMemberVariable<RE::BSTHashMap<RE::VMHandle, RE::SkyrimVM::InventoryEventFilterLists*>>(
-                    vm, REL::VariantOffset(0x8948, 0x8948, 0x8968));
-
-            RE::SkyrimVM::InventoryEventFilterLists* filterLists = nullptr;
-            auto it = inventoryEventFilterMap.find(handle);
-            if (it != inventoryEventFilterMap.end()) {
-                filterLists = it->second;
-            }
-
-            if (filterLists) {
-                // Have filters, so need at least one of our items to match
-                for (auto baseObj : baseItems) {
-                    if (OnContainerChangedEventHandler::ItemPassesInventoryFilterLists(baseObj->formID, filterLists)) {
-                        return true;
-                    }
-                }
-            } else {
-                // No filters, so anything matches
-                return true;
-            }
-
-            // Have filters but none matched, so return false
-            return false;
-        }
+        /** Engine-independent batching of the events */
+        Core::ItemEventBatcher batcher{{forms, handles, sender, tasks}};
+        /** Engine-independent running counts for item count threshold events */
+        Core::ItemCountWatcher itemCountWatcher{{forms, inventory, handles, sender, tasks}};
     };
 #pragma warning(pop)
 }  // namespace OnContainerChangedEvents
@@ -2,37 +2,127 @@
 
 #include <RE/Skyrim.h>
 
+#include <EquipStateTracker.h>
+#include <EventBridge.h>
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
 namespace OnEquipEvents {
-#pragma warning(push)
-#pragma warning(disable : 4251)
 
     /**
-     * Our singleton event handler for new variants of OnEquip events.
+     * Definition of our new variants of OnEquip events: OnSpellEquipped / OnSpellUnequipped and
+     * OnShoutEquipped / OnShoutUnequipped, sent to the actor that (un)equipped the spell or shout.
      */
-    class __declspec(dllexport) OnEquipEventHandler : public RE::BSTEventSink<RE::TESEquipEvent> {
+    struct EquipEventDefinition {
+        using Event = RE::TESEquipEvent;
+        static constexpr PerfStats::Handler StatsHandler = PerfStats::Handler::kEquip;
+        static constexpr const char* ProfileName = "Equip.ProcessEvent";
 
-    public:
+        static bool IsEnabled(const Core::Settings& settings) { return settings.equipEvents.enabled; }
+
+        static void Record(Recording::EventRecorder& recorder, const Event& event) {
+            const auto actor = event.actor.get();
+            recorder.RecordEquip(actor ? actor->formID : 0, event.baseObject, event.equipped);
+        }
+
+        template <class Emit>
+        void Project(const Event& event, Emit&& emit);
+
+        /**
+         * Invalidates what we know about the magic equipped by the actor of the event.
+         */
+        void Observe(const Event& event);
+
+        /**
+         * The spells (one per slot, as in Actor.GetEquippedSpell) and the shout that an actor has equipped.
+         */
+        struct EquippedMagic {
+            std::array<RE::FormID, 4> spells{};
+            RE::FormID shout = 0;
+        };
 
-       /**
-        * Overridden from RE::BSTEventSink. Lets us process events received from the game engine.
-        */
-        virtual RE::BSEventNotifyControl ProcessEvent(const RE::TESEquipEvent* a_event,
-                                                      RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource);
+        /**
+         * Returns the magic that the given actor has equipped. Read from the actor the first time
+         * it is asked for (and after every equip event of the actor), and from the table after that.
+         */
+        EquippedMagic GetEquippedMagic(RE::Actor* actor);
 
         /**
-         * Get the singleton instance of the <code>OnEquipEventHandler</code>.
+         * Forgets about the equipped magic of all actors.
          */
-        [[nodiscard]] static OnEquipEventHandler& GetSingleton() noexcept;
+        void ClearEquippedMagic();
+
+        /** Last known equipped spells and shouts, for suppressing the re-equips while loading */
+        Core::EquipStateTracker equipStates;
 
     private:
-        OnEquipEventHandler() = default;
-        OnEquipEventHandler(const OnEquipEventHandler&) = delete;
-        OnEquipEventHandler(OnEquipEventHandler&&) = delete;
-        ~OnEquipEventHandler() = default;
+        /** Equipped magic per actor, for the actors that were asked about since their last equip event */
+        std::unordered_map<RE::FormID, EquippedMagic> equippedMagic;
+        /** Mutex for access to the equipped magic */
+        std::mutex equippedMagicMutex;
+    };
+
+    /**
+     * Our singleton event handler for new variants of OnEquip events.
+     */
+    using OnEquipEventHandler = EventBridges::EventBridge<EquipEventDefinition>;
 
-        OnEquipEventHandler& operator=(const OnEquipEventHandler&) = delete;
-        OnEquipEventHandler& operator=(OnEquipEventHandler&&) = delete;
+    /**
+     * Our singleton event handler for cell attach events, which open suppression windows for the
+     * re-equips of the actors in the attached cells, and forget the states of non-persistent actors in
+     * detached cells.
+     */
+    class __declspec(dllexport) CellAttachEventHandler : public RE::BSTEventSink<RE::TESCellAttachDetachEvent> {
 
+    public:
+        /**
+         * Overridden from RE::BSTEventSink. Lets us process events received from the game engine.
+         */
+        virtual RE::BSEventNotifyControl ProcessEvent(const RE::TESCellAttachDetachEvent* a_event,
+                                                      RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) override;
+
+        /**
+         * Get the singleton instance of the <code>CellAttachEventHandler</code>.
+         */
+        [[nodiscard]] static CellAttachEventHandler& GetSingleton() noexcept;
+
+    private:
+        CellAttachEventHandler() = default;
+        CellAttachEventHandler(const CellAttachEventHandler&) = delete;
+        CellAttachEventHandler(CellAttachEventHandler&&) = delete;
+        ~CellAttachEventHandler() = default;
+
+        CellAttachEventHandler& operator=(const CellAttachEventHandler&) = delete;
+        CellAttachEventHandler& operator=(CellAttachEventHandler&&) = delete;
     };
-#pragma warning(pop)
+
+    /**
+     * Opens the suppression window for the re-equips of all actors (SKSE kPreLoadGame message).
+     */
+    void OnPreLoadGame();
+
+    /**
+     * Lets the suppression window for all actors close a few frames from now (SKSE kPostLoadGame message).
+     */
+    void OnPostLoadGame();
+
+    /**
+     * The serialization handler for reverting game state.
+     */
+    void OnRevert(SKSE::SerializationInterface*);
+
+    /**
+     * The serialization handler for saving data to the cosave.
+     */
+    void OnGameSaved(SKSE::SerializationInterface* serde);
+
+    /**
+     * Reads the cosave record of the given type, if it is one of ours. Returns false if the record
+     * belongs to someone else.
+     */
+    bool OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type);
 }  // namespace OnEquipEvents
+
+extern template class EventBridges::EventBridge<OnEquipEvents::EquipEventDefinition>;
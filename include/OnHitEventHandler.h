@@ -2,58 +2,54 @@
 
 #include <RE/Skyrim.h>
 
-namespace OnHitEvents {
-#pragma warning(push)
-#pragma warning(disable : 4251)
-
-    /** 
-     * Data about recently-processed OnHit events, so we can avoid 
-     * spamming multiple events for a single hit in a short timespan.
-     */
-    struct RecentHitEventData {
-
-        RecentHitEventData(RE::TESObjectREFR* target, RE::TESObjectREFR* cause,
-                           float applicationRuntime)
-            : target(target), cause(cause), applicationRuntime(applicationRuntime) {}
-
-        /** The target that was hit */
-        RE::TESObjectREFR* target;
-        /** The cause / aggressor of the hit */
-        RE::TESObjectREFR* cause;
-        /** Runtime of the Skyrim application at the time the event was received */
-        float applicationRuntime;
+#include <EventBridge.h>
+#include <HitEventDeduplicator.h>
+#include <HitTelemetry.h>
 
-    };
+namespace OnHitEvents {
 
     /**
-     * Our singleton event handler for new variants of OnHit events.
+     * Definition of our new variants of OnHit events: OnImpact, sent to actors that are hit by
+     * something that physically impacts them (rather than, e.g., an enchantment or a concentration spell).
      */
-    class __declspec(dllexport) OnHitEventHandler : public RE::BSTEventSink<RE::TESHitEvent> {
+    struct HitEventDefinition {
+        using Event = RE::TESHitEvent;
+        static constexpr PerfStats::Handler StatsHandler = PerfStats::Handler::kHit;
+        static constexpr const char* ProfileName = "Hit.ProcessEvent";
+
+        static bool IsEnabled(const Core::Settings& settings) { return settings.hitEvents.enabled; }
 
-    public:
+        static void Record(Recording::EventRecorder& recorder, const Event& event) {
+            const auto target = event.target.get();
+            const auto cause = event.cause.get();
+            recorder.RecordHit(target ? target->formID : 0, cause ? cause->formID : 0, event.source, event.projectile,
+                               event.flags.underlying());
+        }
 
-       /**
-        * Overridden from RE::BSTEventSink. Lets us process events received from the game engine.
-        */
-        virtual RE::BSEventNotifyControl ProcessEvent(const RE::TESHitEvent* a_event,
-                                                      RE::BSTEventSource<RE::TESHitEvent>* a_eventSource);
+        template <class Emit>
+        void Project(const Event& event, Emit&& emit);
 
         /**
-         * Get the singleton instance of the <code>OnHitEventHandler</code>.
+         * Records every hit on an actor in the hit telemetry, also while OnImpact events are disabled.
          */
-        [[nodiscard]] static OnHitEventHandler& GetSingleton() noexcept;
+        void Observe(const Event& event);
 
-    private:
-        OnHitEventHandler() = default;
-        OnHitEventHandler(const OnHitEventHandler&) = delete;
-        OnHitEventHandler(OnHitEventHandler&&) = delete;
-        ~OnHitEventHandler() = default;
+        /** Keeps track of recently-processed hit events, to skip duplicates. */
+        Core::HitEventDeduplicator hitDeduplicator;
 
-        OnHitEventHandler& operator=(const OnHitEventHandler&) = delete;
-        OnHitEventHandler& operator=(OnHitEventHandler&&) = delete;
-
-        /** Keep track of recently-processed hit events here. */
-        std::vector<RecentHitEventData> recentHits;
+        /** Recent hits per (aggressor, target) pair, for the hit telemetry natives. */
+        Core::HitTelemetry hitTelemetry;
     };
-#pragma warning(pop)
+
+    /**
+     * Our singleton event handler for new variants of OnHit events.
+     */
+    using OnHitEventHandler = EventBridges::EventBridge<HitEventDefinition>;
+
+    /**
+     * The serialization handler for reverting game state.
+     */
+    void OnRevert(SKSE::SerializationInterface*);
 }  // namespace OnHitEvents
+
+extern template class EventBridges::EventBridge<OnHitEvents::HitEventDefinition>;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <EventBridge.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace OnMagicEffectApplyEvents {
+
+    /**
+     * Definition of our batched variant of OnMagicEffectApply events: OnBatchMagicEffectsApplied, sent
+     * once per frame to every reference that magic effects were applied to, with all of those effects
+     * and their casters.
+     */
+    struct MagicEffectApplyEventDefinition {
+        using Event = RE::TESMagicEffectApplyEvent;
+        static constexpr PerfStats::Handler StatsHandler = PerfStats::Handler::kMagicEffectApply;
+        static constexpr const char* ProfileName = "MagicEffectApply.ProcessEvent";
+
+        static bool IsEnabled(const Core::Settings& settings) { return settings.magicEffectEvents.enabled; }
+
+        template <class Emit>
+        void Project(const Event& event, Emit&& emit);
+
+        /**
+         * Adds a filter to the given target: once it has any, only magic effects that are one of its
+         * filters (or are in one of its filters, for form lists) are batched up for it.
+         */
+        void AddFilter(RE::FormID target, RE::FormID filter);
+
+        /**
+         * Removes all filters of the given target.
+         */
+        void RemoveAllFilters(RE::FormID target);
+
+        void ClearFilters();
+        void SaveFilters(SKSE::SerializationInterface* serde, std::uint32_t type);
+        void LoadFilters(SKSE::SerializationInterface* serde);
+
+    private:
+        /**
+         * Does the given magic effect pass the filters of the given target (if it has any)?
+         */
+        bool PassesFilters(RE::FormID target, RE::FormID magicEffect);
+
+        /** Magic effects and form lists that targets filter on */
+        std::unordered_map<RE::FormID, std::vector<RE::FormID>> filters;
+        /** Mutex for access to the filters */
+        std::mutex filtersMutex;
+    };
+
+    /**
+     * Our singleton event handler for OnBatchMagicEffectsApplied events.
+     */
+    using OnMagicEffectApplyEventHandler = EventBridges::EventBridge<
+        MagicEffectApplyEventDefinition,
+        EventBridges::BatchedPolicy<PerfStats::Handler::kMagicEffectApply, RE::EffectSetting*, RE::TESObjectREFR*>>;
+
+    /**
+     * The serialization handler for reverting game state.
+     */
+    void OnRevert(SKSE::SerializationInterface*);
+
+    /**
+     * The serialization handler for saving data to the cosave.
+     */
+    void OnGameSaved(SKSE::SerializationInterface* serde);
+
+    /**
+     * Reads the cosave record of the given type and length, if it is one of ours. Returns false if the
+     * record belongs to someone else.
+     */
+    bool OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type, std::uint32_t length);
+}  // namespace OnMagicEffectApplyEvents
+
+extern template class EventBridges::EventBridge<
+    OnMagicEffectApplyEvents::MagicEffectApplyEventDefinition,
+    EventBridges::BatchedPolicy<PerfStats::Handler::kMagicEffectApply, RE::EffectSetting*, RE::TESObjectREFR*>>;
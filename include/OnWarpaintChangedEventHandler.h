@@ -0,0 +1,169 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <EngineAdapters.h>
+#include <WarpaintTracker.h>
+
+#include <mutex>
+#include <unordered_set>
+
+namespace OnWarpaintChangedEvents {
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+    /**
+     * Calls the given function with every visible tint layer of the given actor base that we are able to
+     * detect as warpaint: layers whose tint asset in the race's face data is of the paint (or no) type.
+     */
+    template <class Visit>
+    void ForEachWarpaintLayer(RE::TESNPC* actorBase, Visit&& visit) {
+        while (actorBase->tintLayers == nullptr && actorBase->faceNPC != nullptr && actorBase->faceNPC != actorBase) {
+            actorBase = actorBase->faceNPC;
+        }
+
+        const auto race = actorBase->race;
+        if (!race || !actorBase->tintLayers) {
+            return;
+        }
+
+        const auto faceRelatedData = race->faceRelatedData[actorBase->GetSex()];
+        if (!faceRelatedData || !faceRelatedData->tintMasks) {
+            return;
+        }
+
+        for (const auto layer : *actorBase->tintLayers) {
+            // Need interpolation value > 0.0 for the layer to be visible
+            if (!layer || layer->GetInterpolationValue() <= 0.f) {
+                continue;
+            }
+
+            // Figure out from tint assets defined in Race's face data whether
+            // or not this actually could be a paint tint
+            for (const auto tintAsset : *faceRelatedData->tintMasks) {
+                if (!tintAsset || tintAsset->texture.index != layer->tintIndex) {
+                    continue;
+                }
+
+                const auto tintLayerType = tintAsset->texture.skinTone.get();
+                if (tintLayerType == RE::TESRace::FaceRelatedData::TintAsset::TintLayer::SkinTone::kNone ||
+                    tintLayerType == RE::TESRace::FaceRelatedData::TintAsset::TintLayer::SkinTone::kPaint) {
+                    // I've found some things that very much look like warpaint with type None
+                    // in the Creation Kit (e.g., Forsworn stuff in the Breton race), so we'll
+                    // also allow that type.
+                    visit(*layer);
+                }
+
+                break;
+            }
+        }
+    }
+
+    /**
+     * Returns the hash of the warpaint of the given actor base.
+     */
+    std::uint64_t HashWarpaint(RE::TESNPC* actorBase);
+
+    /**
+     * Our singleton event handler for OnWarpaintChanged events, sent to registered forms when the warpaint
+     * of an actor base that they registered for changed. Warpaint is only re-hashed at the points where
+     * the game changes appearances: when an actor switched race, when the RaceSex menu closes, and when the
+     * 3D of an actor is (re)built, which scripts trigger with QueueNiNodeUpdate after changing tint masks.
+     * Changes that never rebuild the 3D (e.g., SKSE's UpdateTintMaskColors or RegenerateHead alone) are only
+     * detected once scripts ask for a re-check with the RecheckWarpaint native.
+     */
+    class __declspec(dllexport) OnWarpaintChangedEventHandler : public RE::BSTEventSink<RE::TESSwitchRaceCompleteEvent>,
+                                                               public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+
+    public:
+        /**
+         * Overridden from RE::BSTEventSink. Re-checks the actor that switched race.
+         */
+        virtual RE::BSEventNotifyControl ProcessEvent(
+            const RE::TESSwitchRaceCompleteEvent* a_event,
+            RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>* a_eventSource) override;
+
+        /**
+         * Overridden from RE::BSTEventSink. Re-checks all tracked actor bases when the RaceSex menu closes.
+         */
+        virtual RE::BSEventNotifyControl ProcessEvent(
+            const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_eventSource) override;
+
+        /**
+         * Get the singleton instance of the <code>OnWarpaintChangedEventHandler</code>.
+         */
+        [[nodiscard]] static OnWarpaintChangedEventHandler& GetSingleton() noexcept;
+
+        /**
+         * Hooks the rebuilding of the 3D of actors, to re-check the warpaint of tracked actor bases.
+         */
+        static void InstallHooks();
+
+        /**
+         * Registers the given form for OnWarpaintChanged events of the given actor base.
+         */
+        void Register(RE::TESForm* receiver, RE::TESNPC* actorBase);
+
+        /**
+         * Unregisters the given form from OnWarpaintChanged events of the given actor base.
+         */
+        void Unregister(RE::TESForm* receiver, RE::TESNPC* actorBase);
+
+        /**
+         * Re-checks the warpaint of the given actor base at the end of the frame, if any forms registered
+         * for it.
+         */
+        void Recheck(RE::TESNPC* actorBase);
+
+        /**
+         * The serialization handler for reverting game state.
+         */
+        static void OnRevert(SKSE::SerializationInterface*);
+
+        /**
+         * The serialization handler for saving data to the cosave.
+         */
+        static void OnGameSaved(SKSE::SerializationInterface* serde);
+
+        /**
+         * Reads the cosave record of the given type, if it is one of ours. Returns false
+         * if the record belongs to someone else.
+         */
+        static bool OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type);
+
+    private:
+        OnWarpaintChangedEventHandler() = default;
+        OnWarpaintChangedEventHandler(const OnWarpaintChangedEventHandler&) = delete;
+        OnWarpaintChangedEventHandler(OnWarpaintChangedEventHandler&&) = delete;
+        ~OnWarpaintChangedEventHandler() = default;
+
+        OnWarpaintChangedEventHandler& operator=(const OnWarpaintChangedEventHandler&) = delete;
+        OnWarpaintChangedEventHandler& operator=(OnWarpaintChangedEventHandler&&) = delete;
+
+        /**
+         * Queues up re-checking the warpaint of the given actor base at the end of the frame, once the game
+         * has finished updating its appearance.
+         */
+        void QueueRecheck(RE::FormID actorBase);
+
+        /**
+         * Re-hashes the warpaint of the actor bases queued up for it, and sends OnWarpaintChanged events
+         * for the ones that changed.
+         */
+        void RecheckWarpaint();
+
+        EngineAdapters::SkyrimHandlePolicy handles;
+        EngineAdapters::SkyrimTaskQueue tasks;
+
+        /** Engine-independent registrations and hashes */
+        Core::WarpaintTracker tracker;
+
+        /** Actor bases to re-check in the queued-up task */
+        std::unordered_set<RE::FormID> pendingRechecks;
+        /** Mutex for access to the pending re-checks */
+        std::mutex pendingRechecksMutex;
+        /** Did we already queue up a task to re-check warpaint? */
+        bool haveQueuedUpTask = false;
+    };
+#pragma warning(pop)
+}  // namespace OnWarpaintChangedEvents
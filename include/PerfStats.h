@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Compile-time switch for the performance counters and latency histograms. When it is 0, the
+ * PAPER_STATS_* macros compile to nothing. When it is 1, they only cost a relaxed atomic load
+ * while the stats are disabled at runtime.
+ */
+#ifndef PAPER_ENABLE_STATS
+#define PAPER_ENABLE_STATS 1
+#endif
+
+namespace PerfStats {
+
+    /**
+     * The event sinks that we keep counters for.
+     */
+    enum class Handler : std::uint8_t { kContainerChanged, kEquip, kHit, kMagicEffectApply, kTotal };
+
+    /**
+     * Counters of a single event sink. Each sink gets its own cache line, so that sinks
+     * running on different threads do not contend on the counters.
+     */
+    struct alignas(64) HandlerCounters {
+        /** Events received from the engine */
+        std::atomic<std::uint64_t> eventsSeen = 0;
+        /** Events sent to the VM */
+        std::atomic<std::uint64_t> eventsDispatched = 0;
+        /** Events (or scripts) that we did not send events to, because they were filtered out */
+        std::atomic<std::uint64_t> eventsFiltered = 0;
+        /** Papyrus variables that we packed arguments into: one per argument, plus one per array element */
+        std::atomic<std::uint64_t> variablesPacked = 0;
+    };
+
+    /**
+     * Lock-free histogram of latencies in nanoseconds, with log-linear buckets (as in HdrHistogram):
+     * every power of two is split into SubBucketCount linear sub-buckets, so every recorded value is
+     * off by at most 1 / SubBucketCount of its magnitude.
+     */
+    class LatencyHistogram {
+
+    public:
+        static constexpr unsigned SubBucketBits = 4;
+        static constexpr std::uint64_t SubBucketCount = 1 << SubBucketBits;
+        static constexpr std::size_t NumBuckets = (64 - SubBucketBits + 1) * SubBucketCount;
+
+        void Record(std::uint64_t nanoseconds);
+
+        [[nodiscard]] std::uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint64_t Max() const { return max.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint64_t Mean() const;
+
+        /**
+         * Returns (an upper bound of) the latency below which the given fraction of the recorded latencies lie.
+         */
+        [[nodiscard]] std::uint64_t Percentile(double fraction) const;
+
+        void Reset();
+
+    private:
+        static std::size_t BucketIndex(std::uint64_t nanoseconds);
+        static std::uint64_t BucketUpperBound(std::size_t index);
+
+        std::array<std::atomic<std::uint64_t>, NumBuckets> buckets{};
+        std::atomic<std::uint64_t> count = 0;
+        std::atomic<std::uint64_t> totalNanoseconds = 0;
+        std::atomic<std::uint64_t> max = 0;
+    };
+
+    /**
+     * Singleton holding all the counters and histograms.
+     */
+    class PerfStatsRegistry {
+
+    public:
+        [[nodiscard]] static PerfStatsRegistry& GetSingleton() noexcept;
+
+        [[nodiscard]] bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+        void SetEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+
+        [[nodiscard]] HandlerCounters& Counters(Handler handler) {
+            return counters[static_cast<std::size_t>(handler)];
+        }
+
+        /**
+         * Returns the histogram with the given name, creating it the first time. The returned
+         * reference stays valid for the lifetime of the registry, so call sites cache it.
+         */
+        LatencyHistogram& Histogram(std::string_view name);
+
+        /**
+         * Returns one human-readable line per handler and per histogram that recorded anything.
+         */
+        [[nodiscard]] std::vector<std::string> Report() const;
+
+        /**
+         * Resets all the counters and histograms.
+         */
+        void Reset();
+
+        /**
+         * Sets how often the stats are written to the log (0 to never write them).
+         */
+        void SetDumpInterval(std::chrono::seconds interval);
+
+        /**
+         * Writes the stats to the log if the dump interval has passed since the last time.
+         */
+        void MaybeDumpToLog(std::chrono::steady_clock::time_point now);
+
+    private:
+        PerfStatsRegistry() = default;
+        PerfStatsRegistry(const PerfStatsRegistry&) = delete;
+        PerfStatsRegistry(PerfStatsRegistry&&) = delete;
+        ~PerfStatsRegistry() = default;
+
+        PerfStatsRegistry& operator=(const PerfStatsRegistry&) = delete;
+        PerfStatsRegistry& operator=(PerfStatsRegistry&&) = delete;
+
+        struct NamedHistogram {
+            explicit NamedHistogram(std::string_view name) : name(name) {}
+
+            std::string name;
+            LatencyHistogram histogram;
+        };
+
+        std::atomic<bool> enabled = false;
+
+        std::array<HandlerCounters, static_cast<std::size_t>(Handler::kTotal)> counters;
+
+        /** Deque, so that references to histograms stay valid when more are registered */
+        std::deque<NamedHistogram> histograms;
+        /** Only needed for registering and iterating over histograms, not for recording into them */
+        mutable std::mutex histogramsMutex;
+
+        std::atomic<std::int64_t> dumpIntervalNanoseconds = std::chrono::nanoseconds(std::chrono::seconds(60)).count();
+        std::atomic<std::int64_t> nextDumpNanoseconds = 0;
+    };
+
+    /**
+     * Adds the given amount to one of the counters of the given handler, if stats are enabled.
+     */
+    inline void AddCount(Handler handler, std::atomic<std::uint64_t> HandlerCounters::*counter,
+                         std::uint64_t amount = 1) {
+        auto& registry = PerfStatsRegistry::GetSingleton();
+        if (registry.IsEnabled()) {
+            (registry.Counters(handler).*counter).fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Records the given latency in the given histogram, if stats are enabled.
+     */
+    inline void RecordLatency(LatencyHistogram& histogram, std::chrono::nanoseconds latency) {
+        if (PerfStatsRegistry::GetSingleton().IsEnabled()) {
+            histogram.Record(static_cast<std::uint64_t>(latency.count()));
+        }
+    }
+
+    /**
+     * Records the time between its construction and destruction in a histogram, if stats
+     * were enabled at the time of construction.
+     */
+    class ScopedTimer {
+
+    public:
+        explicit ScopedTimer(LatencyHistogram& histogram)
+            : histogram(PerfStatsRegistry::GetSingleton().IsEnabled() ? &histogram : nullptr) {
+            if (this->histogram) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ScopedTimer() {
+            if (histogram) {
+                const auto end = std::chrono::steady_clock::now();
+                histogram->Record(
+                    static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+                PerfStatsRegistry::GetSingleton().MaybeDumpToLog(end);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        LatencyHistogram* histogram;
+        std::chrono::steady_clock::time_point start;
+    };
+}  // namespace PerfStats
+
+#define PAPER_STATS_CONCAT_IMPL(a, b) a##b
+#define PAPER_STATS_CONCAT(a, b) PAPER_STATS_CONCAT_IMPL(a, b)
+
+#if PAPER_ENABLE_STATS
+/**
+ * Records the latency of the rest of the enclosing scope in the histogram with the given name.
+ */
+#define PAPER_STATS_TIME_SCOPE(name)                                                     \
+    static auto& PAPER_STATS_CONCAT(paperStatsHistogram, __LINE__) =                     \
+        ::PerfStats::PerfStatsRegistry::GetSingleton().Histogram(name);                  \
+    ::PerfStats::ScopedTimer PAPER_STATS_CONCAT(paperStatsTimer, __LINE__)(              \
+        PAPER_STATS_CONCAT(paperStatsHistogram, __LINE__))
+
+/**
+ * Adds amount to the given counter (e.g., eventsSeen) of the given handler (e.g., kHit).
+ */
+#define PAPER_STATS_COUNT(handler, counter, amount) \
+    ::PerfStats::AddCount(::PerfStats::Handler::handler, &::PerfStats::HandlerCounters::counter, amount)
+
+/**
+ * Records a latency (a std::chrono duration) that was measured elsewhere in the given histogram.
+ */
+#define PAPER_STATS_RECORD_LATENCY(histogram, latency) \
+    ::PerfStats::RecordLatency(histogram, std::chrono::duration_cast<std::chrono::nanoseconds>(latency))
+#else
+#define PAPER_STATS_TIME_SCOPE(name) ((void)0)
+#define PAPER_STATS_COUNT(handler, counter, amount) ((void)0)
+#define PAPER_STATS_RECORD_LATENCY(histogram, latency) ((void)0)
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <PerfStats.h>
+#include <TraceRecorder.h>
+
+/**
+ * Records the rest of the enclosing scope both in the latency histogram with the given name, and
+ * as a trace span with the given name and category. Both must be string literals.
+ */
+#define PAPER_PROFILE_SCOPE(name, category) \
+    PAPER_STATS_TIME_SCOPE(name);           \
+    PAPER_TRACE_SCOPE(name, category)
@@ -2,6 +2,8 @@
 
 #include <RE/Skyrim.h>
 
+#include <AssetValidation.h>
+
 namespace ResourceUtils {
 #pragma warning(push)
 #pragma warning(disable : 4251)
@@ -15,4 +17,59 @@ namespace ResourceUtils {
     }
 
 #pragma warning(pop)
+
+    /**
+     * Calls the given function with every texture path of the given texture set.
+     */
+    template <class Visit>
+    void ForEachTexturePath(const RE::BGSTextureSet* textureSet, Visit&& visit) {
+        for (const auto& texture : textureSet->textures) {
+            visit(std::string_view(texture.textureName.c_str()), Core::AssetKind::kTexture);
+        }
+    }
+
+    /**
+     * Calls the given function with the path of the given model, and with the texture paths of the
+     * alternate texture sets that the model swaps in.
+     */
+    template <class Visit>
+    void ForEachModelPath(const RE::TESModelTextureSwap& model, Visit&& visit) {
+        visit(std::string_view(model.GetModel()), Core::AssetKind::kModel);
+        for (std::uint32_t i = 0; i < model.numAlternateTextures; ++i) {
+            if (const auto textureSet = model.alternateTextures[i].textureSet) {
+                ForEachTexturePath(textureSet, visit);
+            }
+        }
+    }
+
+    /**
+     * Calls the given function with every asset path that the given form references: its model, its
+     * texture set (or the textures of a texture set form), and the world models of armors and the biped
+     * models of armor addons. Paths are passed as the form stores them, so they may be empty and usually
+     * lack the meshes\ or textures\ prefix.
+     */
+    template <class Visit>
+    void ForEachAssetPath(RE::TESForm* form, Visit&& visit) {
+        if (const auto textureSet = form->As<RE::BGSTextureSet>()) {
+            ForEachTexturePath(textureSet, visit);
+        }
+
+        if (const auto model = form->As<RE::TESModelTextureSwap>()) {
+            ForEachModelPath(*model, visit);
+        } else if (const auto plainModel = form->As<RE::TESModel>()) {
+            visit(std::string_view(plainModel->GetModel()), Core::AssetKind::kModel);
+        }
+
+        if (const auto biped = form->As<RE::TESBipedModelForm>()) {
+            for (const auto& worldModel : biped->worldModels) {
+                ForEachModelPath(worldModel, visit);
+            }
+        }
+
+        if (const auto armorAddon = form->As<RE::TESObjectARMA>()) {
+            for (const auto& bipedModel : armorAddon->bipedModels) {
+                ForEachModelPath(bipedModel, visit);
+            }
+        }
+    }
 }  // namespace ResourceUtils
\ No newline at end of file
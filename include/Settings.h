@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * All the tuning knobs of PAPER, as read from PAPER.yaml. The defaults match the behaviour
+     * of PAPER without a configuration file.
+     */
+    struct Settings {
+        struct InventoryEvents {
+            /** Send OnBatchItems* events at all? */
+            bool enabled = true;
+            /** Number of extra frames to keep collecting events before dispatching a batch */
+            std::uint32_t batchWindowFrames = 0;
+            /** Min age of the first event of a batch before dispatching it (0 = no minimum) */
+            std::uint32_t batchWindowMilliseconds = 0;
+            /** Number of pending events of a container that flushes its batch early, whatever its window (0 = never) */
+            std::uint32_t maxBatchSize = 0;
+            /** Max number of containers per frame, per kind of event; the rest wait a frame (0 = no limit) */
+            std::uint32_t maxContainersPerFrame = 0;
+            /** Max number of pending events per container; further events are dropped (0 = no limit) */
+            std::uint32_t maxEventsPerContainer = 0;
+            /** Number of events in a frame's batches from which their payloads are prepared in parallel (0 = never) */
+            std::uint32_t parallelPreparationThreshold = 512;
+        } inventoryEvents;
+
+        struct EquipEvents {
+            /** Send OnSpellEquipped / OnShoutEquipped (and unequipped) events at all? */
+            bool enabled = true;
+            /** Only send real changes for the re-equips of the game while loading a game or attaching a cell? */
+            bool suppressLoadStorms = true;
+            /** Number of frames after loading a game / attaching a cell during which re-equips are suppressed */
+            std::uint32_t loadSuppressionFrames = 30;
+            /** Send the real changes after a suppression window as one OnEquippedMagicChanged event per actor? */
+            bool summarizeLoadChanges = false;
+        } equipEvents;
+
+        struct HitEvents {
+            /** Send OnImpact events at all? */
+            bool enabled = true;
+            /** Skip hits with the same target and aggressor as an earlier hit in the same frame? */
+            bool deduplicateSameFrame = true;
+            /** Keep the recent hits of every (aggressor, target) pair, for the hit telemetry natives? */
+            bool telemetryEnabled = true;
+            /** Number of (aggressor, target) pairs that the hit telemetry keeps */
+            std::uint32_t telemetryPairs = 1024;
+        } hitEvents;
+
+        struct MagicEffectEvents {
+            /** Send OnBatchMagicEffectsApplied events at all? */
+            bool enabled = true;
+        } magicEffectEvents;
+
+        struct Instrumentation {
+            bool statsEnabled = false;
+            /** How often the stats are written to the log (0 to never write them) */
+            std::uint32_t statsDumpIntervalSeconds = 60;
+            bool tracingEnabled = false;
+            /** Frame time above which the recorded trace is written to a file (0 to never write it) */
+            float slowFrameThresholdMilliseconds = 0.0f;
+        } instrumentation;
+
+        /** Log levels per logging category name (e.g., "Cosave", "debug") */
+        std::vector<std::pair<std::string, std::string>> logLevels;
+    };
+
+    /**
+     * Holds the current settings as an immutable snapshot. Reading them is a single atomic load, so
+     * hot paths can do it for every event. Publishing new settings never frees older snapshots, because
+     * other threads may still be reading them; there are only ever as many as there were reloads.
+     */
+    class SettingsStore {
+
+    public:
+        [[nodiscard]] static SettingsStore& GetSingleton() noexcept;
+
+        [[nodiscard]] const Settings& Current() const { return *current.load(std::memory_order_acquire); }
+
+        /**
+         * Makes the given settings the current ones.
+         */
+        void Publish(Settings settings);
+
+    private:
+        SettingsStore();
+        SettingsStore(const SettingsStore&) = delete;
+        SettingsStore(SettingsStore&&) = delete;
+        ~SettingsStore() = default;
+
+        SettingsStore& operator=(const SettingsStore&) = delete;
+        SettingsStore& operator=(SettingsStore&&) = delete;
+
+        std::atomic<const Settings*> current;
+
+        /** Every snapshot that was ever published, oldest first */
+        std::vector<std::unique_ptr<const Settings>> snapshots;
+        /** Only needed for publishing, not for reading the current settings */
+        std::mutex publishMutex;
+    };
+
+    /**
+     * Shorthand for the current settings.
+     */
+    [[nodiscard]] inline const Settings& GetSettings() { return SettingsStore::GetSingleton().Current(); }
+}  // namespace Core
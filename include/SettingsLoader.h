@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Settings.h>
+
+namespace SettingsLoader {
+
+    /** Location of the configuration file, relative to the game's directory */
+    inline constexpr const char* SettingsPath = "Data/SKSE/Plugins/PAPER.yaml";
+
+    /**
+     * (Re)loads PAPER.yaml, publishes the new settings and applies the instrumentation switches.
+     * Settings missing from the file keep their defaults. If the file cannot be read or parsed,
+     * the current settings stay in place and false is returned.
+     */
+    bool Load();
+}  // namespace SettingsLoader
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Compile-time switch for the trace recorder. When it is 0, PAPER_TRACE_SCOPE compiles to nothing.
+ * When it is 1, spans only cost a relaxed atomic load while tracing is disabled at runtime.
+ */
+#ifndef PAPER_ENABLE_TRACING
+#define PAPER_ENABLE_TRACING 1
+#endif
+
+namespace Tracing {
+
+    /**
+     * A single completed span (or, if durationNanoseconds is negative, an instant event).
+     * Names and categories must be string literals, since only the pointers are stored.
+     */
+    struct TraceEvent {
+        const char* name;
+        const char* category;
+        std::int64_t startNanoseconds;
+        std::int64_t durationNanoseconds;
+    };
+
+    /**
+     * Fixed-size ring buffer of the most recent trace events of a single thread. Only its own
+     * thread writes to it; the lock is only ever contended while the buffer is being flushed.
+     */
+    class ThreadTraceBuffer {
+
+    public:
+        static constexpr std::size_t Capacity = 1 << 15;
+
+        ThreadTraceBuffer(std::uint32_t threadID) : threadID(threadID), events(Capacity) {}
+
+        void Push(const TraceEvent& event);
+
+        /**
+         * Appends the events in this buffer to the given vector, oldest first.
+         */
+        void CopyTo(std::vector<TraceEvent>& out) const;
+
+        void Clear();
+
+        const std::uint32_t threadID;
+        /** Optional name of the thread, shown in the trace viewer */
+        std::string threadName;
+
+    private:
+        mutable std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::uint64_t numWritten = 0;
+    };
+
+    /**
+     * Records scoped spans of plugin activity into per-thread ring buffers, and writes them
+     * as Chrome trace_event JSON (which can be opened in Perfetto or chrome://tracing).
+     */
+    class TraceRecorder {
+
+    public:
+        [[nodiscard]] static TraceRecorder& GetSingleton() noexcept;
+
+        [[nodiscard]] bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+        void SetEnabled(bool enable);
+
+        /**
+         * Sets the directory that trace files are written to.
+         */
+        void SetOutputDirectory(std::filesystem::path directory);
+
+        /**
+         * Sets the frame time above which the recorded events are flushed automatically
+         * (0 to never flush automatically).
+         */
+        void SetSlowFrameThreshold(std::chrono::microseconds threshold);
+
+        /**
+         * Records a completed span on the calling thread.
+         */
+        void RecordSpan(const char* name, const char* category, std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end);
+
+        /**
+         * Must be called by the game's main thread once per frame. Records the frame boundary, and
+         * flushes the recorded events if the frame that just ended was slower than the threshold.
+         */
+        void OnFrameBoundary();
+
+        /**
+         * Writes all the recorded events to a new trace file in the background, and returns its path
+         * (or an empty path if there was nothing to write).
+         */
+        std::filesystem::path Flush(const char* reason);
+
+        [[nodiscard]] std::int64_t ToTraceTime(std::chrono::steady_clock::time_point time) const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
+        }
+
+    private:
+        TraceRecorder() = default;
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder(TraceRecorder&&) = delete;
+        ~TraceRecorder() = default;
+
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(TraceRecorder&&) = delete;
+
+        /**
+         * Returns the trace buffer of the calling thread, creating it the first time.
+         */
+        ThreadTraceBuffer& GetThreadBuffer();
+
+        std::atomic<bool> enabled = false;
+
+        const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        /** Buffers of all the threads that ever recorded something. Never shrinks, as threads hold on to them. */
+        std::vector<std::unique_ptr<ThreadTraceBuffer>> threadBuffers;
+        /** Only needed for registering and iterating over thread buffers */
+        mutable std::mutex threadBuffersMutex;
+
+        std::filesystem::path outputDirectory;
+        std::atomic<std::uint32_t> numFlushes = 0;
+
+        std::atomic<std::int64_t> slowFrameThresholdNanoseconds = 0;
+        std::chrono::steady_clock::time_point lastFrameBoundary;
+        std::chrono::steady_clock::time_point lastSlowFrameFlush;
+    };
+
+    /**
+     * Records a span from its construction until its destruction, if tracing was enabled
+     * at the time of construction.
+     */
+    class ScopedSpan {
+
+    public:
+        ScopedSpan(const char* name, const char* category)
+            : name(TraceRecorder::GetSingleton().IsEnabled() ? name : nullptr), category(category) {
+            if (this->name) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ScopedSpan() {
+            if (name) {
+                TraceRecorder::GetSingleton().RecordSpan(name, category, start, std::chrono::steady_clock::now());
+            }
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+        const char* name;
+        const char* category;
+        std::chrono::steady_clock::time_point start;
+    };
+}  // namespace Tracing
+
+#define PAPER_TRACE_CONCAT_IMPL(a, b) a##b
+#define PAPER_TRACE_CONCAT(a, b) PAPER_TRACE_CONCAT_IMPL(a, b)
+
+#if PAPER_ENABLE_TRACING
+/**
+ * Records the rest of the enclosing scope as a span with the given name (a string literal) and category.
+ */
+#define PAPER_TRACE_SCOPE(name, category) \
+    ::Tracing::ScopedSpan PAPER_TRACE_CONCAT(paperTraceSpan, __LINE__)(name, category)
+#else
+#define PAPER_TRACE_SCOPE(name, category) ((void)0)
+#endif
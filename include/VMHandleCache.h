@@ -0,0 +1,102 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+namespace VMHandles {
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+    /**
+     * Hit / miss counters of the handle cache.
+     */
+    struct CacheStats {
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    /**
+     * Our singleton cache of VM handles for forms, shared by all the event sinks. Looking up a
+     * handle through the VM's handle policy takes a lock on the policy's handle map every time,
+     * whereas lookups in this cache are lock-free.
+     *
+     * The cache is a direct-mapped table keyed by (form ID, VM type). Individual entries are
+     * invalidated whenever the VM persists or releases their handle, and the entire cache is
+     * invalidated by bumping its generation (e.g., when the game state is reverted).
+     */
+    class __declspec(dllexport) VMHandleCache {
+
+    public:
+
+        /**
+         * Get the singleton instance of the <code>VMHandleCache</code>.
+         */
+        [[nodiscard]] static VMHandleCache& GetSingleton() noexcept;
+
+        /**
+         * Returns the VM handle for the given form, as the handle policy of the given VM would.
+         * Empty handles are returned, but never cached.
+         */
+        RE::VMHandle GetHandleForObject(RE::SkyrimVM* vm, RE::VMTypeID typeID, const RE::TESForm* form);
+
+        /**
+         * Invalidates the cache entry (if any) for the given handle.
+         */
+        void InvalidateHandle(RE::VMHandle handle);
+
+        /**
+         * Invalidates all the entries in the cache.
+         */
+        void InvalidateAll();
+
+        /**
+         * Returns the number of hits and misses since the plugin was loaded.
+         */
+        [[nodiscard]] CacheStats GetStats() const;
+
+        /**
+         * Hooks the VM's handle policy, such that cached handles are invalidated whenever
+         * they are persisted or released. Must be called once the VM exists.
+         */
+        static void InstallHooks();
+
+        /**
+         * The serialization handler for reverting game state.
+         */
+        static void OnRevert(SKSE::SerializationInterface*);
+
+    private:
+        VMHandleCache() = default;
+        VMHandleCache(const VMHandleCache&) = delete;
+        VMHandleCache(VMHandleCache&&) = delete;
+        ~VMHandleCache() = default;
+
+        VMHandleCache& operator=(const VMHandleCache&) = delete;
+        VMHandleCache& operator=(VMHandleCache&&) = delete;
+
+        /** Number of entries in the cache, must be a power of 2 */
+        static constexpr std::size_t NumEntries = 4096;
+
+        /**
+         * A single cache entry, protected by a sequence lock. The sequence is odd
+         * while a writer is updating the entry.
+         */
+        struct Entry {
+            std::atomic<std::uint32_t> sequence = 0;
+            /** Packed generation, VM type and form ID of the cached handle; 0 if empty */
+            std::atomic<std::uint64_t> key = 0;
+            std::atomic<RE::VMHandle> handle = 0;
+        };
+
+        static std::size_t GetEntryIndex(RE::VMTypeID typeID, RE::FormID formID);
+        std::uint64_t MakeKey(RE::VMTypeID typeID, RE::FormID formID) const;
+
+        std::array<Entry, NumEntries> entries;
+
+        /** Current generation of the cache. Entries of older generations are never hits. */
+        std::atomic<std::uint32_t> generation = 1;
+
+        std::atomic<std::uint64_t> hits = 0;
+        std::atomic<std::uint64_t> misses = 0;
+    };
+#pragma warning(pop)
+}  // namespace VMHandles
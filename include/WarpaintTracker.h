@@ -0,0 +1,111 @@
+#pragma once
+
+#include <EngineInterfaces.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * What matters about a visible warpaint tint layer of an actor base for telling whether its warpaint
+     * changed.
+     */
+    struct WarpaintLayer {
+        std::uint16_t tintIndex;
+        /** Color as 0xRRGGBB */
+        std::uint32_t color;
+        float interpolation;
+    };
+
+    /**
+     * Returns a hash of the given warpaint layers, in order.
+     */
+    [[nodiscard]] std::uint64_t HashWarpaintLayers(std::span<const WarpaintLayer> layers);
+
+    /**
+     * Engine-independent core of the OnWarpaintChanged events: keeps the receivers registered per actor base,
+     * and a hash of the warpaint of every actor base with receivers. The plugin re-hashes tracked actor bases
+     * whenever their appearance may have changed, and tells the receivers about the ones whose hash differs
+     * from the previous one.
+     */
+    class WarpaintTracker {
+
+    public:
+        /**
+         * Registers the given receiver for changes of the warpaint of the given actor base.
+         */
+        void Register(FormID receiver, FormID actorBase);
+
+        /**
+         * Unregisters the given receiver from changes of the warpaint of the given actor base. Actor bases are
+         * no longer tracked once they have no receivers anymore.
+         */
+        void Unregister(FormID receiver, FormID actorBase);
+
+        /**
+         * Is the warpaint of any actor base tracked at all? Lets the sinks skip all work if not.
+         */
+        [[nodiscard]] bool HasTrackedActorBases() const {
+            return haveTrackedActorBases.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Is the warpaint of the given actor base tracked?
+         */
+        [[nodiscard]] bool IsTracked(FormID actorBase) const;
+
+        /**
+         * Returns all actor bases whose warpaint is tracked.
+         */
+        [[nodiscard]] std::vector<FormID> GetTrackedActorBases() const;
+
+        /**
+         * Stores the given hash of the warpaint of the given actor base. Returns the receivers to notify if the
+         * hash changed, or nothing if it did not, or if the actor base had not been hashed before.
+         */
+        [[nodiscard]] std::vector<FormID> UpdateHash(FormID actorBase, std::uint64_t hash);
+
+        /**
+         * Forgets all registrations.
+         */
+        void Revert();
+
+        /**
+         * Writes the registrations and the hashes to the cosave.
+         */
+        void Save(ISerializationInterface& serde);
+
+        /**
+         * Reads the cosave record of the given type, if it is one of ours. Returns false if the record
+         * belongs to someone else.
+         */
+        bool LoadRecord(ISerializationInterface& serde, std::uint32_t type);
+
+        static constexpr std::uint32_t WarpaintRecord = MakeRecordType("WPNT");
+
+    private:
+        /**
+         * An actor base whose warpaint is tracked.
+         */
+        struct TrackedActorBase {
+            /** Hash of the warpaint when we last checked it */
+            std::uint64_t hash = 0;
+            /** Did we check the warpaint at all yet? */
+            bool hashed = false;
+            /** Forms to send OnWarpaintChanged events to */
+            std::vector<FormID> receivers;
+        };
+
+        /** Tracked actor bases, by their form IDs */
+        std::unordered_map<FormID, TrackedActorBase> trackedActorBases;
+        /** Mutex for access to the tracked actor bases */
+        mutable std::mutex trackedActorBasesMutex;
+        /** Are there any tracked actor bases? */
+        std::atomic<bool> haveTrackedActorBases = false;
+    };
+}  // namespace Core
@@ -0,0 +1,74 @@
+#include <AssetValidation.h>
+
+#include <algorithm>
+#include <cctype>
+#include <execution>
+
+using namespace Core;
+
+namespace {
+    bool StartsWithFolder(std::string_view path, std::string_view folder) {
+        return path.size() > folder.size() && path[folder.size()] == '\\' &&
+               std::equal(folder.begin(), folder.end(), path.begin(), [](const char folderChar, const char pathChar) {
+                   return std::tolower(static_cast<unsigned char>(pathChar)) == folderChar;
+               });
+    }
+}  // namespace
+
+std::string Core::NormalizeAssetPath(std::string_view path, AssetKind kind) {
+    std::string normalized;
+    normalized.reserve(path.size() + 9);
+
+    for (const auto c : path) {
+        normalized.push_back(c == '/' ? '\\' : c);
+    }
+
+    const auto first = normalized.find_first_not_of('\\');
+    if (first == std::string::npos) {
+        return {};
+    }
+    normalized.erase(0, first);
+
+    // Forms usually store their paths relative to the folder of their kind, but not always
+    const std::string_view folder = (kind == AssetKind::kModel) ? "meshes" : "textures";
+    if (!StartsWithFolder(normalized, folder)) {
+        normalized.insert(0, "\\");
+        normalized.insert(0, folder);
+    }
+
+    return normalized;
+}
+
+void AssetPathValidator::AddPath(std::size_t formIndex, std::string_view path, AssetKind kind) {
+    auto normalized = NormalizeAssetPath(path, kind);
+    if (normalized.empty()) {
+        return;
+    }
+
+    const auto [it, inserted] =
+        pathIndices.try_emplace(std::move(normalized), static_cast<std::uint32_t>(paths.size()));
+    if (inserted) {
+        paths.push_back(it->first);
+    }
+
+    uses.emplace_back(static_cast<std::uint32_t>(formIndex), it->second);
+}
+
+std::vector<std::int32_t> AssetPathValidator::FindFormsWithMissingAssets(const ExistsFunction& exists) const {
+    // Every path is checked independently, and opening a resource stream is I/O-bound, so the checks are
+    // run in parallel into a presized array (no vector<bool>: its elements share bytes)
+    std::vector<std::uint8_t> pathExists(paths.size());
+    std::transform(std::execution::par, paths.begin(), paths.end(), pathExists.begin(),
+                   [&exists](const std::string& path) { return static_cast<std::uint8_t>(exists(path)); });
+
+    std::vector<std::int32_t> formIndices;
+    for (const auto& [formIndex, pathIndex] : uses) {
+        if (!pathExists[pathIndex]) {
+            formIndices.push_back(static_cast<std::int32_t>(formIndex));
+        }
+    }
+
+    std::sort(formIndices.begin(), formIndices.end());
+    formIndices.erase(std::unique(formIndices.begin(), formIndices.end()), formIndices.end());
+    return formIndices;
+}
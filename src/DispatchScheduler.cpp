@@ -0,0 +1,130 @@
+#include <DispatchScheduler.h>
+#include <Logging.h>
+
+#include <algorithm>
+
+using namespace Core;
+
+DispatchScheduler::DispatchScheduler(const IFormLookup& forms) : forms(forms) {
+    auto& registry = PerfStats::PerfStatsRegistry::GetSingleton();
+    queueLatencies = {&registry.Histogram("ItemEventBatcher.QueueLatency.Player"),
+                      &registry.Histogram("ItemEventBatcher.QueueLatency.Follower"),
+                      &registry.Histogram("ItemEventBatcher.QueueLatency.Registered"),
+                      &registry.Histogram("ItemEventBatcher.QueueLatency.Other")};
+}
+
+DispatchClass DispatchScheduler::Classify(FormID container) const {
+    if (forms.IsPlayer(container)) {
+        return DispatchClass::kPlayer;
+    }
+
+    if (forms.IsPlayerTeammate(container)) {
+        return DispatchClass::kFollower;
+    }
+
+    if (haveHighPriorityReferences.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+        if (highPriorityReferences.contains(container)) {
+            return DispatchClass::kRegistered;
+        }
+    }
+
+    return DispatchClass::kOther;
+}
+
+DispatchClass DispatchScheduler::ClassifyPair(FormID source, FormID dest) const {
+    return std::min(Classify(source), Classify(dest));
+}
+
+std::size_t DispatchScheduler::Schedule(std::vector<ScheduledBatch>& batches, std::uint32_t budget,
+                                        std::uint64_t& roundRobinCursor) {
+    // Higher classes to the front, one linear pass per class
+    auto others = batches.begin();
+    for (const auto dispatchClass : {DispatchClass::kPlayer, DispatchClass::kFollower, DispatchClass::kRegistered}) {
+        others = std::partition(others, batches.end(),
+                                [dispatchClass](const auto& batch) { return batch.dispatchClass == dispatchClass; });
+    }
+
+    if (budget == 0 || batches.size() <= budget) {
+        // Everything is sent this frame, so the order of the other containers does not matter
+        return batches.size();
+    }
+
+    // Every frame has room for at least one other container, so that a steady stream of high-priority
+    // containers cannot keep the others from ever getting their events
+    const auto numHighPriority = static_cast<std::size_t>(others - batches.begin());
+    const auto numOthers = static_cast<std::size_t>(batches.end() - others);
+    const auto numHighPriorityToSend =
+        std::min<std::size_t>(numHighPriority, (budget > 1 && numOthers > 0) ? budget - 1 : budget);
+    const auto numOthersToSend = std::min<std::size_t>(numOthers, budget - numHighPriorityToSend);
+
+    // Continue where the previous frame left off, so that all other containers get their turn
+    std::sort(others, batches.end(), [](const auto& lhs, const auto& rhs) { return lhs.key < rhs.key; });
+    const auto next = std::upper_bound(others, batches.end(), roundRobinCursor,
+                                       [](const auto cursor, const auto& batch) { return cursor < batch.key; });
+    std::rotate(others, next, batches.end());
+
+    if (numOthersToSend > 0) {
+        roundRobinCursor = others[numOthersToSend - 1].key;
+    }
+
+    // The other containers that are sent this frame go right behind the high-priority ones
+    std::rotate(batches.begin() + numHighPriorityToSend, others, others + numOthersToSend);
+    return numHighPriorityToSend + numOthersToSend;
+}
+
+void DispatchScheduler::RegisterHighPriority(FormID reference) {
+    std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+    highPriorityReferences.insert(reference);
+    haveHighPriorityReferences.store(true, std::memory_order_relaxed);
+}
+
+void DispatchScheduler::UnregisterHighPriority(FormID reference) {
+    std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+    highPriorityReferences.erase(reference);
+    haveHighPriorityReferences.store(!highPriorityReferences.empty(), std::memory_order_relaxed);
+}
+
+void DispatchScheduler::Revert() {
+    std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+    highPriorityReferences.clear();
+    haveHighPriorityReferences.store(false, std::memory_order_relaxed);
+}
+
+void DispatchScheduler::Save(ISerializationInterface& serde) {
+    std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+
+    if (!serde.OpenRecord(HighPriorityRecord, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t numReferences = highPriorityReferences.size();
+    serde.WriteRecordData(numReferences);
+    for (const auto reference : highPriorityReferences) {
+        serde.WriteRecordData(reference);
+    }
+}
+
+bool DispatchScheduler::LoadRecord(ISerializationInterface& serde, std::uint32_t type) {
+    if (type != HighPriorityRecord) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(highPriorityReferencesMutex);
+
+    std::size_t numReferences;
+    serde.ReadRecordData(numReferences);
+
+    for (; numReferences > 0; --numReferences) {
+        FormID referenceForm;
+        serde.ReadRecordData(referenceForm);
+        FormID newReferenceForm;
+        if (serde.ResolveFormID(referenceForm, newReferenceForm)) {
+            highPriorityReferences.insert(newReferenceForm);
+        }
+    }
+
+    haveHighPriorityReferences.store(!highPriorityReferences.empty(), std::memory_order_relaxed);
+    return true;
+}
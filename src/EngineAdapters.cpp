@@ -0,0 +1,114 @@
+#include <EngineAdapters.h>
+#include <FrameHook.h>
+#include <Logging.h>
+#include <TraceRecorder.h>
+#include <VMHandleCache.h>
+
+using namespace EngineAdapters;
+
+RE::TESForm* SkyrimFormLookup::LookupForm(Core::FormID formID) const { return RE::TESForm::LookupByID(formID); }
+
+RE::TESObjectREFR* SkyrimFormLookup::LookupReference(Core::FormID formID) const {
+    return RE::TESForm::LookupByID<RE::TESObjectREFR>(formID);
+}
+
+bool SkyrimFormLookup::FormListHasForm(Core::FormID formListID, Core::FormID formID) const {
+    auto formList = RE::TESForm::LookupByID<RE::BGSListForm>(formListID);
+    if (!formList) {
+        Logging::error(Logging::Category::kEvents, "Expected form to be FormList: {:X}", formListID);
+        return false;
+    }
+
+    return formList->HasForm(formID);
+}
+
+bool SkyrimFormLookup::IsPlayer(Core::FormID formID) const {
+    const auto player = RE::PlayerCharacter::GetSingleton();
+    return player && player->formID == formID;
+}
+
+bool SkyrimFormLookup::IsPlayerTeammate(Core::FormID formID) const {
+    const auto actor = RE::TESForm::LookupByID<RE::Actor>(formID);
+    return actor && actor->IsPlayerTeammate();
+}
+
+std::int32_t SkyrimInventoryLookup::GetItemCount(Core::FormID container, Core::FormID item) const {
+    const auto reference = RE::TESForm::LookupByID<RE::TESObjectREFR>(container);
+    if (!reference) {
+        return 0;
+    }
+
+    const auto counts =
+        reference->GetInventoryCounts([item](RE::TESBoundObject& object) { return object.formID == item; });
+    return counts.empty() ? 0 : counts.begin()->second;
+}
+
+Core::VMHandle SkyrimHandlePolicy::GetHandleForReference(const RE::TESObjectREFR* reference) {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm) {
+        return 0;
+    }
+
+    return VMHandles::VMHandleCache::GetSingleton().GetHandleForObject(
+        vm, static_cast<RE::VMTypeID>(RE::FormType::Reference), reference);
+}
+
+Core::VMHandle SkyrimHandlePolicy::GetHandleForForm(const RE::TESForm* form) {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm || !form) {
+        return 0;
+    }
+
+    return VMHandles::VMHandleCache::GetSingleton().GetHandleForObject(
+        vm, static_cast<RE::VMTypeID>(form->GetFormType()), form);
+}
+
+bool SkyrimHandlePolicy::IsValidHandle(Core::VMHandle handle) const {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    return vm && handle && handle != vm->handlePolicy.EmptyHandle();
+}
+
+bool SkyrimSerializationInterface::OpenRecord(std::uint32_t type, std::uint32_t version) {
+    return serde->OpenRecord(type, version);
+}
+
+bool SkyrimSerializationInterface::WriteRecordData(const void* buf, std::uint32_t length) {
+    return serde->WriteRecordData(buf, length);
+}
+
+bool SkyrimSerializationInterface::GetNextRecordInfo(std::uint32_t& type, std::uint32_t& version,
+                                                     std::uint32_t& length) {
+    return serde->GetNextRecordInfo(type, version, length);
+}
+
+std::uint32_t SkyrimSerializationInterface::ReadRecordData(void* buf, std::uint32_t length) {
+    return serde->ReadRecordData(buf, length);
+}
+
+bool SkyrimSerializationInterface::ResolveFormID(Core::FormID oldFormID, Core::FormID& newFormID) {
+    return serde->ResolveFormID(oldFormID, newFormID);
+}
+
+void SkyrimTaskQueue::AddTask(std::function<void()> task) {
+#if PAPER_ENABLE_TRACING
+    SKSE::GetTaskInterface()->AddTask([task = std::move(task)]() {
+        PAPER_TRACE_SCOPE("SKSETask", "task");
+        task();
+    });
+#else
+    SKSE::GetTaskInterface()->AddTask(std::move(task));
+#endif
+}
+
+void SkyrimTaskQueue::AddTaskNextFrame(std::function<void()> task) {
+#if PAPER_ENABLE_TRACING
+    FrameHook::AddTaskNextFrame([task = std::move(task)]() {
+        PAPER_TRACE_SCOPE("NextFrameTask", "task");
+        task();
+    });
+#else
+    FrameHook::AddTaskNextFrame(std::move(task));
+#endif
+}
+
+std::uint64_t SkyrimTaskQueue::GetFrameNumber() const { return FrameHook::GetFrameNumber(); }
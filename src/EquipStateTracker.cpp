@@ -0,0 +1,175 @@
+#include <EquipStateTracker.h>
+#include <Logging.h>
+
+#include <algorithm>
+
+using namespace Core;
+
+bool EquipStateTracker::RecordEquip(FormID actor, FormID form, bool equipped) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    if (!IsInWindow(actor)) {
+        ApplyToKnownState(actor, form, equipped);
+        return true;
+    }
+
+    // Only the final state of each form matters once the window closes
+    auto& events = heldBackEvents[actor];
+    const auto it =
+        std::find_if(events.begin(), events.end(), [form](const auto& event) { return event.first == form; });
+    if (it != events.end()) {
+        it->second = equipped;
+    } else {
+        events.emplace_back(form, equipped);
+    }
+
+    return false;
+}
+
+void EquipStateTracker::BeginLoadWindow() {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    loadWindowOpen = true;
+    loading = true;
+}
+
+void EquipStateTracker::EndLoadWindow(std::uint32_t frames) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    loading = false;
+    loadWindowFramesLeft = frames;
+}
+
+void EquipStateTracker::BeginActorWindow(FormID actor, std::uint32_t frames) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    auto& framesLeft = actorWindows[actor];
+    framesLeft = std::max(framesLeft, frames);
+}
+
+bool EquipStateTracker::AdvanceFrame(std::vector<EquipChange>& changes) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    if (loadWindowOpen && !loading) {
+        if (loadWindowFramesLeft == 0) {
+            loadWindowOpen = false;
+        } else {
+            --loadWindowFramesLeft;
+        }
+    }
+
+    for (auto it = actorWindows.begin(); it != actorWindows.end();) {
+        if (it->second == 0) {
+            it = actorWindows.erase(it);
+        } else {
+            --it->second;
+            ++it;
+        }
+    }
+
+    for (auto it = heldBackEvents.begin(); it != heldBackEvents.end();) {
+        const auto actor = it->first;
+        if (IsInWindow(actor)) {
+            ++it;
+            continue;
+        }
+
+        // Without a known state, there is nothing to compare against, so the events only seed it
+        const bool seeding = !knownStates.contains(actor);
+        for (const auto& [form, equipped] : it->second) {
+            if (ApplyToKnownState(actor, form, equipped) && !seeding) {
+                changes.emplace_back(actor, form, equipped);
+            }
+        }
+        it = heldBackEvents.erase(it);
+    }
+
+    return loadWindowOpen || !actorWindows.empty();
+}
+
+bool EquipStateTracker::ApplyToKnownState(FormID actor, FormID form, bool equipped) {
+    // An actor without anything equipped keeps its (empty) state, so that it stays known
+    auto& state = knownStates[actor];
+
+    if (equipped) {
+        if (std::find(state.begin(), state.end(), form) != state.end()) {
+            return false;
+        }
+
+        state.push_back(form);
+        return true;
+    }
+
+    return std::erase(state, form) > 0;
+}
+
+bool EquipStateTracker::IsInWindow(FormID actor) const { return loadWindowOpen || actorWindows.contains(actor); }
+
+void EquipStateTracker::ForgetActor(FormID actor) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    knownStates.erase(actor);
+    heldBackEvents.erase(actor);
+    actorWindows.erase(actor);
+}
+
+void EquipStateTracker::Revert() {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    knownStates.clear();
+    heldBackEvents.clear();
+}
+
+void EquipStateTracker::Save(ISerializationInterface& serde) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    if (!serde.OpenRecord(EquipStatesRecord, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t numActors = knownStates.size();
+    serde.WriteRecordData(numActors);
+    for (const auto& [actor, forms] : knownStates) {
+        serde.WriteRecordData(actor);
+
+        std::size_t numForms = forms.size();
+        serde.WriteRecordData(numForms);
+        for (const auto form : forms) {
+            serde.WriteRecordData(form);
+        }
+    }
+}
+
+bool EquipStateTracker::LoadRecord(ISerializationInterface& serde, std::uint32_t type) {
+    if (type != EquipStatesRecord) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    std::size_t numActors;
+    serde.ReadRecordData(numActors);
+
+    for (; numActors > 0; --numActors) {
+        FormID actorForm;
+        serde.ReadRecordData(actorForm);
+        FormID newActorForm;
+        const bool resolvedActorForm = serde.ResolveFormID(actorForm, newActorForm);
+
+        std::size_t numForms;
+        serde.ReadRecordData(numForms);
+
+        std::vector<FormID> forms;
+        for (; numForms > 0; --numForms) {
+            FormID form;
+            serde.ReadRecordData(form);
+            FormID newForm;
+            if (serde.ResolveFormID(form, newForm)) {
+                forms.push_back(newForm);
+            }
+        }
+
+        if (resolvedActorForm) {
+            knownStates[newActorForm] = std::move(forms);
+        }
+    }
+
+    return true;
+}
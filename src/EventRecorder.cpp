@@ -0,0 +1,159 @@
+#include <EventRecorder.h>
+#include <Logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace Recording;
+
+std::span<const RecordedEvent> Recording::ReadEventLog(std::span<const std::byte> contents) {
+    EventLogHeader header;
+    if (contents.size() < sizeof(header)) {
+        return {};
+    }
+
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (!std::equal(std::begin(header.magic), std::end(header.magic), std::begin(EventLogMagic)) ||
+        header.version != EventLogVersion) {
+        return {};
+    }
+
+    const auto records = contents.subspan(sizeof(header));
+    return {reinterpret_cast<const RecordedEvent*>(records.data()), records.size() / sizeof(RecordedEvent)};
+}
+
+EventRecorder& EventRecorder::GetSingleton() noexcept {
+    static EventRecorder instance;
+    return instance;
+}
+
+EventRecorder::~EventRecorder() { Stop(); }
+
+void EventRecorder::SetOutputDirectory(std::filesystem::path directory) {
+    std::lock_guard<std::mutex> lockGuard(controlMutex);
+    outputDirectory = std::move(directory);
+}
+
+std::filesystem::path EventRecorder::Start() {
+    Stop();
+
+    std::lock_guard<std::mutex> lockGuard(controlMutex);
+
+    const auto path = outputDirectory / ("PAPER_events_" + std::to_string(numRecordings++) + ".bin");
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        Logging::error(Logging::Category::kTrace, "Unable to open event log {} for writing.", path.string());
+        return {};
+    }
+
+    EventLogHeader header;
+    std::copy(std::begin(EventLogMagic), std::end(EventLogMagic), std::begin(header.magic));
+    header.version = EventLogVersion;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    {
+        std::lock_guard<std::mutex> bufferLockGuard(bufferMutex);
+        buffer.clear();
+        buffer.reserve(FlushThreshold * 2);
+        start = std::chrono::steady_clock::now();
+        recording.store(true, std::memory_order_relaxed);
+    }
+
+    writer = std::thread([this]() { this->WriteLoop(); });
+
+    Logging::info(Logging::Category::kTrace, "Recording events to {}.", path.string());
+    return path;
+}
+
+void EventRecorder::Stop() {
+    std::lock_guard<std::mutex> lockGuard(controlMutex);
+
+    {
+        std::lock_guard<std::mutex> bufferLockGuard(bufferMutex);
+        recording.store(false, std::memory_order_relaxed);
+    }
+    bufferReady.notify_one();
+
+    if (writer.joinable()) {
+        writer.join();
+        file.close();
+    }
+}
+
+void EventRecorder::WriteLoop() {
+    std::vector<RecordedEvent> toWrite;
+    toWrite.reserve(FlushThreshold * 2);
+
+    bool keepRunning = true;
+    while (keepRunning) {
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            bufferReady.wait(lock, [this]() { return buffer.size() >= FlushThreshold || !IsRecording(); });
+            toWrite.swap(buffer);
+            keepRunning = IsRecording();
+        }
+
+        file.write(reinterpret_cast<const char*>(toWrite.data()),
+                   static_cast<std::streamsize>(toWrite.size() * sizeof(RecordedEvent)));
+        toWrite.clear();
+    }
+
+    file.flush();
+}
+
+void EventRecorder::Append(const RecordedEvent& event) {
+    bool wakeWriter;
+    {
+        std::lock_guard<std::mutex> lockGuard(bufferMutex);
+        if (!IsRecording()) {
+            return;
+        }
+
+        buffer.push_back(event);
+        wakeWriter = buffer.size() == FlushThreshold;
+    }
+
+    if (wakeWriter) {
+        bufferReady.notify_one();
+    }
+}
+
+void EventRecorder::RecordFrame() {
+    if (!IsRecording()) {
+        return;
+    }
+
+    // Zeroes all of the union first, so that no uninitialized bytes end up in the log
+    RecordedEvent event{RecordedEventType::kFrame, {}, 0, {}};
+    event.timestamp =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    Append(event);
+}
+
+void EventRecorder::RecordContainerChanged(Core::FormID oldContainer, Core::FormID newContainer, Core::FormID baseObj,
+                                           std::int32_t itemCount) {
+    if (!IsRecording()) {
+        return;
+    }
+
+    Append({RecordedEventType::kContainerChanged, {}, itemCount, {.forms = {oldContainer, newContainer, baseObj, 0}}});
+}
+
+void EventRecorder::RecordHit(Core::FormID target, Core::FormID cause, Core::FormID source, Core::FormID projectile,
+                              std::uint32_t flags) {
+    if (!IsRecording()) {
+        return;
+    }
+
+    Append({RecordedEventType::kHit, {}, static_cast<std::int32_t>(flags),
+            {.forms = {target, cause, source, projectile}}});
+}
+
+void EventRecorder::RecordEquip(Core::FormID actor, Core::FormID baseObject, bool equipped) {
+    if (!IsRecording()) {
+        return;
+    }
+
+    Append({RecordedEventType::kEquip, {}, equipped ? 1 : 0, {.forms = {actor, baseObject, 0, 0}}});
+}
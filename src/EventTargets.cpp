@@ -0,0 +1,74 @@
+#include <EventTargets.h>
+#include <SKSE/SKSE.h>
+
+using namespace EventTargets;
+
+EventTargetCache& EventTargetCache::GetSingleton() noexcept {
+    static EventTargetCache instance;
+    return instance;
+}
+
+bool EventTargetCache::HandleHasEventHandler(RE::VMHandle handle, const RE::BSFixedString& eventName) {
+    auto vm = RE::BSScript::Internal::VirtualMachine::GetSingleton();
+    if (!vm) {
+        return true;
+    }
+
+    RE::BSSpinLockGuard locker(vm->attachedScriptsLock);
+
+    const auto it = vm->attachedScripts.find(handle);
+    if (it == vm->attachedScripts.end()) {
+        return false;
+    }
+
+    for (auto& attachedScript : it->second) {
+        const auto script = attachedScript.get();
+        const auto typeInfo = script ? script->GetTypeInfo() : nullptr;
+
+        if (typeInfo && TypeHasEventHandler(typeInfo, eventName)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EventTargetCache::TypeHasEventHandler(RE::BSScript::ObjectTypeInfo* typeInfo,
+                                           const RE::BSFixedString& eventName) {
+    const TypeEventKey key{typeInfo, eventName.data()};
+
+    {
+        std::shared_lock<std::shared_mutex> lockGuard(cacheMutex);
+
+        const auto it = cache.find(key);
+        if (it != cache.end()) {
+            return it->second.hasEventHandler;
+        }
+    }
+
+    bool hasEventHandler = false;
+    for (auto type = typeInfo; type && !hasEventHandler; type = type->GetParent()) {
+        if (type->GetNumNamedStates() > 0) {
+            // Events may also be defined only in named states, which we do not inspect. Assume
+            // that scripts with states handle the event, so we never wrongly skip them.
+            hasEventHandler = true;
+            break;
+        }
+
+        const auto memberFuncs = type->GetMemberFuncIter();
+        for (std::uint32_t i = 0; i < type->GetNumMemberFuncs(); ++i) {
+            const auto& func = memberFuncs[i].func;
+            if (func && func->GetName() == eventName) {
+                hasEventHandler = true;
+                break;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::shared_mutex> lockGuard(cacheMutex);
+        cache.try_emplace(key, RE::BSTSmartPointer<RE::BSScript::ObjectTypeInfo>(typeInfo), hasEventHandler);
+    }
+
+    return hasEventHandler;
+}
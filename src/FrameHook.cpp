@@ -0,0 +1,70 @@
+#include <EventRecorder.h>
+#include <FrameHook.h>
+#include <Logging.h>
+#include <TraceRecorder.h>
+#include <SKSE/SKSE.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+    /** Number of the current frame */
+    std::atomic<std::uint64_t> frameNumber = 0;
+    /** Tasks queued up for the next frame boundary */
+    std::vector<std::function<void()>> nextFrameTasks;
+    /** The tasks being run at the current frame boundary */
+    std::vector<std::function<void()>> runningTasks;
+    /** Mutex for access to the tasks queued up for the next frame boundary */
+    std::mutex nextFrameTasksMutex;
+
+    /**
+     * Runs the tasks queued up for this frame boundary. Tasks that they queue up wait for the next one.
+     */
+    void RunNextFrameTasks() {
+        {
+            std::lock_guard<std::mutex> lockGuard(nextFrameTasksMutex);
+            runningTasks.swap(nextFrameTasks);
+        }
+
+        for (auto& task : runningTasks) {
+            task();
+        }
+        runningTasks.clear();
+    }
+
+    /**
+     * Hook on a call made once per frame by Main::Update, on the main thread.
+     */
+    struct MainUpdateHook {
+        static std::int64_t thunk(std::int64_t a1) {
+            const auto result = func(a1);
+            Recording::EventRecorder::GetSingleton().RecordFrame();
+#if PAPER_ENABLE_TRACING
+            Tracing::TraceRecorder::GetSingleton().OnFrameBoundary();
+#endif
+            frameNumber.fetch_add(1, std::memory_order_relaxed);
+            RunNextFrameTasks();
+            return result;
+        }
+
+        static inline REL::Relocation<decltype(thunk)> func;
+    };
+}
+
+void FrameHook::Install() {
+    REL::Relocation<std::uintptr_t> hook{RELOCATION_ID(35565, 36564), REL::VariantOffset(0x748, 0xC26, 0x7EE)};
+
+    SKSE::AllocTrampoline(14);
+    auto& trampoline = SKSE::GetTrampoline();
+    MainUpdateHook::func = trampoline.write_call<5>(hook.address(), MainUpdateHook::thunk);
+
+    Logging::trace(Logging::Category::kGeneral, "Main loop hooked for frame boundaries.");
+}
+
+void FrameHook::AddTaskNextFrame(std::function<void()> task) {
+    std::lock_guard<std::mutex> lockGuard(nextFrameTasksMutex);
+    nextFrameTasks.push_back(std::move(task));
+}
+
+std::uint64_t FrameHook::GetFrameNumber() { return frameNumber.load(std::memory_order_relaxed); }
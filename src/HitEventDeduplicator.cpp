@@ -0,0 +1,32 @@
+#include <HitEventDeduplicator.h>
+
+using namespace Core;
+
+bool HitEventDeduplicator::IsDuplicate(const RE::TESObjectREFR* target, const RE::TESObjectREFR* cause,
+                                       float applicationRuntime) {
+    bool duplicate = false;
+    std::size_t numToRemove = 0;
+    for (const auto& recentHit : recentHits) {
+        if (recentHit.applicationRuntime == applicationRuntime) {
+            if (recentHit.cause == cause && recentHit.target == target) {
+                // Already processed hit for same cause+target too recently, so skip
+                duplicate = true;
+                break;
+            }
+        } else {
+            // Data from older frames / long enough ago, keep clearing
+            ++numToRemove;
+        }
+    }
+
+    if (numToRemove > 0) {
+        recentHits.erase(recentHits.begin(), recentHits.begin() + numToRemove);
+    }
+
+    return duplicate;
+}
+
+void HitEventDeduplicator::RecordHit(const RE::TESObjectREFR* target, const RE::TESObjectREFR* cause,
+                                     float applicationRuntime) {
+    recentHits.emplace_back(target, cause, applicationRuntime);
+}
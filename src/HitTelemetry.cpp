@@ -0,0 +1,148 @@
+#include <HitTelemetry.h>
+#include <Settings.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace Core;
+
+void HitTelemetry::RecordHit(FormID aggressor, FormID target, std::uint8_t flags, std::uint32_t now) {
+    const auto numPairs = std::max<std::size_t>(GetSettings().hitEvents.telemetryPairs, 1);
+
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    if (slots.size() != numPairs) {
+        slots.assign(numPairs, PairSlot{});
+        slotIndices.clear();
+        slotIndices.reserve(numPairs);
+        nextSlot = 0;
+    }
+
+    const auto key = MakePairKey(aggressor, target);
+    const auto [it, inserted] = slotIndices.try_emplace(key, static_cast<std::uint32_t>(nextSlot));
+    auto& slot = slots[it->second];
+
+    if (inserted) {
+        // Take over the slot of the pair that was added longest ago
+        if (slot.numHits > 0) {
+            slotIndices.erase(slot.key);
+        }
+        slot = PairSlot{};
+        slot.key = key;
+        nextSlot = (nextSlot + 1) % slots.size();
+    } else if (slot.Hit(0).time == now) {
+        // Same frame as the previous hit of this pair, so it is the same hit
+        slot.hits[slot.newest].flags |= flags;
+        return;
+    }
+
+    slot.newest = static_cast<std::uint8_t>((slot.newest + 1) % HitsPerPair);
+    slot.hits[slot.newest] = {now, flags};
+    slot.numHits = static_cast<std::uint8_t>(std::min<std::size_t>(slot.numHits + 1, HitsPerPair));
+}
+
+const HitTelemetry::PairSlot* HitTelemetry::FindSlot(FormID aggressor, FormID target) const {
+    const auto it = slotIndices.find(MakePairKey(aggressor, target));
+    return (it != slotIndices.end()) ? &slots[it->second] : nullptr;
+}
+
+template <class Visit>
+std::size_t HitTelemetry::VisitHitsInWindow(const PairSlot& slot, std::uint32_t now, std::uint32_t window,
+                                            Visit&& visit) const {
+    std::size_t numHits = 0;
+    for (; numHits < slot.numHits; ++numHits) {
+        const auto& hit = slot.Hit(numHits);
+        if (now - hit.time > window) {
+            break;
+        }
+        visit(hit.flags);
+    }
+
+    return numHits;
+}
+
+std::vector<FormID> HitTelemetry::GetRecentAttackers(FormID target, std::uint32_t now, std::uint32_t window) const {
+    std::vector<std::pair<std::uint32_t, FormID>> attackers;
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+
+        for (const auto& slot : slots) {
+            if (slot.numHits == 0 || static_cast<FormID>(slot.key & 0xFFFFFFFF) != target) {
+                continue;
+            }
+
+            const auto lastHitTime = slot.Hit(0).time;
+            if (now - lastHitTime <= window) {
+                attackers.emplace_back(lastHitTime, static_cast<FormID>(slot.key >> 32));
+            }
+        }
+    }
+
+    std::sort(attackers.begin(), attackers.end(), [](const auto& lhs, const auto& rhs) { return lhs > rhs; });
+
+    std::vector<FormID> result;
+    result.reserve(attackers.size());
+    for (const auto& attacker : attackers) {
+        result.push_back(attacker.second);
+    }
+
+    return result;
+}
+
+float HitTelemetry::GetHitRate(FormID aggressor, FormID target, std::uint32_t now, std::uint32_t window) const {
+    if (window == 0) {
+        return 0.0f;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    const auto slot = FindSlot(aggressor, target);
+    if (!slot) {
+        return 0.0f;
+    }
+
+    const auto numHits = VisitHitsInWindow(*slot, now, window, [](std::uint8_t) {});
+    return static_cast<float>(numHits) * 1000.0f / static_cast<float>(window);
+}
+
+float HitTelemetry::GetBlockedRatio(FormID aggressor, FormID target, std::uint32_t now,
+                                    std::uint32_t window) const {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    const auto slot = FindSlot(aggressor, target);
+    if (!slot) {
+        return 0.0f;
+    }
+
+    std::size_t numBlocked = 0;
+    const auto numHits = VisitHitsInWindow(*slot, now, window, [&numBlocked](std::uint8_t flags) {
+        if (flags & HitFlags::kHitBlocked) {
+            ++numBlocked;
+        }
+    });
+
+    return (numHits > 0) ? static_cast<float>(numBlocked) / static_cast<float>(numHits) : 0.0f;
+}
+
+std::int32_t HitTelemetry::GetPowerAttackStreak(FormID aggressor, FormID target) const {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    const auto slot = FindSlot(aggressor, target);
+    if (!slot) {
+        return 0;
+    }
+
+    std::int32_t streak = 0;
+    while (static_cast<std::size_t>(streak) < slot->numHits && (slot->Hit(streak).flags & HitFlags::kPowerAttack)) {
+        ++streak;
+    }
+
+    return streak;
+}
+
+void HitTelemetry::Revert() {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    slots.clear();
+    slotIndices.clear();
+    nextSlot = 0;
+}
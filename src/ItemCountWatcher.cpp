@@ -0,0 +1,209 @@
+#include <ItemCountWatcher.h>
+#include <Logging.h>
+#include <Profiling.h>
+
+#include <algorithm>
+
+using namespace Core;
+
+void ItemCountWatcher::Watch(FormID container, FormID item, std::int32_t threshold) {
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+
+    auto [it, inserted] = watches.try_emplace(MakeWatchKey(container, item));
+    auto& watch = it->second;
+    if (inserted) {
+        // Seeded under the lock, so no change of the inventory can slip in between
+        watch.itemCount = services.inventory.GetItemCount(container, item);
+        watch.reportedCount = watch.itemCount;
+    }
+
+    if (std::find(watch.thresholds.begin(), watch.thresholds.end(), threshold) == watch.thresholds.end()) {
+        watch.thresholds.push_back(threshold);
+    }
+
+    haveWatches.store(true, std::memory_order_relaxed);
+}
+
+void ItemCountWatcher::Unwatch(FormID container, FormID item, std::int32_t threshold) {
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+
+    const auto key = MakeWatchKey(container, item);
+    const auto it = watches.find(key);
+    if (it == watches.end()) {
+        return;
+    }
+
+    std::erase(it->second.thresholds, threshold);
+    if (it->second.thresholds.empty()) {
+        watches.erase(it);
+        changedWatches.erase(key);
+    }
+
+    haveWatches.store(!watches.empty(), std::memory_order_relaxed);
+}
+
+void ItemCountWatcher::RecordEvent(FormID oldContainer, FormID newContainer, FormID baseObj,
+                                   std::int32_t itemCount) {
+    if (!haveWatches.load(std::memory_order_relaxed) || baseObj == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(watchesMutex);
+
+        if (oldContainer > 0) {
+            ApplyDelta(oldContainer, baseObj, -itemCount);
+        }
+        if (newContainer > 0) {
+            ApplyDelta(newContainer, baseObj, itemCount);
+        }
+
+        if (changedWatches.empty() || haveQueuedUpTask) {
+            return;
+        }
+        haveQueuedUpTask = true;
+    }
+
+    services.tasks.AddTask([this]() { this->SendItemCountEvents(); });
+}
+
+void ItemCountWatcher::ApplyDelta(FormID container, FormID item, std::int32_t delta) {
+    const auto key = MakeWatchKey(container, item);
+    const auto it = watches.find(key);
+    if (it == watches.end()) {
+        return;
+    }
+
+    it->second.itemCount += delta;
+    changedWatches.insert(key);
+}
+
+void ItemCountWatcher::SendItemCountEvents() {
+    PAPER_PROFILE_SCOPE("ItemCountWatcher.SendItemCountEvents", "task");
+
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+    haveQueuedUpTask = false;
+
+    if (!services.sender.IsReady()) {
+        changedWatches.clear();
+        return;
+    }
+
+    for (const auto key : changedWatches) {
+        const auto it = watches.find(key);
+        if (it == watches.end()) {
+            continue;
+        }
+
+        auto& watch = it->second;
+        const auto previousCount = watch.reportedCount;
+        watch.reportedCount = watch.itemCount;
+
+        const auto container = services.forms.LookupReference(static_cast<FormID>(key >> 32));
+        const auto handle = container ? services.handles.GetHandleForReference(container) : 0;
+        if (!services.handles.IsValidHandle(handle)) {
+            continue;
+        }
+
+        const auto item = services.forms.LookupForm(static_cast<FormID>(key & 0xFFFFFFFF));
+        for (const auto threshold : watch.thresholds) {
+            // Only edges: the count was below the threshold before and is not anymore, or vice versa
+            if ((previousCount < threshold) != (watch.itemCount < threshold)) {
+                services.sender.SendItemCountEvent(handle, item, threshold, watch.itemCount);
+            }
+        }
+    }
+
+    changedWatches.clear();
+}
+
+void ItemCountWatcher::SeedCounts() {
+    PAPER_PROFILE_SCOPE("ItemCountWatcher.SeedCounts", "task");
+
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+    for (auto& [key, watch] : watches) {
+        watch.itemCount =
+            services.inventory.GetItemCount(static_cast<FormID>(key >> 32), static_cast<FormID>(key & 0xFFFFFFFF));
+        watch.reportedCount = watch.itemCount;
+    }
+    changedWatches.clear();
+}
+
+void ItemCountWatcher::Revert() {
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+    watches.clear();
+    changedWatches.clear();
+    haveWatches.store(false, std::memory_order_relaxed);
+}
+
+void ItemCountWatcher::Save(ISerializationInterface& serde) {
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+
+    if (!serde.OpenRecord(ItemCountWatchesRecord, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t numWatches = watches.size();
+    serde.WriteRecordData(numWatches);
+    for (const auto& [key, watch] : watches) {
+        const auto container = static_cast<FormID>(key >> 32);
+        const auto item = static_cast<FormID>(key & 0xFFFFFFFF);
+        serde.WriteRecordData(container);
+        serde.WriteRecordData(item);
+
+        std::size_t numThresholds = watch.thresholds.size();
+        serde.WriteRecordData(numThresholds);
+        for (const auto threshold : watch.thresholds) {
+            serde.WriteRecordData(threshold);
+        }
+    }
+}
+
+bool ItemCountWatcher::LoadRecord(ISerializationInterface& serde, std::uint32_t type) {
+    if (type != ItemCountWatchesRecord) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(watchesMutex);
+
+    std::size_t numWatches;
+    serde.ReadRecordData(numWatches);
+
+    for (; numWatches > 0; --numWatches) {
+        FormID containerForm;
+        serde.ReadRecordData(containerForm);
+        FormID newContainerForm;
+        const bool resolvedContainerForm = serde.ResolveFormID(containerForm, newContainerForm);
+
+        FormID itemForm;
+        serde.ReadRecordData(itemForm);
+        FormID newItemForm;
+        const bool resolvedItemForm = serde.ResolveFormID(itemForm, newItemForm);
+
+        std::size_t numThresholds;
+        serde.ReadRecordData(numThresholds);
+
+        std::vector<std::int32_t> thresholds(numThresholds);
+        for (auto& threshold : thresholds) {
+            serde.ReadRecordData(threshold);
+        }
+
+        if (resolvedContainerForm && resolvedItemForm) {
+            watches[MakeWatchKey(newContainerForm, newItemForm)].thresholds = std::move(thresholds);
+        } else {
+            Logging::debug(Logging::Category::kCosave,
+                           "Dropped item count watch of {:X} in {:X}, which could not be found after loading the save.",
+                           itemForm, containerForm);
+        }
+    }
+
+    haveWatches.store(!watches.empty(), std::memory_order_relaxed);
+    return true;
+}
+
+void ItemCountWatcher::FinishLoad() {
+    if (haveWatches.load(std::memory_order_relaxed)) {
+        services.tasks.AddTask([this]() { this->SeedCounts(); });
+    }
+}
@@ -0,0 +1,962 @@
+#include <ItemEventBatcher.h>
+#include <InventoryEventFilter.h>
+#include <Logging.h>
+#include <Profiling.h>
+#include <Settings.h>
+
+#include <algorithm>
+#include <execution>
+
+using namespace Core;
+
+void ItemEventBatcher::RecordEvent(FormID oldContainer, FormID newContainer, FormID baseObj,
+                                   std::int32_t itemCount) {
+    if (baseObj == 0) {
+        return;
+    }
+
+    const bool recordAsRemoved = (oldContainer > 0);
+    const bool recordAsAdded = (newContainer > 0);
+
+    if (recordAsRemoved && recordAsAdded) {
+        bool anyContainerRegistered;
+        {
+            std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+            anyContainerRegistered =
+                IsRegisteredForItemsTransferred(oldContainer) || IsRegisteredForItemsTransferred(newContainer);
+        }
+
+        if (anyContainerRegistered) {
+            // The move is still recorded as removed and added below: only the registered objects receive it
+            // as part of an item-transferred event instead, and the other objects of the containers do not.
+            {
+                std::lock_guard<std::mutex> lockGuard(batchedItemTransferredEventsMapMutex);
+
+                AppendEvent(batchedItemTransferredEventsMap[MakeTransferKey(oldContainer, newContainer)],
+                            newContainer, baseObj, itemCount);
+            }
+
+            if (!haveQueuedUpTaskTransferredEvents) {
+                haveQueuedUpTaskTransferredEvents = true;
+                services.tasks.AddTask([this]() { this->SendItemTransferredEvents(); });
+            }
+        }
+    }
+
+    if (recordAsRemoved) {
+        {
+            std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
+
+            AppendEvent(batchedItemRemovedEventsMap[oldContainer], newContainer, baseObj, itemCount);
+        }
+
+        if (!haveQueuedUpTaskRemovedEvents) {
+            haveQueuedUpTaskRemovedEvents = true;
+            services.tasks.AddTask([this]() { this->SendItemRemovedEvents(); });
+        }
+    }
+
+    if (recordAsAdded) {
+        {
+            std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+
+            AppendEvent(batchedItemAddedEventsMap[newContainer], oldContainer, baseObj, itemCount);
+        }
+
+        if (!haveQueuedUpTaskAddedEvents) {
+            haveQueuedUpTaskAddedEvents = true;
+            services.tasks.AddTask([this]() { this->SendItemAddedEvents(); });
+        }
+    }
+}
+
+void ItemEventBatcher::AppendEvent(ItemEventBatch& batch, FormID otherContainer, FormID baseObj,
+                                   std::int32_t itemCount) {
+    const auto maxEvents = GetSettings().inventoryEvents.maxEventsPerContainer;
+    if (maxEvents > 0 && batch.events.size() >= maxEvents) {
+        PAPER_STATS_COUNT(kContainerChanged, eventsFiltered, 1);
+        return;
+    }
+
+    batch.events.emplace_back(otherContainer, baseObj, itemCount);
+}
+
+ItemEventBatcher::BatchWindow ItemEventBatcher::GetBatchWindow(FormID container,
+                                                               const BatchWindow& globalWindow) const {
+    if (!haveBatchWindows.load(std::memory_order_relaxed)) {
+        return globalWindow;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(batchWindowsMutex);
+    const auto it = batchWindows.find(container);
+    if (it == batchWindows.end()) {
+        return globalWindow;
+    }
+
+    return {0, std::chrono::milliseconds(it->second)};
+}
+
+ItemEventBatcher::BatchWindow ItemEventBatcher::GetBatchWindow(std::uint64_t transferKey,
+                                                               const BatchWindow& globalWindow) const {
+    const auto sourceWindow = GetBatchWindow(static_cast<FormID>(transferKey >> 32), globalWindow);
+    const auto destWindow = GetBatchWindow(static_cast<FormID>(transferKey & 0xFFFFFFFF), globalWindow);
+    return {std::min(sourceWindow.frames, destWindow.frames), std::min(sourceWindow.duration, destWindow.duration)};
+}
+
+bool ItemEventBatcher::IsBatchReady(ItemEventBatch& batch, const BatchWindow& window, std::uint32_t maxBatchSize,
+                                    ItemEventBatch::Clock::time_point now) {
+    if (maxBatchSize > 0 && batch.events.size() >= maxBatchSize) {
+        // Already large enough, so there is nothing to gain by waiting for the rest of the window
+        return true;
+    }
+
+    if (batch.framesWaited < window.frames || now - batch.opened < window.duration) {
+        ++batch.framesWaited;
+        return false;
+    }
+
+    return true;
+}
+
+std::uint32_t ItemEventBatcher::GetRemainingBudget(FrameBudget& budget, std::uint32_t maxPerFrame) const {
+    // The frame number only changes in the once-per-frame hook, so the tasks that run later in the same
+    // frame share what is left of the budget instead of each starting a new one
+    const auto frame = services.tasks.GetFrameNumber();
+    if (budget.frame != frame) {
+        budget.frame = frame;
+        budget.numSent = 0;
+    }
+
+    return maxPerFrame - std::min(budget.numSent, maxPerFrame);
+}
+
+std::size_t ItemEventBatcher::ScheduleWithinBudget(FrameBudget& budget, std::uint64_t& roundRobinCursor) {
+    const auto maxPerFrame = GetSettings().inventoryEvents.maxContainersPerFrame;
+    if (maxPerFrame == 0) {
+        return DispatchScheduler::Schedule(readyBatches, 0, roundRobinCursor);
+    }
+
+    const auto remaining = GetRemainingBudget(budget, maxPerFrame);
+    if (remaining == 0) {
+        return 0;
+    }
+
+    const auto numToSend = DispatchScheduler::Schedule(readyBatches, remaining, roundRobinCursor);
+    budget.numSent += static_cast<std::uint32_t>(numToSend);
+    return numToSend;
+}
+
+void ItemEventBatcher::RegisterHighPriority(FormID container) { scheduler.RegisterHighPriority(container); }
+
+void ItemEventBatcher::UnregisterHighPriority(FormID container) { scheduler.UnregisterHighPriority(container); }
+
+void ItemEventBatcher::SetBatchWindow(FormID container, std::int32_t milliseconds) {
+    std::lock_guard<std::mutex> lockGuard(batchWindowsMutex);
+
+    if (milliseconds < 0) {
+        batchWindows.erase(container);
+    } else {
+        batchWindows.insert_or_assign(container, static_cast<std::uint32_t>(milliseconds));
+    }
+
+    haveBatchWindows.store(!batchWindows.empty(), std::memory_order_relaxed);
+}
+
+void ItemEventBatcher::SendItemAddedEvents() {
+    PAPER_PROFILE_SCOPE("ItemEventBatcher.SendItemAddedEvents", "task");
+
+    if (services.sender.IsReady()) {
+        // Process all the item-added events we've batched up
+        std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+
+        if (!SendItemEvents(ItemEventKind::kAdded, batchedItemAddedEventsMap, frameBudgetAddedEvents,
+                            roundRobinCursorAddedEvents)) {
+            // The task stays queued up for the batches that have to wait, but only runs again next frame
+            services.tasks.AddTaskNextFrame([this]() { this->SendItemAddedEvents(); });
+            return;
+        }
+        haveQueuedUpTaskAddedEvents = false;
+    }
+}
+
+void ItemEventBatcher::SendItemRemovedEvents() {
+    PAPER_PROFILE_SCOPE("ItemEventBatcher.SendItemRemovedEvents", "task");
+
+    if (services.sender.IsReady()) {
+        // Process all the item-removed events we've batched up
+        std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
+
+        if (!SendItemEvents(ItemEventKind::kRemoved, batchedItemRemovedEventsMap, frameBudgetRemovedEvents,
+                            roundRobinCursorRemovedEvents)) {
+            // The task stays queued up for the batches that have to wait, but only runs again next frame
+            services.tasks.AddTaskNextFrame([this]() { this->SendItemRemovedEvents(); });
+            return;
+        }
+        haveQueuedUpTaskRemovedEvents = false;
+    }
+}
+
+bool ItemEventBatcher::SendItemEvents(ItemEventKind kind, BatchedItemEventsMap<FormID>& eventsMap,
+                                      FrameBudget& budget, std::uint64_t& roundRobinCursor) {
+    const auto& settings = GetSettings().inventoryEvents;
+    const BatchWindow globalWindow{settings.batchWindowFrames,
+                                   std::chrono::milliseconds(settings.batchWindowMilliseconds)};
+    const auto now = ItemEventBatch::Clock::now();
+
+    readyBatches.clear();
+    std::size_t numWaiting = 0;
+    for (auto& [containerID, batch] : eventsMap) {
+        if (IsBatchReady(batch, GetBatchWindow(containerID, globalWindow), settings.maxBatchSize, now)) {
+            readyBatches.emplace_back(containerID, &batch, scheduler.Classify(containerID));
+        } else {
+            ++numWaiting;
+        }
+    }
+
+    // Out of budget: the containers that come last get their events in a later frame
+    const auto numToSend = ScheduleWithinBudget(budget, roundRobinCursor);
+    numWaiting += readyBatches.size() - numToSend;
+
+    // Everything that needs a lock or allocates runs on this thread: looking up the containers and their
+    // handles, and presizing the payloads, so that the workers below only fill in their own payload
+    if (preparedItemEvents.size() < numToSend) {
+        preparedItemEvents.resize(numToSend);
+    }
+
+    std::size_t numPrepared = 0;
+    std::size_t numEvents = 0;
+    for (std::size_t i = 0; i < numToSend; ++i) {
+        const auto containerID = static_cast<FormID>(readyBatches[i].key);
+        const auto& batch = *readyBatches[i].batch;
+        scheduler.RecordQueueLatency(readyBatches[i].dispatchClass, now - batch.opened);
+
+        CollectItemMovements(containerID, batch.events, kind == ItemEventKind::kRemoved);
+
+        const auto container = services.forms.LookupReference(containerID);
+        if (!container) {
+            continue;
+        }
+
+        const auto handle = services.handles.GetHandleForReference(container);
+        if (!services.handles.IsValidHandle(handle)) {
+            continue;
+        }
+
+        auto& prepared = preparedItemEvents[numPrepared++];
+        prepared.handle = handle;
+        prepared.events = &batch.events;
+        GetTransferReceivers(containerID, prepared.transferReceivers);
+        prepared.payload.clear();
+        prepared.payload.baseItems.resize(batch.events.size());
+        prepared.payload.itemCounts.resize(batch.events.size());
+        prepared.payload.otherContainers.resize(batch.events.size());
+        numEvents += batch.events.size();
+    }
+
+    // The form lookups of large frames are spread over worker threads, one container per work item
+    const auto firstPrepared = preparedItemEvents.begin();
+    const auto lastPrepared = firstPrepared + numPrepared;
+    const auto prepare = [this](PreparedItemEvent& prepared) { this->PreparePayload(prepared); };
+    const auto parallelThreshold = settings.parallelPreparationThreshold;
+    if (parallelThreshold > 0 && numEvents >= parallelThreshold && numPrepared > 1) {
+        PAPER_PROFILE_SCOPE("ItemEventBatcher.PreparePayloadsParallel", "task");
+        std::for_each(std::execution::par, firstPrepared, lastPrepared, prepare);
+    } else {
+        std::for_each(firstPrepared, lastPrepared, prepare);
+    }
+
+    // Only the sends themselves have to happen on this thread
+    for (auto it = firstPrepared; it != lastPrepared; ++it) {
+        if (it->transferReceivers.empty()) {
+            services.sender.SendItemEvent(kind, it->handle, it->payload);
+        } else {
+            SendWithoutTransfers(kind, *it);
+        }
+        it->events = nullptr;
+    }
+
+    // Marks the batches as sent
+    for (std::size_t i = 0; i < numToSend; ++i) {
+        readyBatches[i].batch->events.clear();
+    }
+
+    QueueGlobalItemMovementTask();
+
+    if (numWaiting == 0) {
+        eventsMap.clear();
+        return true;
+    }
+
+    eventsMap.RetainIf([](FormID, const ItemEventBatch& batch) { return !batch.events.empty(); });
+    return false;
+}
+
+void ItemEventBatcher::SendWithoutTransfers(ItemEventKind kind, PreparedItemEvent& prepared) {
+    // All the other objects of the container receive all its events
+    prepared.payload.excludedReceivers = prepared.transferReceivers;
+    services.sender.SendItemEvent(kind, prepared.handle, prepared.payload);
+
+    // The objects registered for item-transferred events only receive what did not come from / go to another
+    // container here
+    auto& payload = itemEventPayload;
+    payload.clear();
+
+    const auto& events = *prepared.events;
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        if (events[i].otherContainer == 0) {
+            payload.baseItems.emplace_back(prepared.payload.baseItems[i]);
+            payload.itemCounts.emplace_back(prepared.payload.itemCounts[i]);
+            payload.otherContainers.emplace_back(prepared.payload.otherContainers[i]);
+        }
+    }
+
+    if (!payload.baseItems.empty()) {
+        payload.receivers = prepared.transferReceivers;
+        services.sender.SendItemEvent(kind, prepared.handle, payload);
+    }
+}
+
+void ItemEventBatcher::PreparePayload(PreparedItemEvent& prepared) const {
+    const auto& events = *prepared.events;
+    auto& payload = prepared.payload;
+
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        payload.baseItems[i] = services.forms.LookupForm(events[i].baseObj);
+        payload.itemCounts[i] = events[i].itemCount;
+        payload.otherContainers[i] = services.forms.LookupReference(events[i].otherContainer);
+    }
+}
+
+void ItemEventBatcher::CollectItemMovements(FormID container, const std::pmr::vector<ItemEvent>& events,
+                                            bool removed) {
+    if (!haveGlobalMovementRegistrations.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(pendingItemMovementsMutex);
+    for (const auto& eventData : events) {
+        pendingItemMovements.emplace_back(container, eventData.otherContainer, eventData.baseObj,
+                                          removed ? -eventData.itemCount : eventData.itemCount);
+    }
+}
+
+void ItemEventBatcher::QueueGlobalItemMovementTask() {
+    {
+        std::lock_guard<std::mutex> lockGuard(pendingItemMovementsMutex);
+        if (pendingItemMovements.empty() || haveQueuedUpTaskGlobalMovements) {
+            return;
+        }
+        haveQueuedUpTaskGlobalMovements = true;
+    }
+
+    services.tasks.AddTask([this]() { this->SendGlobalItemMovementEvents(); });
+}
+
+void ItemEventBatcher::SendGlobalItemMovementEvents() {
+    PAPER_PROFILE_SCOPE("ItemEventBatcher.SendGlobalItemMovementEvents", "task");
+
+    if (!services.sender.IsReady()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(pendingItemMovementsMutex);
+        itemMovementsBeingSent.swap(pendingItemMovements);
+        haveQueuedUpTaskGlobalMovements = false;
+    }
+
+    // Look up all the forms once, no matter how many receivers there are
+    auto& allMovements = globalMovementPayload;
+    allMovements.clear();
+    for (const auto& movement : itemMovementsBeingSent) {
+        allMovements.containers.emplace_back(services.forms.LookupReference(movement.container));
+        allMovements.otherContainers.emplace_back(services.forms.LookupReference(movement.otherContainer));
+        allMovements.baseItems.emplace_back(services.forms.LookupForm(movement.baseObj));
+        allMovements.itemCounts.emplace_back(movement.itemCount);
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+
+        for (const auto& [receiverID, filter] : globalMovementRegistrations) {
+            const auto receiver = services.forms.LookupForm(receiverID);
+            if (!receiver) {
+                continue;
+            }
+
+            const auto handle = services.handles.GetHandleForForm(receiver);
+            if (!services.handles.IsValidHandle(handle)) {
+                continue;
+            }
+
+            if (filter.IsEmpty()) {
+                services.sender.SendItemEvent(ItemEventKind::kGlobalMovement, handle, allMovements);
+                continue;
+            }
+
+            auto& payload = itemEventPayload;
+            payload.clear();
+
+            for (std::size_t i = 0; i < itemMovementsBeingSent.size(); ++i) {
+                if (ItemPassesInventoryFilterLists(itemMovementsBeingSent[i].baseObj, filter.items, filter.itemLists,
+                                                   services.forms)) {
+                    payload.containers.emplace_back(allMovements.containers[i]);
+                    payload.otherContainers.emplace_back(allMovements.otherContainers[i]);
+                    payload.baseItems.emplace_back(allMovements.baseItems[i]);
+                    payload.itemCounts.emplace_back(allMovements.itemCounts[i]);
+                }
+            }
+
+            if (!payload.baseItems.empty()) {
+                services.sender.SendItemEvent(ItemEventKind::kGlobalMovement, handle, payload);
+            } else {
+                PAPER_STATS_COUNT(kContainerChanged, eventsFiltered, 1);
+            }
+        }
+    }
+
+    itemMovementsBeingSent.clear();
+}
+
+void ItemEventBatcher::RegisterForGlobalItemMovement(FormID receiver, GlobalItemMovementFilter filter) {
+    std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+    globalMovementRegistrations.insert_or_assign(receiver, std::move(filter));
+    haveGlobalMovementRegistrations.store(true, std::memory_order_relaxed);
+}
+
+void ItemEventBatcher::UnregisterForGlobalItemMovement(FormID receiver) {
+    std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+    globalMovementRegistrations.erase(receiver);
+    haveGlobalMovementRegistrations.store(!globalMovementRegistrations.empty(), std::memory_order_relaxed);
+}
+
+void ItemEventBatcher::SendItemTransferredEvents() {
+    PAPER_PROFILE_SCOPE("ItemEventBatcher.SendItemTransferredEvents", "task");
+
+    if (!services.sender.IsReady()) {
+        return;
+    }
+
+    // Process all the item-transferred events we've batched up
+    std::lock_guard<std::mutex> lockGuard(batchedItemTransferredEventsMapMutex);
+
+    const auto& settings = GetSettings().inventoryEvents;
+    const BatchWindow globalWindow{settings.batchWindowFrames,
+                                   std::chrono::milliseconds(settings.batchWindowMilliseconds)};
+    const auto now = ItemEventBatch::Clock::now();
+
+    readyBatches.clear();
+    std::size_t numWaiting = 0;
+    for (auto& [transferKey, batch] : batchedItemTransferredEventsMap) {
+        if (IsBatchReady(batch, GetBatchWindow(transferKey, globalWindow), settings.maxBatchSize, now)) {
+            readyBatches.emplace_back(transferKey, &batch,
+                                      scheduler.ClassifyPair(static_cast<FormID>(transferKey >> 32),
+                                                             static_cast<FormID>(transferKey & 0xFFFFFFFF)));
+        } else {
+            ++numWaiting;
+        }
+    }
+
+    // Out of budget: the pairs of containers that come last get their events in a later frame
+    const auto numToSend = ScheduleWithinBudget(frameBudgetTransferredEvents, roundRobinCursorTransferredEvents);
+    numWaiting += readyBatches.size() - numToSend;
+
+    for (std::size_t i = 0; i < numToSend; ++i) {
+        const auto sourceID = static_cast<FormID>(readyBatches[i].key >> 32);
+        const auto destID = static_cast<FormID>(readyBatches[i].key & 0xFFFFFFFF);
+        auto& batch = *readyBatches[i].batch;
+        scheduler.RecordQueueLatency(readyBatches[i].dispatchClass, now - batch.opened);
+
+        // The added / removed maps also have this move, so the global item movements already include it
+        const auto sourceContainer = services.forms.LookupReference(sourceID);
+        const auto destContainer = services.forms.LookupReference(destID);
+
+        const auto sourceHandle = sourceContainer ? services.handles.GetHandleForReference(sourceContainer) : 0;
+        const auto destHandle = destContainer ? services.handles.GetHandleForReference(destContainer) : 0;
+
+        const bool validSourceHandle = services.handles.IsValidHandle(sourceHandle);
+        const bool validDestHandle = services.handles.IsValidHandle(destHandle);
+
+        if (validSourceHandle || validDestHandle) {
+            auto& payload = itemEventPayload;
+            payload.clear();
+
+            for (auto& eventData : batch.events) {
+                payload.baseItems.emplace_back(services.forms.LookupForm(eventData.baseObj));
+                payload.itemCounts.emplace_back(eventData.itemCount);
+            }
+
+            // The same payload is shared by both sides of the transfer, and only goes to the objects of
+            // each side that registered for it
+            payload.sourceContainer = sourceContainer;
+            payload.destContainer = destContainer;
+
+            if (validSourceHandle) {
+                GetTransferReceivers(sourceID, transferReceivers);
+                if (!transferReceivers.empty()) {
+                    payload.receivers = transferReceivers;
+                    services.sender.SendItemEvent(ItemEventKind::kTransferred, sourceHandle, payload);
+                }
+            }
+
+            if (validDestHandle) {
+                GetTransferReceivers(destID, transferReceivers);
+                if (!transferReceivers.empty()) {
+                    payload.receivers = transferReceivers;
+                    services.sender.SendItemEvent(ItemEventKind::kTransferred, destHandle, payload);
+                }
+            }
+        }
+
+        // Marks the batch as sent
+        batch.events.clear();
+    }
+
+    QueueGlobalItemMovementTask();
+
+    if (numWaiting > 0) {
+        batchedItemTransferredEventsMap.RetainIf(
+            [](std::uint64_t, const ItemEventBatch& batch) { return !batch.events.empty(); });
+        services.tasks.AddTaskNextFrame([this]() { this->SendItemTransferredEvents(); });
+        return;
+    }
+
+    haveQueuedUpTaskTransferredEvents = false;
+    batchedItemTransferredEventsMap.clear();
+}
+
+void ItemEventBatcher::RegisterForItemsTransferred(FormID container, VMHandle receiver) {
+    std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+
+    auto& receivers = transferRegistrations[container];
+    if (std::find(receivers.begin(), receivers.end(), receiver) == receivers.end()) {
+        receivers.push_back(receiver);
+    }
+}
+
+void ItemEventBatcher::UnregisterForItemsTransferred(FormID container, VMHandle receiver) {
+    std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+
+    const auto it = transferRegistrations.find(container);
+    if (it == transferRegistrations.end()) {
+        return;
+    }
+
+    std::erase(it->second, receiver);
+    if (it->second.empty()) {
+        transferRegistrations.erase(it);
+    }
+}
+
+bool ItemEventBatcher::IsRegisteredForItemsTransferred(FormID container) const {
+    return transferRegistrations.contains(container);
+}
+
+void ItemEventBatcher::GetTransferReceivers(FormID container, std::vector<VMHandle>& receivers) const {
+    receivers.clear();
+
+    std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+    const auto it = transferRegistrations.find(container);
+    if (it != transferRegistrations.end()) {
+        receivers.assign(it->second.begin(), it->second.end());
+    }
+}
+
+void ItemEventBatcher::Revert() {
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+        batchedItemAddedEventsMap.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
+        batchedItemRemovedEventsMap.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemTransferredEventsMapMutex);
+        batchedItemTransferredEventsMap.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+        transferRegistrations.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+        globalMovementRegistrations.clear();
+        haveGlobalMovementRegistrations.store(false, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(pendingItemMovementsMutex);
+        pendingItemMovements.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchWindowsMutex);
+        batchWindows.clear();
+        haveBatchWindows.store(false, std::memory_order_relaxed);
+    }
+
+    scheduler.Revert();
+
+    loadedItemAddedEvents = false;
+    loadedItemRemovedEvents = false;
+    loadedItemTransferredEvents = false;
+}
+
+void ItemEventBatcher::SaveItemEventsMap(ISerializationInterface& serde, std::uint32_t type,
+                                         const BatchedItemEventsMap<FormID>& eventsMap) {
+    if (!serde.OpenRecord(type, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t mapSize = eventsMap.size();
+    serde.WriteRecordData(mapSize);
+    for (auto& entry : eventsMap) {
+        serde.WriteRecordData(entry.first);
+
+        auto& vec = entry.second.events;
+        std::size_t vecSize = vec.size();
+        serde.WriteRecordData(vecSize);
+
+        for (auto& vectorEntry : vec) {
+            serde.WriteRecordData(vectorEntry.otherContainer);
+            serde.WriteRecordData(vectorEntry.baseObj);
+            serde.WriteRecordData(vectorEntry.itemCount);
+        }
+    }
+}
+
+void ItemEventBatcher::Save(ISerializationInterface& serde) {
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+        SaveItemEventsMap(serde, ItemsAddedRecord, batchedItemAddedEventsMap);
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
+        SaveItemEventsMap(serde, ItemsRemovedRecord, batchedItemRemovedEventsMap);
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchedItemTransferredEventsMapMutex);
+
+        if (!serde.OpenRecord(ItemsTransferredRecord, 0)) {
+            Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+            return;
+        }
+
+        std::size_t itemsTransferredMapSize = batchedItemTransferredEventsMap.size();
+        serde.WriteRecordData(itemsTransferredMapSize);
+        for (auto& entry : batchedItemTransferredEventsMap) {
+            const auto sourceID = static_cast<FormID>(entry.first >> 32);
+            const auto destID = static_cast<FormID>(entry.first & 0xFFFFFFFF);
+            serde.WriteRecordData(sourceID);
+            serde.WriteRecordData(destID);
+
+            auto& vec = entry.second.events;
+            std::size_t vecSize = vec.size();
+            serde.WriteRecordData(vecSize);
+
+            for (auto& vectorEntry : vec) {
+                serde.WriteRecordData(vectorEntry.baseObj);
+                serde.WriteRecordData(vectorEntry.itemCount);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+
+        if (!serde.OpenRecord(TransferRegistrationsRecord, 0)) {
+            Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+            return;
+        }
+
+        std::size_t numRegistrations = transferRegistrations.size();
+        serde.WriteRecordData(numRegistrations);
+        for (const auto& [container, receivers] : transferRegistrations) {
+            serde.WriteRecordData(container);
+
+            std::size_t numReceivers = receivers.size();
+            serde.WriteRecordData(numReceivers);
+            for (const auto receiver : receivers) {
+                serde.WriteRecordData(receiver);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+
+        if (!serde.OpenRecord(GlobalMovementRegistrationsRecord, 0)) {
+            Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+            return;
+        }
+
+        std::size_t numRegistrations = globalMovementRegistrations.size();
+        serde.WriteRecordData(numRegistrations);
+        for (const auto& [receiver, filter] : globalMovementRegistrations) {
+            serde.WriteRecordData(receiver);
+
+            std::size_t numItems = filter.items.size();
+            serde.WriteRecordData(numItems);
+            for (const auto item : filter.items) {
+                serde.WriteRecordData(item);
+            }
+
+            std::size_t numItemLists = filter.itemLists.size();
+            serde.WriteRecordData(numItemLists);
+            for (const auto itemList : filter.itemLists) {
+                serde.WriteRecordData(itemList);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGuard(batchWindowsMutex);
+
+        if (!serde.OpenRecord(BatchWindowsRecord, 0)) {
+            Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+            return;
+        }
+
+        std::size_t numWindows = batchWindows.size();
+        serde.WriteRecordData(numWindows);
+        for (const auto& [container, milliseconds] : batchWindows) {
+            serde.WriteRecordData(container);
+            serde.WriteRecordData(milliseconds);
+        }
+    }
+
+    scheduler.Save(serde);
+}
+
+bool ItemEventBatcher::ResolveLoadedFormID(ISerializationInterface& serde, FormID formID, FormID& newFormID) {
+    if (serde.ResolveFormID(formID, newFormID)) {
+        return true;
+    }
+
+    // Mods being removed can leave thousands of these, so we only warn once per load in FinishLoad
+    Logging::debug(Logging::Category::kCosave, "Form ID {:X} could not be found after loading the save.", formID);
+    ++numUnresolvedFormIDs;
+    return false;
+}
+
+bool ItemEventBatcher::ResolveLoadedHandle(ISerializationInterface& serde, VMHandle handle, VMHandle& newHandle) {
+    FormID newFormID;
+    if (!ResolveLoadedFormID(serde, static_cast<FormID>(handle & 0xFFFFFFFF), newFormID)) {
+        return false;
+    }
+
+    newHandle = (handle & ~VMHandle{0xFFFFFFFF}) | newFormID;
+    return true;
+}
+
+void ItemEventBatcher::LoadItemEventsMap(ISerializationInterface& serde, BatchedItemEventsMap<FormID>& eventsMap) {
+    // First read how many containers follow in this record, so we know how many times to iterate.
+    std::size_t mapSize;
+    serde.ReadRecordData(mapSize);
+
+    // Iterate over the remaining data in the record.
+    for (; mapSize > 0; --mapSize) {
+        FormID keyForm;
+        serde.ReadRecordData(keyForm);
+        FormID newKeyForm;
+        const bool resolvedKeyForm = ResolveLoadedFormID(serde, keyForm, newKeyForm);
+
+        std::size_t vecSize;
+        serde.ReadRecordData(vecSize);
+
+        for (std::size_t i = 0; i < vecSize; ++i) {
+            FormID otherContainerForm;
+            serde.ReadRecordData(otherContainerForm);
+            FormID newOtherContainerForm = 0;
+            if (otherContainerForm != 0) {
+                ResolveLoadedFormID(serde, otherContainerForm, newOtherContainerForm);
+            }
+
+            FormID baseObjForm;
+            serde.ReadRecordData(baseObjForm);
+            FormID newBaseObjForm = 0;
+            const bool resolvedBaseObjForm = ResolveLoadedFormID(serde, baseObjForm, newBaseObjForm);
+
+            std::int32_t itemCount;
+            serde.ReadRecordData(itemCount);
+
+            if (resolvedKeyForm && resolvedBaseObjForm) {
+                eventsMap[newKeyForm].events.emplace_back(newOtherContainerForm, newBaseObjForm, itemCount);
+            }
+        }
+    }
+}
+
+bool ItemEventBatcher::LoadRecord(ISerializationInterface& serde, std::uint32_t type) {
+    if (type == ItemsAddedRecord) {
+        std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+        LoadItemEventsMap(serde, batchedItemAddedEventsMap);
+        loadedItemAddedEvents = !batchedItemAddedEventsMap.empty();
+    } else if (type == ItemsRemovedRecord) {
+        std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
+        LoadItemEventsMap(serde, batchedItemRemovedEventsMap);
+        loadedItemRemovedEvents = !batchedItemRemovedEventsMap.empty();
+    } else if (type == ItemsTransferredRecord) {
+        std::lock_guard<std::mutex> lockGuard(batchedItemTransferredEventsMapMutex);
+
+        // First read how many (source, destination) pairs follow in this record.
+        std::size_t itemsTransferredMapSize;
+        serde.ReadRecordData(itemsTransferredMapSize);
+
+        for (; itemsTransferredMapSize > 0; --itemsTransferredMapSize) {
+            FormID sourceForm;
+            serde.ReadRecordData(sourceForm);
+            FormID newSourceForm = 0;
+            const bool resolvedSourceForm = ResolveLoadedFormID(serde, sourceForm, newSourceForm);
+
+            FormID destForm;
+            serde.ReadRecordData(destForm);
+            FormID newDestForm = 0;
+            const bool resolvedDestForm = ResolveLoadedFormID(serde, destForm, newDestForm);
+
+            std::size_t vecSize;
+            serde.ReadRecordData(vecSize);
+
+            for (std::size_t i = 0; i < vecSize; ++i) {
+                FormID baseObjForm;
+                serde.ReadRecordData(baseObjForm);
+                FormID newBaseObjForm = 0;
+                const bool resolvedBaseObjForm = ResolveLoadedFormID(serde, baseObjForm, newBaseObjForm);
+
+                std::int32_t itemCount;
+                serde.ReadRecordData(itemCount);
+
+                // Only events whose forms all still exist; the IDs of the others are meaningless
+                if (resolvedSourceForm && resolvedDestForm && resolvedBaseObjForm) {
+                    batchedItemTransferredEventsMap[MakeTransferKey(newSourceForm, newDestForm)].events.emplace_back(
+                        newDestForm, newBaseObjForm, itemCount);
+                }
+            }
+        }
+
+        loadedItemTransferredEvents = !batchedItemTransferredEventsMap.empty();
+    } else if (type == TransferRegistrationsRecord) {
+        std::lock_guard<std::mutex> lockGuard(transferRegistrationsMutex);
+
+        std::size_t numRegistrations;
+        serde.ReadRecordData(numRegistrations);
+
+        for (; numRegistrations > 0; --numRegistrations) {
+            FormID containerForm;
+            serde.ReadRecordData(containerForm);
+            FormID newContainerForm = 0;
+            const bool resolvedContainerForm = ResolveLoadedFormID(serde, containerForm, newContainerForm);
+
+            std::size_t numReceivers;
+            serde.ReadRecordData(numReceivers);
+
+            for (; numReceivers > 0; --numReceivers) {
+                VMHandle receiver;
+                serde.ReadRecordData(receiver);
+                VMHandle newReceiver = 0;
+                const bool resolvedReceiver = ResolveLoadedHandle(serde, receiver, newReceiver);
+
+                if (resolvedContainerForm && resolvedReceiver) {
+                    auto& receivers = transferRegistrations[newContainerForm];
+                    if (std::find(receivers.begin(), receivers.end(), newReceiver) == receivers.end()) {
+                        receivers.push_back(newReceiver);
+                    }
+                }
+            }
+        }
+    } else if (type == GlobalMovementRegistrationsRecord) {
+        std::lock_guard<std::mutex> lockGuard(globalMovementRegistrationsMutex);
+
+        std::size_t numRegistrations;
+        serde.ReadRecordData(numRegistrations);
+
+        for (; numRegistrations > 0; --numRegistrations) {
+            FormID receiverForm;
+            serde.ReadRecordData(receiverForm);
+            FormID newReceiverForm;
+            const bool resolvedReceiverForm = ResolveLoadedFormID(serde, receiverForm, newReceiverForm);
+
+            // Forms in the filter that no longer exist are dropped; the rest of the filter still applies
+            GlobalItemMovementFilter filter;
+            bool hadFilter = false;
+            for (auto* formIDs : {&filter.items, &filter.itemLists}) {
+                std::size_t numForms;
+                serde.ReadRecordData(numForms);
+                hadFilter = hadFilter || numForms > 0;
+
+                for (; numForms > 0; --numForms) {
+                    FormID form;
+                    serde.ReadRecordData(form);
+                    FormID newForm;
+                    if (ResolveLoadedFormID(serde, form, newForm)) {
+                        formIDs->push_back(newForm);
+                    }
+                }
+            }
+
+            // A filter that lost all its forms must not turn into one that lets everything through
+            if (resolvedReceiverForm && (!hadFilter || !filter.IsEmpty())) {
+                globalMovementRegistrations.insert_or_assign(newReceiverForm, std::move(filter));
+            }
+        }
+
+        haveGlobalMovementRegistrations.store(!globalMovementRegistrations.empty(), std::memory_order_relaxed);
+    } else if (type == BatchWindowsRecord) {
+        std::lock_guard<std::mutex> lockGuard(batchWindowsMutex);
+
+        std::size_t numWindows;
+        serde.ReadRecordData(numWindows);
+
+        for (; numWindows > 0; --numWindows) {
+            FormID containerForm;
+            serde.ReadRecordData(containerForm);
+            std::uint32_t milliseconds;
+            serde.ReadRecordData(milliseconds);
+
+            FormID newContainerForm;
+            if (ResolveLoadedFormID(serde, containerForm, newContainerForm)) {
+                batchWindows.insert_or_assign(newContainerForm, milliseconds);
+            }
+        }
+
+        haveBatchWindows.store(!batchWindows.empty(), std::memory_order_relaxed);
+    } else {
+        return scheduler.LoadRecord(serde, type);
+    }
+
+    return true;
+}
+
+void ItemEventBatcher::FinishLoad() {
+    if (numUnresolvedFormIDs > 0) {
+        Logging::warn(Logging::Category::kCosave,
+                      "{} form IDs in pending events could not be found after loading the save.", numUnresolvedFormIDs);
+        numUnresolvedFormIDs = 0;
+    }
+
+    if (loadedItemAddedEvents) {
+        loadedItemAddedEvents = false;
+        haveQueuedUpTaskAddedEvents = true;
+        services.tasks.AddTask([this]() { this->SendItemAddedEvents(); });
+    }
+
+    if (loadedItemRemovedEvents) {
+        loadedItemRemovedEvents = false;
+        haveQueuedUpTaskRemovedEvents = true;
+        services.tasks.AddTask([this]() { this->SendItemRemovedEvents(); });
+    }
+
+    if (loadedItemTransferredEvents) {
+        loadedItemTransferredEvents = false;
+        haveQueuedUpTaskTransferredEvents = true;
+        services.tasks.AddTask([this]() { this->SendItemTransferredEvents(); });
+    }
+}
@@ -0,0 +1,66 @@
+#include <Logging.h>
+
+#include <spdlog/async.h>
+#include <spdlog/async_logger.h>
+#include <spdlog/sinks/dup_filter_sink.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <memory>
+
+namespace {
+    constexpr auto NumCategories = static_cast<std::size_t>(Logging::Category::kTotal);
+
+    /** Only written by Initialize, before any other thread logs anything */
+    std::array<std::shared_ptr<spdlog::logger>, NumCategories> categoryLoggers;
+
+    bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+}
+
+void Logging::Initialize(std::vector<spdlog::sink_ptr> sinks, spdlog::level::level_enum level) {
+    // The queue is allocated up front, so logging a message never allocates on the calling thread
+    spdlog::init_thread_pool(QueueSize, 1);
+
+    auto dupFilter = std::make_shared<spdlog::sinks::dup_filter_sink_mt>(DuplicateWindow);
+    dupFilter->set_sinks(std::move(sinks));
+
+    for (std::size_t i = 0; i < NumCategories; ++i) {
+        auto logger = std::make_shared<spdlog::async_logger>(std::string(CategoryNames[i]), dupFilter,
+                                                             spdlog::thread_pool(),
+                                                             spdlog::async_overflow_policy::overrun_oldest);
+        logger->set_level(level);
+        logger->flush_on(spdlog::level::err);
+
+        if (static_cast<Category>(i) == Category::kGeneral) {
+            spdlog::set_default_logger(logger);
+        } else {
+            spdlog::register_logger(logger);
+        }
+        categoryLoggers[i] = std::move(logger);
+    }
+
+    spdlog::flush_every(FlushInterval);
+}
+
+spdlog::logger& Logging::Get(Category category) {
+    const auto& logger = categoryLoggers[static_cast<std::size_t>(category)];
+    return logger ? *logger : *spdlog::default_logger_raw();
+}
+
+bool Logging::SetLevel(std::string_view categoryName, spdlog::level::level_enum level) {
+    bool found = false;
+
+    for (std::size_t i = 0; i < NumCategories; ++i) {
+        if (categoryName.empty() || EqualsIgnoreCase(categoryName, CategoryNames[i])) {
+            Get(static_cast<Category>(i)).set_level(level);
+            found = true;
+        }
+    }
+
+    return found;
+}
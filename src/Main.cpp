@@ -1,7 +1,15 @@
+#include <EventRecorder.h>
+#include <FrameHook.h>
+#include <Logging.h>
 #include <OnContainerChangedEventHandler.h>
 #include <OnEquipEventHandler.h>
 #include <OnHitEventHandler.h>
+#include <OnMagicEffectApplyEventHandler.h>
+#include <OnWarpaintChangedEventHandler.h>
 #include <Papyrus.h>
+#include <SettingsLoader.h>
+#include <TraceRecorder.h>
+#include <VMHandleCache.h>
 
 #include <stddef.h>
 
@@ -22,13 +30,11 @@ namespace {
         *path /= PluginDeclaration::GetSingleton()->GetName();
         *path += L".log";
 
-        std::shared_ptr<spdlog::logger> log;
+        spdlog::sink_ptr sink;
         if (IsDebuggerPresent()) {
-            log = std::make_shared<spdlog::logger>(
-                "Global", std::make_shared<spdlog::sinks::msvc_sink_mt>());
+            sink = std::make_shared<spdlog::sinks::msvc_sink_mt>();
         } else {
-            log = std::make_shared<spdlog::logger>(
-                "Global", std::make_shared<spdlog::sinks::basic_file_sink_mt>(path->string(), true));
+            sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path->string(), true);
         }
 
 #ifndef NDEBUG
@@ -37,11 +43,13 @@ namespace {
         const auto level = spdlog::level::info;
 #endif
 
-        log->set_level(level);
-        log->flush_on(level);
-
-        spdlog::set_default_logger(std::move(log));
+        // Writing happens on a background thread, so logging never stalls the game or the VM
+        Logging::Initialize({std::move(sink)}, level);
         spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%t] [%s:%#] %v");
+
+        // Trace files and event logs go next to the log file
+        Tracing::TraceRecorder::GetSingleton().SetOutputDirectory(path->parent_path());
+        Recording::EventRecorder::GetSingleton().SetOutputDirectory(path->parent_path());
     }
 
    /**
@@ -49,13 +57,17 @@ namespace {
     * sent by the game engine.
     */
     void InitializeEventSink() {
-        log::trace("Initializing event sink...");
+        Logging::trace(Logging::Category::kGeneral, "Initializing event sink...");
         auto scriptEventSource = RE::ScriptEventSourceHolder::GetSingleton();
         if (scriptEventSource) {
             scriptEventSource->AddEventSink(&OnEquipEvents::OnEquipEventHandler::GetSingleton());
+            scriptEventSource->AddEventSink(&OnEquipEvents::CellAttachEventHandler::GetSingleton());
             scriptEventSource->AddEventSink(&OnHitEvents::OnHitEventHandler::GetSingleton());
+            scriptEventSource->AddEventSink(&OnMagicEffectApplyEvents::OnMagicEffectApplyEventHandler::GetSingleton());
             scriptEventSource->AddEventSink(&OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton());
-            log::trace("Event sink initialized.");
+            scriptEventSource->AddEventSink<RE::TESSwitchRaceCompleteEvent>(
+                &OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::GetSingleton());
+            Logging::trace(Logging::Category::kGeneral, "Event sink initialized.");
         } else {
             stl::report_and_fail("Failed to initialize event sink.");
         }
@@ -65,25 +77,108 @@ namespace {
      * Register new Papyrus functions.
      */
     void InitializePapyrus() { 
-        log::trace("Initializing Papyrus bindings...");
+        Logging::trace(Logging::Category::kGeneral, "Initializing Papyrus bindings...");
         if (GetPapyrusInterface()->Register(PAPER::Bind)) {
-            log::debug("Papyrus functions bound.");
+            Logging::debug(Logging::Category::kGeneral, "Papyrus functions bound.");
         } else {
             stl::report_and_fail("Failure to register Papyrus bindings.");
         }
     }
 
+    /**
+     * Handle messages sent by SKSE.
+     */
+    void OnSKSEMessage(MessagingInterface::Message* message) {
+        if (message->type == MessagingInterface::kDataLoaded) {
+            VMHandles::VMHandleCache::InstallHooks();
+            FrameHook::Install();
+            OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::InstallHooks();
+
+            // The UI only exists once the data is loaded
+            if (const auto ui = RE::UI::GetSingleton()) {
+                ui->AddEventSink<RE::MenuOpenCloseEvent>(
+                    &OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::GetSingleton());
+            }
+        } else if (message->type == MessagingInterface::kPreLoadGame) {
+            OnEquipEvents::OnPreLoadGame();
+        } else if (message->type == MessagingInterface::kPostLoadGame) {
+            OnEquipEvents::OnPostLoadGame();
+        }
+    }
+
+    /**
+     * Initialize the listener for messages sent by SKSE.
+     */
+    void InitializeMessaging() {
+        Logging::trace(Logging::Category::kGeneral, "Initializing SKSE message listener...");
+        if (GetMessagingInterface()->RegisterListener(OnSKSEMessage)) {
+            Logging::trace(Logging::Category::kGeneral, "SKSE message listener initialized.");
+        } else {
+            stl::report_and_fail("Failed to register SKSE message listener.");
+        }
+    }
+
+    /**
+     * The serialization handler for reverting game state, forwarded to everything
+     * that holds state tied to the current game.
+     */
+    void OnRevert(SerializationInterface* serde) {
+        PAPER_TRACE_SCOPE("Cosave.Revert", "cosave");
+        OnContainerChangedEvents::OnContainerChangedEventHandler::OnRevert(serde);
+        OnMagicEffectApplyEvents::OnRevert(serde);
+        OnEquipEvents::OnRevert(serde);
+        OnHitEvents::OnRevert(serde);
+        OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::OnRevert(serde);
+        VMHandles::VMHandleCache::OnRevert(serde);
+    }
+
+    /**
+     * The serialization handler for saving data to the cosave. SKSE only supports a single save
+     * callback, so we forward it to everything that persists data in the cosave.
+     */
+    void OnGameSaved(SerializationInterface* serde) {
+        OnContainerChangedEvents::OnContainerChangedEventHandler::OnGameSaved(serde);
+        OnMagicEffectApplyEvents::OnGameSaved(serde);
+        OnEquipEvents::OnGameSaved(serde);
+        OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::OnGameSaved(serde);
+    }
+
+    /**
+     * The serialization handler for loading data from the cosave. SKSE only supports a single load
+     * callback, so we offer every record to everything that persists data in the cosave.
+     */
+    void OnGameLoaded(SerializationInterface* serde) {
+        PAPER_TRACE_SCOPE("Cosave.Load", "cosave");
+
+        std::uint32_t type;
+        std::uint32_t size;
+        std::uint32_t version;
+
+        while (serde->GetNextRecordInfo(type, version, size)) {
+            if (OnContainerChangedEvents::OnContainerChangedEventHandler::OnRecordLoaded(serde, type) ||
+                OnMagicEffectApplyEvents::OnRecordLoaded(serde, type, size) ||
+                OnEquipEvents::OnRecordLoaded(serde, type) ||
+                OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::OnRecordLoaded(serde, type)) {
+                continue;
+            }
+
+            Logging::warn(Logging::Category::kCosave, "Unknown record type {:X} in cosave.", type);
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::OnGameLoaded();
+    }
+
     /**
      * Initialize serialization.
      */
     void InitializeSerialization() {
-        log::trace("Initializing cosave serialization...");
+        Logging::trace(Logging::Category::kGeneral, "Initializing cosave serialization...");
         auto* serde = GetSerializationInterface();
         serde->SetUniqueID(_byteswap_ulong('BPAP'));
-        serde->SetSaveCallback(OnContainerChangedEvents::OnContainerChangedEventHandler::OnGameSaved);
-        serde->SetRevertCallback(OnContainerChangedEvents::OnContainerChangedEventHandler::OnRevert);
-        serde->SetLoadCallback(OnContainerChangedEvents::OnContainerChangedEventHandler::OnGameLoaded);
-        log::trace("Cosave serialization initialized.");
+        serde->SetSaveCallback(OnGameSaved);
+        serde->SetRevertCallback(OnRevert);
+        serde->SetLoadCallback(OnGameLoaded);
+        Logging::trace(Logging::Category::kGeneral, "Cosave serialization initialized.");
     }
 
 }
@@ -96,13 +191,16 @@ SKSEPluginLoad(const LoadInterface* skse) {
 
     auto* plugin = PluginDeclaration::GetSingleton();
     auto version = plugin->GetVersion();
-    log::info("{} {} is loading...", plugin->GetName(), version);
+    Logging::info(Logging::Category::kGeneral, "{} {} is loading...", plugin->GetName(), version);
+
+    SettingsLoader::Load();
 
     Init(skse);
+    InitializeMessaging();
     InitializeEventSink();
     InitializeSerialization();
     InitializePapyrus();
 
-    log::info("{} has finished loading.", plugin->GetName());
+    Logging::info(Logging::Category::kGeneral, "{} has finished loading.", plugin->GetName());
     return true;
 }
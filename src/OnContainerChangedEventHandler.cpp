@@ -1,15 +1,18 @@
 #include <OnContainerChangedEventHandler.h>
+#include <EventRecorder.h>
+#include <EventTargets.h>
+#include <InventoryEventFilter.h>
+#include <Profiling.h>
+#include <Settings.h>
 #include <SKSE/SKSE.h>
 
 using namespace OnContainerChangedEvents;
 
 static RE::BSFixedString OnBatchItemsAddedEventName = "OnBatchItemsAdded";
 static RE::BSFixedString OnBatchItemsRemovedEventName = "OnBatchItemsRemoved";
-
-namespace {
-    inline const auto ItemsAddedRecord = _byteswap_ulong('IAEV');
-    inline const auto ItemsRemovedRecord = _byteswap_ulong('IREV');
-}
+static RE::BSFixedString OnBatchItemsTransferredEventName = "OnBatchItemsTransferred";
+static RE::BSFixedString OnGlobalItemMovementEventName = "OnGlobalItemMovement";
+static RE::BSFixedString OnItemCountThresholdCrossedEventName = "OnItemCountThresholdCrossed";
 
 
 OnContainerChangedEventHandler& OnContainerChangedEventHandler::GetSingleton() noexcept {
@@ -20,329 +23,208 @@ OnContainerChangedEventHandler& OnContainerChangedEventHandler::GetSingleton() n
 RE::BSEventNotifyControl OnContainerChangedEventHandler::ProcessEvent(
     const RE::TESContainerChangedEvent* a_event, RE::BSTEventSource<RE::TESContainerChangedEvent>* a_eventSource) {
 
-    if (a_event) {
-        if (a_event->baseObj > 0) {
-            if (a_event->oldContainer > 0) {
-                {
-                    std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
-
-                    batchedItemRemovedEventsMap[a_event->oldContainer].emplace_back(a_event->newContainer,
-                                                                                    a_event->baseObj, a_event->itemCount);
-                }
-
-                if (!haveQueuedUpTaskRemovedEvents) {
-                    haveQueuedUpTaskRemovedEvents = true;
-                    SKSE::GetTaskInterface()->AddTask([this]() { this->SendItemRemovedEvents(); });
-                }
-            }
+    PAPER_PROFILE_SCOPE("ContainerChanged.ProcessEvent", "sink");
 
-            if (a_event->newContainer > 0) {
-                {
-                    std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
+    auto& recorder = Recording::EventRecorder::GetSingleton();
+    if (a_event && recorder.IsRecording()) {
+        recorder.RecordContainerChanged(a_event->oldContainer, a_event->newContainer, a_event->baseObj,
+                                        a_event->itemCount);
+    }
 
-                    batchedItemAddedEventsMap[a_event->newContainer].emplace_back(
-                        a_event->oldContainer, a_event->baseObj, a_event->itemCount);
-                }
+    if (a_event) {
+        // Counts must stay correct even while the batched inventory events are disabled
+        itemCountWatcher.RecordEvent(a_event->oldContainer, a_event->newContainer, a_event->baseObj,
+                                     a_event->itemCount);
+    }
 
-                if (!haveQueuedUpTaskAddedEvents) {
-                    haveQueuedUpTaskAddedEvents = true;
-                    SKSE::GetTaskInterface()->AddTask([this]() { this->SendItemAddedEvents(); });
-                }
-            }
-        }
+    if (a_event && Core::GetSettings().inventoryEvents.enabled) {
+        PAPER_STATS_COUNT(kContainerChanged, eventsSeen, 1);
+        batcher.RecordEvent(a_event->oldContainer, a_event->newContainer, a_event->baseObj, a_event->itemCount);
     }
 
     // Let other code process the same event next
     return RE::BSEventNotifyControl::kContinue;
 }
 
-void OnContainerChangedEventHandler::SendItemAddedEvents() {
-    auto vm = RE::SkyrimVM::GetSingleton();
+void OnContainerChangedEventHandler::RegisterForItemsTransferred(RE::FormID container, RE::VMHandle receiver) {
+    batcher.RegisterForItemsTransferred(container, receiver);
+}
 
-    if (vm) {
-        // Process all the item-added events we've batched up
-        {
-            std::lock_guard<std::mutex> lockGuard(batchedItemAddedEventsMapMutex);
-
-            for (auto& entry : batchedItemAddedEventsMap) {
-                auto newContainer = RE::TESForm::LookupByID<RE::TESObjectREFR>(entry.first);
-
-                if (newContainer) {
-                    const auto handle = vm->handlePolicy.GetHandleForObject(
-                        static_cast<RE::VMTypeID>(RE::FormType::Reference), newContainer);
-
-                    if (handle && handle != vm->handlePolicy.EmptyHandle()) {
-                        std::vector<RE::TESForm*> baseItems;
-                        std::vector<std::int32_t> itemCounts;
-                        std::vector<RE::TESObjectREFR*> sourceContainers;
-
-                        for (auto& eventData : entry.second) {
-                            baseItems.emplace_back(RE::TESForm::LookupByID(eventData.baseObj));
-                            itemCounts.emplace_back(eventData.itemCount);
-                            sourceContainers.emplace_back(
-                                RE::TESForm::LookupByID<RE::TESObjectREFR>(eventData.otherContainer));
-                        }
-
-                        auto filter = std::make_unique<ItemEventsFilter>(baseItems);
-                        auto eventArgs = RE::MakeFunctionArguments(std::move(baseItems), std::move(itemCounts),
-                                                                   std::move(sourceContainers));
-
-                        vm->SendAndRelayEvent(handle, &OnBatchItemsAddedEventName, eventArgs, filter.get());
-                    }
-                }
-            }
+void OnContainerChangedEventHandler::UnregisterForItemsTransferred(RE::FormID container, RE::VMHandle receiver) {
+    batcher.UnregisterForItemsTransferred(container, receiver);
+}
 
-            haveQueuedUpTaskAddedEvents = false;
-            batchedItemAddedEventsMap.clear();
-        }
-    }
+void OnContainerChangedEventHandler::RegisterForGlobalItemMovement(RE::FormID receiver,
+                                                                   Core::GlobalItemMovementFilter filter) {
+    batcher.RegisterForGlobalItemMovement(receiver, std::move(filter));
 }
 
-void OnContainerChangedEventHandler::SendItemRemovedEvents() {
-    auto vm = RE::SkyrimVM::GetSingleton();
+void OnContainerChangedEventHandler::RegisterHighPriority(RE::FormID container) {
+    batcher.RegisterHighPriority(container);
+}
 
-    if (vm) {
-        // Process all the item-removed events we've batched up
-        {
-            std::lock_guard<std::mutex> lockGuard(batchedItemRemovedEventsMapMutex);
-
-            for (auto& entry : batchedItemRemovedEventsMap) {
-                auto oldContainer = RE::TESForm::LookupByID<RE::TESObjectREFR>(entry.first);
-
-                if (oldContainer) {
-                    const auto handle = vm->handlePolicy.GetHandleForObject(
-                        static_cast<RE::VMTypeID>(RE::FormType::Reference), oldContainer);
-
-                    std::vector<RE::TESForm*> baseItems;
-                    std::vector<std::int32_t> itemCounts;
-                    std::vector<RE::TESObjectREFR*> destContainers;
-
-                    for (auto& eventData : entry.second) {
-                        baseItems.emplace_back(RE::TESForm::LookupByID(eventData.baseObj));
-                        itemCounts.emplace_back(eventData.itemCount);
-                        destContainers.emplace_back(
-                            RE::TESForm::LookupByID<RE::TESObjectREFR>(eventData.otherContainer));
-                    }
-
-                    auto filter = std::make_unique<ItemEventsFilter>(baseItems);
-                    auto eventArgs = RE::MakeFunctionArguments(std::move(baseItems), std::move(itemCounts),
-                                                               std::move(destContainers));
-                    
-                    vm->SendAndRelayEvent(handle, &OnBatchItemsRemovedEventName, eventArgs, filter.get());
-                }
-            }
+void OnContainerChangedEventHandler::UnregisterHighPriority(RE::FormID container) {
+    batcher.UnregisterHighPriority(container);
+}
 
-            haveQueuedUpTaskRemovedEvents = false;
-            batchedItemRemovedEventsMap.clear();
-        }
-    }
+void OnContainerChangedEventHandler::SetBatchWindow(RE::FormID container, std::int32_t milliseconds) {
+    batcher.SetBatchWindow(container, milliseconds);
 }
 
-bool OnContainerChangedEventHandler::ItemPassesInventoryFilterLists(
-    const RE::FormID itemID, const RE::SkyrimVM::InventoryEventFilterLists* filterLists) {
+void OnContainerChangedEventHandler::UnregisterForGlobalItemMovement(RE::FormID receiver) {
+    batcher.UnregisterForGlobalItemMovement(receiver);
+}
 
-    if (!filterLists) {
-        return true;
-    }
+void OnContainerChangedEventHandler::WatchItemCount(RE::FormID container, RE::FormID item, std::int32_t threshold) {
+    itemCountWatcher.Watch(container, item, threshold);
+}
 
-    for (auto it = filterLists->itemsForFiltering.begin(); it != filterLists->itemsForFiltering.end(); ++it) {
-        if ((*it) == itemID) {
-            return true;
-        }
+void OnContainerChangedEventHandler::UnwatchItemCount(RE::FormID container, RE::FormID item,
+                                                      std::int32_t threshold) {
+    itemCountWatcher.Unwatch(container, item, threshold);
+}
+
+bool SkyrimItemEventSender::IsReady() const { return RE::SkyrimVM::GetSingleton() != nullptr; }
+
+void SkyrimItemEventSender::SendItemEvent(Core::ItemEventKind kind, Core::VMHandle handle,
+                                          const Core::ItemEventPayload& payload) {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm) {
+        return;
     }
 
-    for (auto it = filterLists->itemListsForFiltering.begin(); it != filterLists->itemListsForFiltering.end(); ++it) {
-        auto formList = RE::TESForm::LookupByID<RE::BGSListForm>(*it);
-        if (!formList) {
-            logger::error("Expected form to be FormList: {}", *it);
-            continue;
+    itemEventsFilter.baseItems = payload.baseItems;
+    itemEventsFilter.receivers = payload.receivers;
+    itemEventsFilter.excludedReceivers = payload.excludedReceivers;
+    PAPER_STATS_COUNT(kContainerChanged, eventsDispatched, 1);
+
+    switch (kind) {
+        case Core::ItemEventKind::kAdded: {
+            itemEventArguments.payload = &payload;
+            EventTargets::TargetedEventFilter filter(OnBatchItemsAddedEventName, &itemEventsFilter);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &OnBatchItemsAddedEventName, &itemEventArguments, &filter);
+            break;
         }
-
-        if (formList->HasForm(itemID)) {
-            return true;
+        case Core::ItemEventKind::kRemoved: {
+            itemEventArguments.payload = &payload;
+            EventTargets::TargetedEventFilter filter(OnBatchItemsRemovedEventName, &itemEventsFilter);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &OnBatchItemsRemovedEventName, &itemEventArguments, &filter);
+            break;
+        }
+        case Core::ItemEventKind::kTransferred: {
+            itemTransferEventArguments.payload = &payload;
+            EventTargets::TargetedEventFilter filter(OnBatchItemsTransferredEventName, &itemEventsFilter);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &OnBatchItemsTransferredEventName, &itemTransferEventArguments, &filter);
+            break;
+        }
+        case Core::ItemEventKind::kGlobalMovement: {
+            // Receivers are not references, so they have no inventory event filters; the batcher
+            // already applied the filter that they registered with
+            globalItemMovementEventArguments.payload = &payload;
+            EventTargets::TargetedEventFilter filter(OnGlobalItemMovementEventName);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &OnGlobalItemMovementEventName, &globalItemMovementEventArguments,
+                                  &filter);
+            break;
         }
     }
-
-    return false;
 }
 
-void OnContainerChangedEventHandler::OnRevert(SKSE::SerializationInterface*) {
-    auto& singleton = GetSingleton();
-
-    { 
-        std::lock_guard<std::mutex> lockGuard(singleton.batchedItemAddedEventsMapMutex); 
-        singleton.batchedItemAddedEventsMap.clear();
+void SkyrimItemEventSender::SendItemCountEvent(Core::VMHandle handle, RE::TESForm* baseItem, std::int32_t threshold,
+                                               std::int32_t itemCount) {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm) {
+        return;
     }
 
-    {
-        std::lock_guard<std::mutex> lockGuard(singleton.batchedItemRemovedEventsMapMutex);
-        singleton.batchedItemRemovedEventsMap.clear();
-    }
-}
+    PAPER_STATS_COUNT(kContainerChanged, eventsDispatched, 1);
+    PAPER_STATS_COUNT(kContainerChanged, variablesPacked, 3);
 
-void OnContainerChangedEventHandler::OnGameLoaded(SKSE::SerializationInterface* serde) {
-    std::uint32_t type;
-    std::uint32_t size;
-    std::uint32_t version;
-
-    auto& singleton = GetSingleton();
-    
-    bool shouldQueueItemAddedEventsTask = false;
-    bool shouldQueueItemRemovedEventsTask = false;
-
-    { 
-        std::lock_guard<std::mutex> lockGuardItemsAdded(singleton.batchedItemAddedEventsMapMutex); 
-        std::lock_guard<std::mutex> lockGuardItemsRemoved(singleton.batchedItemRemovedEventsMapMutex);
-
-        while (serde->GetNextRecordInfo(type, version, size)) {
-            if (type == ItemsAddedRecord) {
-                // First read how many items follow in this record, so we know how many times to iterate.
-                std::size_t itemsAddedMapSize;
-                serde->ReadRecordData(&itemsAddedMapSize, sizeof(itemsAddedMapSize));
-
-                shouldQueueItemAddedEventsTask = (itemsAddedMapSize > 0);
-
-                // Iterate over the remaining data in the record.
-                for (; itemsAddedMapSize > 0; --itemsAddedMapSize) {
-                    RE::FormID keyForm;
-                    serde->ReadRecordData(&keyForm, sizeof(keyForm));
-                    RE::FormID newKeyForm;
-                    if (!serde->ResolveFormID(keyForm, newKeyForm)) {
-                        logger::warn("Form ID {:X} could not be found after loading the save.", keyForm);
-                    }
-
-                    size_t vecSize;
-                    serde->ReadRecordData(&vecSize, sizeof(vecSize));
-
-                    for (int i = 0; i < vecSize; ++i) {
-                        RE::FormID otherContainerForm;
-                        serde->ReadRecordData(&otherContainerForm, sizeof(otherContainerForm));
-                        RE::FormID newOtherContainerForm;
-                        if (!serde->ResolveFormID(otherContainerForm, newOtherContainerForm)) {
-                            logger::warn("Form ID {:X} could not be found after loading the save.", otherContainerForm);
-                        }
-
-                        RE::FormID baseObjForm;
-                        serde->ReadRecordData(&baseObjForm, sizeof(baseObjForm));
-                        RE::FormID newBaseObjForm;
-                        if (!serde->ResolveFormID(baseObjForm, newBaseObjForm)) {
-                            logger::warn("Form ID {:X} could not be found after loading the save.", baseObjForm);
-                        }
-
-                        std::int32_t itemCount;
-                        serde->ReadRecordData(&itemCount, sizeof(itemCount));
-
-                        singleton.batchedItemAddedEventsMap[keyForm].emplace_back(otherContainerForm, baseObjForm,
-                                                                                  itemCount);
-                    }
-                }
-            } else if (type == ItemsRemovedRecord) {
-                // First read how many items follow in this record, so we know how many times to iterate.
-                std::size_t itemsRemovedMapSize;
-                serde->ReadRecordData(&itemsRemovedMapSize, sizeof(itemsRemovedMapSize));
-
-                shouldQueueItemRemovedEventsTask = (itemsRemovedMapSize > 0);
-
-                // Iterate over the remaining data in the record.
-                for (; itemsRemovedMapSize > 0; --itemsRemovedMapSize) {
-                    RE::FormID keyForm;
-                    serde->ReadRecordData(&keyForm, sizeof(keyForm));
-                    RE::FormID newKeyForm;
-                    if (!serde->ResolveFormID(keyForm, newKeyForm)) {
-                        logger::warn("Form ID {:X} could not be found after loading the save.", keyForm);
-                    }
-
-                    size_t vecSize;
-                    serde->ReadRecordData(&vecSize, sizeof(vecSize));
-
-                    for (int i = 0; i < vecSize; ++i) {
-                        RE::FormID otherContainerForm;
-                        serde->ReadRecordData(&otherContainerForm, sizeof(otherContainerForm));
-                        RE::FormID newOtherContainerForm;
-                        if (!serde->ResolveFormID(otherContainerForm, newOtherContainerForm)) {
-                            logger::warn("Form ID {:X} could not be found after loading the save.", otherContainerForm);
-                        }
-
-                        RE::FormID baseObjForm;
-                        serde->ReadRecordData(&baseObjForm, sizeof(baseObjForm));
-                        RE::FormID newBaseObjForm;
-                        if (!serde->ResolveFormID(baseObjForm, newBaseObjForm)) {
-                            logger::warn("Form ID {:X} could not be found after loading the save.", baseObjForm);
-                        }
-
-                        std::int32_t itemCount;
-                        serde->ReadRecordData(&itemCount, sizeof(itemCount));
-
-                        singleton.batchedItemRemovedEventsMap[keyForm].emplace_back(otherContainerForm, baseObjForm,
-                                                                                    itemCount);
-                    }
-                }
-            } else {
-                logger::warn("Unknown record type in cosave.");
-                __assume(false);
-            }
-        }
-    }
+    auto eventArgs = RE::MakeFunctionArguments(std::move(baseItem), std::move(threshold), std::move(itemCount));
+    EventTargets::TargetedEventFilter filter(OnItemCountThresholdCrossedEventName);
+    PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+    vm->SendAndRelayEvent(handle, &OnItemCountThresholdCrossedEventName, eventArgs, &filter);
+}
 
-    if (shouldQueueItemAddedEventsTask) {
-        SKSE::GetTaskInterface()->AddTask([&singleton]() { singleton.SendItemAddedEvents(); });
+bool ItemEventsFilter::matchesFilter(RE::VMHandle handle) {
+    // Objects registered for item-transferred events get those instead of some of the other events
+    if (!receivers.empty() && std::find(receivers.begin(), receivers.end(), handle) == receivers.end()) {
+        return false;
     }
 
-    if (shouldQueueItemRemovedEventsTask) {
-        SKSE::GetTaskInterface()->AddTask([&singleton]() { singleton.SendItemRemovedEvents(); });
+    if (std::find(excludedReceivers.begin(), excludedReceivers.end(), handle) != excludedReceivers.end()) {
+        return false;
     }
-}
 
-void OnContainerChangedEventHandler::OnGameSaved(SKSE::SerializationInterface* serde) {
-    auto& singleton = GetSingleton();
+    auto vm = RE::SkyrimVM::GetSingleton();
 
-    { 
-        std::lock_guard<std::mutex> lockGuard(singleton.batchedItemAddedEventsMapMutex); 
+    //const auto& constInventoryEventFilterMapLock =
+    //    GetManualRelocateMemberVariable<RE::BSSpinLock>(vm, REL::VariantOffset(0x8940, 0x8940, 0x8960));
 
-        if (!serde->OpenRecord(ItemsAddedRecord, 0)) {
-            logger::error("Unable to open record to write cosave data.");
-            return;
-        }
+    //auto& inventoryEventFilterMapLock = const_cast<RE::BSSpinLock&>(constInventoryEventFilterMapLock);
+    //RE::BSSpinLockGuard locker(inventoryEventFilterMapLock);
 
-        auto itemsAddedMapSize = singleton.batchedItemAddedEventsMap.size();
-        serde->WriteRecordData(&itemsAddedMapSize, sizeof(itemsAddedMapSize));
-        for (auto& entry : singleton.batchedItemAddedEventsMap) {
-            serde->WriteRecordData(&entry.first, sizeof(entry.first));
+    const auto& inventoryEventFilterMap =
+        GetManualRelocateMemberVariable<RE::BSTHashMap<RE::VMHandle, RE::SkyrimVM::InventoryEventFilterLists*>>(
+            vm, REL::VariantOffset(0x8948, 0x8948, 0x8968));
 
-            auto& vec = entry.second;
-            auto vecSize = vec.size();
-            serde->WriteRecordData(&vecSize, sizeof(vecSize));
+    RE::SkyrimVM::InventoryEventFilterLists* filterLists = nullptr;
+    auto it = inventoryEventFilterMap.find(handle);
+    if (it != inventoryEventFilterMap.end()) {
+        filterLists = it->second;
+    }
 
-            for (auto& vectorEntry : vec) {
-                serde->WriteRecordData(&(vectorEntry.otherContainer), sizeof(vectorEntry.otherContainer));
-                serde->WriteRecordData(&(vectorEntry.baseObj), sizeof(vectorEntry.baseObj));
-                serde->WriteRecordData(&(vectorEntry.itemCount), sizeof(vectorEntry.itemCount));
+    if (filterLists) {
+        // Have filters, so need at least one of our items to match
+        for (auto baseObj : baseItems) {
+            if (baseObj &&
+                OnContainerChangedEventHandler::ItemPassesInventoryFilterLists(baseObj->formID, filterLists)) {
+                return true;
             }
         }
+    } else {
+        // No filters, so anything matches
+        return true;
     }
 
-    {
-        std::lock_guard<std::mutex> lockGuard(singleton.batchedItemRemovedEventsMapMutex);
+    // Have filters but none matched, so return false
+    PAPER_STATS_COUNT(kContainerChanged, eventsFiltered, 1);
+    return false;
+}
 
-        if (!serde->OpenRecord(ItemsRemovedRecord, 0)) {
-            logger::error("Unable to open record to write cosave data.");
-            return;
-        }
+bool OnContainerChangedEventHandler::ItemPassesInventoryFilterLists(
+    const RE::FormID itemID, const RE::SkyrimVM::InventoryEventFilterLists* filterLists) {
 
-        auto itemsRemovedMapSize = singleton.batchedItemRemovedEventsMap.size();
-        serde->WriteRecordData(&itemsRemovedMapSize, sizeof(itemsRemovedMapSize));
-        for (auto& entry : singleton.batchedItemRemovedEventsMap) {
-            serde->WriteRecordData(&entry.first, sizeof(entry.first));
-            
-            auto& vec = entry.second;
-            auto vecSize = vec.size();
-            serde->WriteRecordData(&vecSize, sizeof(vecSize));
-
-            for (auto& vectorEntry : vec) {
-                serde->WriteRecordData(&(vectorEntry.otherContainer), sizeof(vectorEntry.otherContainer));
-                serde->WriteRecordData(&(vectorEntry.baseObj), sizeof(vectorEntry.baseObj));
-                serde->WriteRecordData(&(vectorEntry.itemCount), sizeof(vectorEntry.itemCount));
-            }
-        }
+    if (!filterLists) {
+        return true;
     }
+
+    return Core::ItemPassesInventoryFilterLists(itemID, filterLists->itemsForFiltering,
+                                                filterLists->itemListsForFiltering, GetSingleton().forms);
+}
+
+void OnContainerChangedEventHandler::OnRevert(SKSE::SerializationInterface*) {
+    GetSingleton().batcher.Revert();
+    GetSingleton().itemCountWatcher.Revert();
+}
+
+void OnContainerChangedEventHandler::OnGameSaved(SKSE::SerializationInterface* serde) {
+    PAPER_TRACE_SCOPE("ContainerChanged.Save", "cosave");
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    GetSingleton().batcher.Save(serialization);
+    GetSingleton().itemCountWatcher.Save(serialization);
+}
+
+bool OnContainerChangedEventHandler::OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type) {
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    return GetSingleton().batcher.LoadRecord(serialization, type) ||
+           GetSingleton().itemCountWatcher.LoadRecord(serialization, type);
+}
+
+void OnContainerChangedEventHandler::OnGameLoaded() {
+    GetSingleton().batcher.FinishLoad();
+    GetSingleton().itemCountWatcher.FinishLoad();
 }
@@ -1,66 +1,217 @@
-#include <SKSE/SKSE.h>
 #include <OnEquipEventHandler.h>
+#include <EngineAdapters.h>
+#include <FrameHook.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 using namespace RE;
 using namespace OnEquipEvents;
-using namespace SKSE;
 
 static BSFixedString OnSpellEquippedEventName = "OnSpellEquipped";
 static BSFixedString OnSpellUnequippedEventName = "OnSpellUnequipped";
 static BSFixedString OnShoutEquippedEventName = "OnShoutEquipped";
 static BSFixedString OnShoutUnequippedEventName = "OnShoutUnequipped";
+static BSFixedString OnEquippedMagicChangedEventName = "OnEquippedMagicChanged";
 
-OnEquipEventHandler& OnEquipEventHandler::GetSingleton() noexcept {
-    static OnEquipEventHandler instance;
-    return instance;
+/** Is there a task that advances the suppression windows every frame? */
+static std::atomic<bool> advancingSuppressionWindows = false;
+
+template <class Emit>
+void EquipEventDefinition::Project(const Event& event, Emit&& emit) {
+    const auto actor = event.actor.get();
+    const auto equippedForm = RE::TESForm::LookupByID(event.baseObject);
+    if (!actor || !equippedForm) {
+        return;
+    }
+
+    auto equippedFormType = equippedForm->GetFormType();
+    if (equippedFormType != RE::FormType::Spell && equippedFormType != RE::FormType::Shout) {
+        return;
+    }
+
+    // During suppression windows, events are held back and only the real changes are sent once they close
+    if (Core::GetSettings().equipEvents.suppressLoadStorms &&
+        !equipStates.RecordEquip(actor->formID, event.baseObject, event.equipped)) {
+        return;
+    }
+
+    if (equippedFormType == RE::FormType::Spell) {
+        const auto spell = equippedForm->As<RE::SpellItem>();
+
+        // Send OnSpellEquipped or OnSpellUnequipped event
+        emit(actor, event.equipped ? OnSpellEquippedEventName : OnSpellUnequippedEventName, (SpellItem*)spell,
+             (TESObjectREFR*)actor);
+    } else if (equippedFormType == RE::FormType::Shout) {
+        const auto shout = equippedForm->As<RE::TESShout>();
+
+        // Send OnShoutEquipped or OnShoutUnequipped event
+        emit(actor, event.equipped ? OnShoutEquippedEventName : OnShoutUnequippedEventName, (TESShout*)shout,
+             (TESObjectREFR*)actor);
+    }
+}
+
+void EquipEventDefinition::Observe(const Event& event) {
+    const auto actor = event.actor.get();
+    if (!actor) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(equippedMagicMutex);
+    equippedMagic.erase(actor->formID);
 }
 
-RE::BSEventNotifyControl OnEquipEventHandler::ProcessEvent(const RE::TESEquipEvent* a_event,
-                                                           RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource) {
-
-    const auto actor = a_event->actor.get();
-    if (actor) {
-        auto actorFormType = actor->GetFormType();
-        auto vm = RE::SkyrimVM::GetSingleton();
-
-        if (vm) {
-            const auto handle = vm->handlePolicy.GetHandleForObject(static_cast<RE::VMTypeID>(actorFormType), actor);
-
-            if (handle && handle != vm->handlePolicy.EmptyHandle()) {
-                const auto equippedForm = RE::TESForm::LookupByID(a_event->baseObject);
-                auto equippedFormType = equippedForm->GetFormType();
-
-                if (equippedFormType == RE::FormType::Spell) {
-                    const auto spell = equippedForm->As<RE::SpellItem>();
-                    auto eventArgs = RE::MakeFunctionArguments((SpellItem*)spell, (TESObjectREFR*)actor);
-
-                    if (a_event->equipped) {
-                        // Send OnSpellEquipped event
-                        RE::SkyrimVM::GetSingleton()->SendAndRelayEvent(handle, &OnSpellEquippedEventName, eventArgs,
-                                                                        nullptr);
-                    } else {
-                        // Send OnSpellUnequipped event
-                        RE::SkyrimVM::GetSingleton()->SendAndRelayEvent(handle, &OnSpellUnequippedEventName, eventArgs,
-                                                                        nullptr);
-                    }
-                } else if (equippedFormType == RE::FormType::Shout) {
-                    const auto shout = equippedForm->As<RE::TESShout>();
-                    auto eventArgs = RE::MakeFunctionArguments((TESShout*)shout, (TESObjectREFR*)actor);
-
-                    if (a_event->equipped) {
-                        // Send OnShoutEquipped event
-                        RE::SkyrimVM::GetSingleton()->SendAndRelayEvent(handle, &OnShoutEquippedEventName, eventArgs,
-                                                                        nullptr);
-                    } else {
-                        // Send OnShoutUnequipped event
-                        RE::SkyrimVM::GetSingleton()->SendAndRelayEvent(handle, &OnShoutUnequippedEventName, eventArgs,
-                                                                        nullptr);
-                    }
-                }
+EquipEventDefinition::EquippedMagic EquipEventDefinition::GetEquippedMagic(RE::Actor* actor) {
+    std::lock_guard<std::mutex> lockGuard(equippedMagicMutex);
+
+    auto [it, inserted] = equippedMagic.try_emplace(actor->formID);
+    auto& magic = it->second;
+    if (inserted) {
+        const auto& runtimeData = actor->GetActorRuntimeData();
+        for (std::size_t slot = 0; slot < magic.spells.size(); ++slot) {
+            const auto spell = runtimeData.selectedSpells[slot];
+            magic.spells[slot] = spell ? spell->formID : 0;
+        }
+
+        const auto power = runtimeData.selectedPower;
+        magic.shout = (power && power->Is(RE::FormType::Shout)) ? power->formID : 0;
+    }
+
+    return magic;
+}
+
+void EquipEventDefinition::ClearEquippedMagic() {
+    std::lock_guard<std::mutex> lockGuard(equippedMagicMutex);
+    equippedMagic.clear();
+}
+
+/**
+ * Sends the real changes of the actors whose suppression windows closed.
+ */
+static void SendEquipChanges(const std::vector<Core::EquipChange>& changes) {
+    auto& policy = OnEquipEventHandler::GetSingleton().GetPolicy();
+
+    if (!Core::GetSettings().equipEvents.summarizeLoadChanges) {
+        for (const auto& change : changes) {
+            const auto actor = RE::TESForm::LookupByID<RE::Actor>(change.actor);
+            const auto form = RE::TESForm::LookupByID(change.form);
+            if (!actor || !form) {
+                continue;
+            }
+
+            if (const auto spell = form->As<RE::SpellItem>()) {
+                policy.Dispatch(actor, change.equipped ? OnSpellEquippedEventName : OnSpellUnequippedEventName,
+                                spell, (TESObjectREFR*)actor);
+            } else if (const auto shout = form->As<RE::TESShout>()) {
+                policy.Dispatch(actor, change.equipped ? OnShoutEquippedEventName : OnShoutUnequippedEventName,
+                                shout, (TESObjectREFR*)actor);
+            }
+        }
+        return;
+    }
+
+    // The changes of an actor are adjacent, so each run of changes becomes one event
+    for (auto first = changes.begin(); first != changes.end();) {
+        const auto last = std::find_if(first, changes.end(),
+                                       [first](const auto& change) { return change.actor != first->actor; });
+
+        std::vector<TESForm*> equipped;
+        std::vector<TESForm*> unequipped;
+        for (auto it = first; it != last; ++it) {
+            if (const auto form = RE::TESForm::LookupByID(it->form)) {
+                (it->equipped ? equipped : unequipped).push_back(form);
             }
         }
+
+        const auto actor = RE::TESForm::LookupByID<RE::Actor>(first->actor);
+        if (actor && (!equipped.empty() || !unequipped.empty())) {
+            policy.Dispatch(actor, OnEquippedMagicChangedEventName, std::move(equipped), std::move(unequipped));
+        }
+
+        first = last;
+    }
+}
+
+/**
+ * Advances the suppression windows by a frame, and keeps doing so every frame while any are open. Queued up
+ * from the frame hook rather than the SKSE task interface, whose tasks can queue themselves up again within
+ * the same frame and would close the windows in one go.
+ */
+static void AdvanceSuppressionWindows() {
+    PAPER_PROFILE_SCOPE("Equip.AdvanceSuppressionWindows", "task");
+
+    std::vector<Core::EquipChange> changes;
+    const bool windowsOpen = OnEquipEventHandler::GetSingleton().GetDefinition().equipStates.AdvanceFrame(changes);
+    SendEquipChanges(changes);
+
+    if (windowsOpen) {
+        FrameHook::AddTaskNextFrame(AdvanceSuppressionWindows);
+    } else {
+        advancingSuppressionWindows = false;
+    }
+}
+
+static void StartAdvancingSuppressionWindows() {
+    if (!advancingSuppressionWindows.exchange(true)) {
+        FrameHook::AddTaskNextFrame(AdvanceSuppressionWindows);
+    }
+}
+
+CellAttachEventHandler& CellAttachEventHandler::GetSingleton() noexcept {
+    static CellAttachEventHandler instance;
+    return instance;
+}
+
+RE::BSEventNotifyControl CellAttachEventHandler::ProcessEvent(const RE::TESCellAttachDetachEvent* a_event,
+                                                              RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) {
+    const auto reference = a_event ? a_event->reference.get() : nullptr;
+    if (!reference || !reference->Is(RE::FormType::ActorCharacter)) {
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    auto& equipStates = OnEquipEventHandler::GetSingleton().GetDefinition().equipStates;
+    const auto& settings = Core::GetSettings().equipEvents;
+    if (a_event->attached) {
+        if (settings.enabled && settings.suppressLoadStorms) {
+            equipStates.BeginActorWindow(reference->formID, settings.loadSuppressionFrames);
+            StartAdvancingSuppressionWindows();
+        }
+    } else if (!(reference->GetFormFlags() & RE::TESObjectREFR::RecordFlags::kPersistent)) {
+        // Non-persistent actors may never come back (or come back reset), so their states would only pile up
+        // in the cosave. Should they come back, the window of their cell attach seeds their state again.
+        equipStates.ForgetActor(reference->formID);
     }
 
     // Let other code process the same event next
     return RE::BSEventNotifyControl::kContinue;
 }
+
+void OnEquipEvents::OnPreLoadGame() {
+    OnEquipEventHandler::GetSingleton().GetDefinition().equipStates.BeginLoadWindow();
+}
+
+void OnEquipEvents::OnPostLoadGame() {
+    OnEquipEventHandler::GetSingleton().GetDefinition().equipStates.EndLoadWindow(
+        Core::GetSettings().equipEvents.loadSuppressionFrames);
+    StartAdvancingSuppressionWindows();
+}
+
+void OnEquipEvents::OnRevert(SKSE::SerializationInterface*) {
+    auto& definition = OnEquipEventHandler::GetSingleton().GetDefinition();
+    definition.ClearEquippedMagic();
+    definition.equipStates.Revert();
+}
+
+void OnEquipEvents::OnGameSaved(SKSE::SerializationInterface* serde) {
+    PAPER_TRACE_SCOPE("Equip.Save", "cosave");
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    OnEquipEventHandler::GetSingleton().GetDefinition().equipStates.Save(serialization);
+}
+
+bool OnEquipEvents::OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type) {
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    return OnEquipEventHandler::GetSingleton().GetDefinition().equipStates.LoadRecord(serialization, type);
+}
+
+template class EventBridges::EventBridge<EquipEventDefinition>;
@@ -0,0 +1,155 @@
+#include <OnMagicEffectApplyEventHandler.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace RE;
+using namespace OnMagicEffectApplyEvents;
+
+static BSFixedString OnBatchMagicEffectsAppliedEventName = "OnBatchMagicEffectsApplied";
+
+/** Every event name that is batched by the handler, for writing pending batches to the cosave */
+static const std::array<const BSFixedString*, 1> BatchedEventNames = {&OnBatchMagicEffectsAppliedEventName};
+
+static constexpr std::uint32_t MagicEffectBatchesRecord = Core::MakeRecordType("MEBT");
+static constexpr std::uint32_t MagicEffectFiltersRecord = Core::MakeRecordType("MEFL");
+
+template <class Emit>
+void MagicEffectApplyEventDefinition::Project(const Event& event, Emit&& emit) {
+    const auto target = event.target.get();
+    if (!target || !PassesFilters(target->formID, event.magicEffect)) {
+        return;
+    }
+
+    const auto magicEffect = RE::TESForm::LookupByID<RE::EffectSetting>(event.magicEffect);
+    if (!magicEffect) {
+        return;
+    }
+
+    emit(target, OnBatchMagicEffectsAppliedEventName, magicEffect, event.caster.get());
+}
+
+bool MagicEffectApplyEventDefinition::PassesFilters(RE::FormID target, RE::FormID magicEffect) {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+
+    const auto it = filters.find(target);
+    if (it == filters.end()) {
+        // No filters, so anything matches
+        return true;
+    }
+
+    // Same semantics as inventory event filters: a filter is either the effect itself, or a form list
+    for (const auto filter : it->second) {
+        if (filter == magicEffect) {
+            return true;
+        }
+
+        const auto formList = RE::TESForm::LookupByID<RE::BGSListForm>(filter);
+        if (formList && formList->HasForm(magicEffect)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MagicEffectApplyEventDefinition::AddFilter(RE::FormID target, RE::FormID filter) {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+
+    auto& targetFilters = filters[target];
+    if (std::find(targetFilters.begin(), targetFilters.end(), filter) == targetFilters.end()) {
+        targetFilters.push_back(filter);
+    }
+}
+
+void MagicEffectApplyEventDefinition::RemoveAllFilters(RE::FormID target) {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+    filters.erase(target);
+}
+
+void MagicEffectApplyEventDefinition::ClearFilters() {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+    filters.clear();
+}
+
+void MagicEffectApplyEventDefinition::SaveFilters(SKSE::SerializationInterface* serde, std::uint32_t type) {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+
+    if (!serde->OpenRecord(type, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t numTargets = filters.size();
+    serde->WriteRecordData(numTargets);
+    for (const auto& [target, targetFilters] : filters) {
+        serde->WriteRecordData(target);
+
+        std::size_t numFilters = targetFilters.size();
+        serde->WriteRecordData(numFilters);
+        for (const auto filter : targetFilters) {
+            serde->WriteRecordData(filter);
+        }
+    }
+}
+
+void MagicEffectApplyEventDefinition::LoadFilters(SKSE::SerializationInterface* serde) {
+    std::lock_guard<std::mutex> lockGuard(filtersMutex);
+
+    std::size_t numTargets;
+    serde->ReadRecordData(numTargets);
+
+    for (; numTargets > 0; --numTargets) {
+        RE::FormID target;
+        serde->ReadRecordData(target);
+        const bool resolvedTarget = serde->ResolveFormID(target, target);
+
+        std::size_t numFilters;
+        serde->ReadRecordData(numFilters);
+
+        std::vector<RE::FormID> targetFilters;
+        for (; numFilters > 0; --numFilters) {
+            RE::FormID filter;
+            serde->ReadRecordData(filter);
+            if (serde->ResolveFormID(filter, filter)) {
+                targetFilters.push_back(filter);
+            }
+        }
+
+        // A target whose filters all disappeared keeps an empty filter list, which lets nothing through
+        if (resolvedTarget) {
+            filters[target] = std::move(targetFilters);
+        }
+    }
+}
+
+void OnMagicEffectApplyEvents::OnRevert(SKSE::SerializationInterface*) {
+    auto& handler = OnMagicEffectApplyEventHandler::GetSingleton();
+    handler.GetPolicy().Clear();
+    handler.GetDefinition().ClearFilters();
+}
+
+void OnMagicEffectApplyEvents::OnGameSaved(SKSE::SerializationInterface* serde) {
+    PAPER_TRACE_SCOPE("MagicEffectApply.Save", "cosave");
+    auto& handler = OnMagicEffectApplyEventHandler::GetSingleton();
+    handler.GetPolicy().Save(serde, MagicEffectBatchesRecord, BatchedEventNames);
+    handler.GetDefinition().SaveFilters(serde, MagicEffectFiltersRecord);
+}
+
+bool OnMagicEffectApplyEvents::OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type,
+                                              std::uint32_t length) {
+    auto& handler = OnMagicEffectApplyEventHandler::GetSingleton();
+    if (type == MagicEffectBatchesRecord) {
+        handler.GetPolicy().Load(serde, length, BatchedEventNames);
+    } else if (type == MagicEffectFiltersRecord) {
+        handler.GetDefinition().LoadFilters(serde);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+template class EventBridges::EventBridge<
+    MagicEffectApplyEventDefinition,
+    EventBridges::BatchedPolicy<PerfStats::Handler::kMagicEffectApply, RE::EffectSetting*, RE::TESObjectREFR*>>;
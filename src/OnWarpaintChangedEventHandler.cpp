@@ -0,0 +1,174 @@
+#include <OnWarpaintChangedEventHandler.h>
+#include <EventTargets.h>
+#include <Logging.h>
+#include <Profiling.h>
+
+using namespace OnWarpaintChangedEvents;
+
+static RE::BSFixedString OnWarpaintChangedEventName = "OnWarpaintChanged";
+
+namespace {
+    /**
+     * Hook on the virtual Set3D of actors, which the game calls whenever it (re)builds the 3D of an actor,
+     * e.g. for QueueNiNodeUpdate after scripts changed tint masks. Character and PlayerCharacter have their
+     * own vtables, so each gets its own original function.
+     */
+    template <class ActorType>
+    struct Set3DHook {
+        static void thunk(ActorType* a_actor, RE::NiAVObject* a_object, bool a_queue3DTasks) {
+            func(a_actor, a_object, a_queue3DTasks);
+
+            // Unloading the 3D does not change appearances
+            if (a_object) {
+                if (const auto actorBase = a_actor->GetActorBase()) {
+                    OnWarpaintChangedEventHandler::GetSingleton().Recheck(actorBase);
+                }
+            }
+        }
+
+        static inline REL::Relocation<decltype(thunk)> func;
+        static constexpr std::size_t idx = 0x6C;
+    };
+}
+
+std::uint64_t OnWarpaintChangedEvents::HashWarpaint(RE::TESNPC* actorBase) {
+    std::vector<Core::WarpaintLayer> layers;
+    ForEachWarpaintLayer(actorBase, [&layers](const RE::TESNPC::Layer& layer) {
+        const auto& color = layer.tintColor;
+        layers.push_back({layer.tintIndex,
+                          (static_cast<std::uint32_t>(color.red) << 16) |
+                              (static_cast<std::uint32_t>(color.green) << 8) | static_cast<std::uint32_t>(color.blue),
+                          layer.GetInterpolationValue()});
+    });
+
+    return Core::HashWarpaintLayers(layers);
+}
+
+OnWarpaintChangedEventHandler& OnWarpaintChangedEventHandler::GetSingleton() noexcept {
+    static OnWarpaintChangedEventHandler instance;
+    return instance;
+}
+
+RE::BSEventNotifyControl OnWarpaintChangedEventHandler::ProcessEvent(
+    const RE::TESSwitchRaceCompleteEvent* a_event, RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>*) {
+    PAPER_PROFILE_SCOPE("Warpaint.SwitchRaceComplete", "sink");
+
+    if (a_event && a_event->subject && tracker.HasTrackedActorBases()) {
+        const auto actorBase = a_event->subject->GetBaseObject();
+        if (actorBase && tracker.IsTracked(actorBase->formID)) {
+            QueueRecheck(actorBase->formID);
+        }
+    }
+
+    // Let other code process the same event next
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+RE::BSEventNotifyControl OnWarpaintChangedEventHandler::ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                                                     RE::BSTEventSource<RE::MenuOpenCloseEvent>*) {
+    if (a_event && !a_event->opening && a_event->menuName == RE::RaceSexMenu::MENU_NAME &&
+        tracker.HasTrackedActorBases()) {
+        PAPER_PROFILE_SCOPE("Warpaint.RaceSexMenuClosed", "sink");
+
+        // The event does not say whose face was edited (usually the player's), so re-check all of them
+        for (const auto actorBase : tracker.GetTrackedActorBases()) {
+            QueueRecheck(actorBase);
+        }
+    }
+
+    // Let other code process the same event next
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+void OnWarpaintChangedEventHandler::Register(RE::TESForm* receiver, RE::TESNPC* actorBase) {
+    tracker.Register(receiver->formID, actorBase->formID);
+
+    // Hashes the current warpaint if this is the first registration for the actor base
+    QueueRecheck(actorBase->formID);
+}
+
+void OnWarpaintChangedEventHandler::Unregister(RE::TESForm* receiver, RE::TESNPC* actorBase) {
+    tracker.Unregister(receiver->formID, actorBase->formID);
+}
+
+void OnWarpaintChangedEventHandler::InstallHooks() {
+    REL::Relocation<std::uintptr_t> characterVtbl{RE::VTABLE_Character[0]};
+    Set3DHook<RE::Character>::func =
+        characterVtbl.write_vfunc(Set3DHook<RE::Character>::idx, Set3DHook<RE::Character>::thunk);
+
+    REL::Relocation<std::uintptr_t> playerVtbl{RE::VTABLE_PlayerCharacter[0]};
+    Set3DHook<RE::PlayerCharacter>::func =
+        playerVtbl.write_vfunc(Set3DHook<RE::PlayerCharacter>::idx, Set3DHook<RE::PlayerCharacter>::thunk);
+
+    Logging::trace(Logging::Category::kGeneral, "Actor 3D hooked for warpaint re-checks.");
+}
+
+void OnWarpaintChangedEventHandler::Recheck(RE::TESNPC* actorBase) {
+    if (tracker.HasTrackedActorBases() && tracker.IsTracked(actorBase->formID)) {
+        QueueRecheck(actorBase->formID);
+    }
+}
+
+void OnWarpaintChangedEventHandler::QueueRecheck(RE::FormID actorBase) {
+    {
+        std::lock_guard<std::mutex> lockGuard(pendingRechecksMutex);
+        pendingRechecks.insert(actorBase);
+
+        if (haveQueuedUpTask) {
+            return;
+        }
+        haveQueuedUpTask = true;
+    }
+
+    tasks.AddTask([this]() { this->RecheckWarpaint(); });
+}
+
+void OnWarpaintChangedEventHandler::RecheckWarpaint() {
+    PAPER_PROFILE_SCOPE("Warpaint.Recheck", "task");
+
+    decltype(pendingRechecks) actorBases;
+    {
+        std::lock_guard<std::mutex> lockGuard(pendingRechecksMutex);
+        actorBases.swap(pendingRechecks);
+        haveQueuedUpTask = false;
+    }
+
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm) {
+        return;
+    }
+
+    for (const auto actorBaseID : actorBases) {
+        const auto actorBase = RE::TESForm::LookupByID<RE::TESNPC>(actorBaseID);
+        if (!actorBase) {
+            continue;
+        }
+
+        for (const auto receiverID : tracker.UpdateHash(actorBaseID, HashWarpaint(actorBase))) {
+            const auto handle = handles.GetHandleForForm(RE::TESForm::LookupByID(receiverID));
+            if (!handles.IsValidHandle(handle)) {
+                continue;
+            }
+
+            auto eventArgs = RE::MakeFunctionArguments(static_cast<RE::TESNPC*>(actorBase));
+            EventTargets::TargetedEventFilter filter(OnWarpaintChangedEventName);
+            PAPER_TRACE_SCOPE("SendAndRelayEvent", "vm");
+            vm->SendAndRelayEvent(handle, &OnWarpaintChangedEventName, eventArgs, &filter);
+        }
+    }
+}
+
+void OnWarpaintChangedEventHandler::OnRevert(SKSE::SerializationInterface*) {
+    GetSingleton().tracker.Revert();
+}
+
+void OnWarpaintChangedEventHandler::OnGameSaved(SKSE::SerializationInterface* serde) {
+    PAPER_TRACE_SCOPE("Warpaint.Save", "cosave");
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    GetSingleton().tracker.Save(serialization);
+}
+
+bool OnWarpaintChangedEventHandler::OnRecordLoaded(SKSE::SerializationInterface* serde, std::uint32_t type) {
+    EngineAdapters::SkyrimSerializationInterface serialization(serde);
+    return GetSingleton().tracker.LoadRecord(serialization, type);
+}
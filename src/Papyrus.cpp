@@ -1,5 +1,16 @@
 #include "Papyrus.h"
+#include "ArrayKernels.h"
+#include "EventRecorder.h"
+#include "InventoryEventGrouping.h"
+#include "Logging.h"
+#include "OnContainerChangedEventHandler.h"
+#include "OnEquipEventHandler.h"
+#include "OnHitEventHandler.h"
+#include "OnMagicEffectApplyEventHandler.h"
+#include "OnWarpaintChangedEventHandler.h"
+#include "Profiling.h"
 #include "ResourceUtils.h"
+#include "SettingsLoader.h"
 #include "Version.h"
 
 namespace PAPER {
@@ -10,6 +21,7 @@ namespace PAPER {
 	 * Array with version number (major, minor, patch) for the PAPER plugin.
 	 */
 	std::vector<std::int32_t> GetPaperVersion(RE::StaticFunctionTag*) {
+        PAPER_PROFILE_SCOPE("Native.GetPaperVersion", "native");
         return {PROJECT_VER_MAJOR, PROJECT_VER_MINOR, PROJECT_VER_PATCH};
     }
 
@@ -19,6 +31,7 @@ namespace PAPER {
 	 */
     bool ResourceExists(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID, RE::StaticFunctionTag*,
                         std::string resourcePath) { 
+        PAPER_PROFILE_SCOPE("Native.ResourceExists", "native");
         return ResourceUtils::ResourceExists(resourcePath);
 	}
 
@@ -27,6 +40,7 @@ namespace PAPER {
      * strings that are recognised as installed resources.
      */
     std::vector<std::string> GetInstalledResources(RE::StaticFunctionTag*, const RE::reference_array<std::string> strings) {
+        PAPER_PROFILE_SCOPE("Native.GetInstalledResources", "native");
         std::vector<std::string> installedResources;
         installedResources.reserve(strings.size());
 
@@ -41,6 +55,29 @@ namespace PAPER {
         return installedResources;
     }
 
+    /**
+     * Returns the indices of the given forms that reference a model, texture (set) or world model that is
+     * not installed. Every distinct path is checked once, with the checks spread over worker threads.
+     */
+    std::vector<std::int32_t> ValidateFormAssets(RE::StaticFunctionTag*,
+                                                 const RE::reference_array<RE::TESForm*> akForms) {
+        PAPER_PROFILE_SCOPE("Native.ValidateFormAssets", "native");
+
+        // Reading the forms stays on this thread; only the resource lookups run on the workers
+        Core::AssetPathValidator validator;
+        for (std::size_t i = 0; i < akForms.size(); ++i) {
+            if (akForms[i]) {
+                ResourceUtils::ForEachAssetPath(akForms[i],
+                                                [&validator, i](std::string_view path, Core::AssetKind kind) {
+                                                    validator.AddPath(i, path, kind);
+                                                });
+            }
+        }
+
+        return validator.FindFormsWithMissingAssets(
+            [](const std::string& path) { return ResourceUtils::ResourceExists(path); });
+    }
+
     /**
      * Returns an array of colours for all the warpaints for which we are able
      * to detect that they have been applied to the character's face.
@@ -48,6 +85,7 @@ namespace PAPER {
     std::vector<RE::BGSColorForm*> GetWarpaintColors(RE::BSScript::Internal::VirtualMachine* a_vm,
         RE::VMStackID a_stackID, RE::StaticFunctionTag*,
         RE::TESNPC* actorBase) {
+        PAPER_PROFILE_SCOPE("Native.GetWarpaintColors", "native");
 
         std::vector<RE::BGSColorForm*> warpaintColors;
 
@@ -56,75 +94,203 @@ namespace PAPER {
             return warpaintColors;
         }
 
-        while (actorBase->tintLayers == nullptr && actorBase->faceNPC != nullptr && actorBase->faceNPC != actorBase) {
-            actorBase = actorBase->faceNPC;
+        const auto factory = RE::IFormFactory::GetConcreteFormFactoryByType<RE::BGSColorForm>();
+        if (!factory) {
+            return warpaintColors;
         }
 
-        const auto sex = actorBase->GetSex();
-        const auto race = actorBase->race;
-        const auto factory = RE::IFormFactory::GetConcreteFormFactoryByType<RE::BGSColorForm>();
+        OnWarpaintChangedEvents::ForEachWarpaintLayer(actorBase, [&](const RE::TESNPC::Layer& layer) {
+            // We've found something that is paint, so add its color
+            auto color = factory->Create();
 
-        if (race && factory && actorBase->tintLayers) {
-            const auto faceRelatedData = race->faceRelatedData[sex];
-
-            if (faceRelatedData) {
-                // Loop through the tint layers of the ActorBase
-                auto layer = actorBase->tintLayers->begin();
-                while (layer != actorBase->tintLayers->end()) {
-                    // Need interpolation value > 0.0 for the layer to be visible
-                    if ((*layer) && (*layer)->GetInterpolationValue() > 0.f) {
-                        const auto tintIndex = (*layer)->tintIndex;
-                        
-                        // Figure out from tint assets defined in Race's face data whether
-                        // or not this actually could be a paint tint
-                        bool isPaint = false;
-                        auto tintAsset = faceRelatedData->tintMasks->begin();
-                        while (tintAsset != faceRelatedData->tintMasks->end()) {
-                            if (tintAsset) {
-                                auto tintLayer = &((*tintAsset)->texture);
-                                if (tintLayer && tintLayer->index == tintIndex) {
-                                    const auto tintLayerType = tintLayer->skinTone.get();
-
-                                    if (tintLayerType ==
-                                            RE::TESRace::FaceRelatedData::TintAsset::TintLayer::SkinTone::kNone ||
-                                        tintLayerType ==
-                                            RE::TESRace::FaceRelatedData::TintAsset::TintLayer::SkinTone::kPaint) {
-                                        // I've found some things that very much look like warpaint with type None
-                                        // in the Creation Kit (e.g., Forsworn stuff in the Breton race), so we'll
-                                        // also allow that type.
-                                        isPaint = true;
-                                    }
-
-                                    break;
-                                }
-                            }
-
-                            ++tintAsset;
-                        }
+            if (color) {
+                color->flags.reset(RE::BGSColorForm::Flag::kPlayable);
+                color->color = layer.tintColor;
+                warpaintColors.push_back(color);
+            }
+        });
 
-                        if (isPaint) {
-                            // We've found something that is paint, so add its color
-                            auto color = factory->Create();
+        return warpaintColors;
+    }
 
-                            if (color) {
-                                color->flags.reset(RE::BGSColorForm::Flag::kPlayable);
-                                color->color = (*layer)->tintColor;
-                                warpaintColors.push_back(color);
-                            }
-                        }
-                    }
+    /**
+     * Registers the given form (e.g., a quest) for OnWarpaintChanged events, sent whenever the warpaint of
+     * the given actor base changes.
+     */
+    void RegisterForWarpaintChanged(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                    RE::StaticFunctionTag*, RE::TESForm* akReceiver, RE::TESNPC* akActorBase) {
+        PAPER_PROFILE_SCOPE("Native.RegisterForWarpaintChanged", "native");
+        if (!akReceiver || !akActorBase) {
+            a_vm->TraceStack(akReceiver ? "akActorBase is None" : "akReceiver is None", a_stackID);
+            return;
+        }
 
-                    ++layer;
-                }
+        OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::GetSingleton().Register(akReceiver, akActorBase);
+    }
+
+    /**
+     * Unregisters the given form from OnWarpaintChanged events of the given actor base.
+     */
+    void UnregisterForWarpaintChanged(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                      RE::StaticFunctionTag*, RE::TESForm* akReceiver, RE::TESNPC* akActorBase) {
+        PAPER_PROFILE_SCOPE("Native.UnregisterForWarpaintChanged", "native");
+        if (!akReceiver || !akActorBase) {
+            a_vm->TraceStack(akReceiver ? "akActorBase is None" : "akReceiver is None", a_stackID);
+            return;
+        }
+
+        OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::GetSingleton().Unregister(akReceiver, akActorBase);
+    }
+
+    /**
+     * Re-checks the warpaint of the given actor base at the end of the frame, sending OnWarpaintChanged events
+     * if it changed. For scripts that change warpaint themselves, which PAPER does not detect on its own.
+     */
+    void RecheckWarpaint(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                         RE::StaticFunctionTag*, RE::TESNPC* akActorBase) {
+        PAPER_PROFILE_SCOPE("Native.RecheckWarpaint", "native");
+        if (!akActorBase) {
+            a_vm->TraceStack("akActorBase is None", a_stackID);
+            return;
+        }
+
+        OnWarpaintChangedEvents::OnWarpaintChangedEventHandler::GetSingleton().Recheck(akActorBase);
+    }
+
+    /**
+     * Returns the spell that each of the given actors has equipped in the given slot (as in
+     * Actor.GetEquippedSpell), with None for actors that are None. Answered from the equipment table
+     * of the equip event handler, so actors are only read after their equipment changed.
+     */
+    std::vector<RE::SpellItem*> GetEquippedSpellsForActors(RE::BSScript::Internal::VirtualMachine* a_vm,
+                                                           RE::VMStackID a_stackID, RE::StaticFunctionTag*,
+                                                           const RE::reference_array<RE::Actor*> akActors,
+                                                           std::int32_t aiSlot) {
+        PAPER_PROFILE_SCOPE("Native.GetEquippedSpellsForActors", "native");
+
+        std::vector<RE::SpellItem*> spells(akActors.size(), nullptr);
+        if (aiSlot < 0 || aiSlot > 3) {
+            a_vm->TraceStack("aiSlot must be between 0 and 3", a_stackID);
+            return spells;
+        }
+
+        auto& equipEvents = OnEquipEvents::OnEquipEventHandler::GetSingleton().GetDefinition();
+        for (std::size_t i = 0; i < akActors.size(); ++i) {
+            if (akActors[i]) {
+                const auto spell = equipEvents.GetEquippedMagic(akActors[i]).spells[aiSlot];
+                spells[i] = spell ? RE::TESForm::LookupByID<RE::SpellItem>(spell) : nullptr;
             }
         }
 
-        return warpaintColors;
+        return spells;
+    }
+
+    /**
+     * Returns the shout that each of the given actors has equipped, with None for actors that are None
+     * or have no shout equipped.
+     */
+    std::vector<RE::TESShout*> GetEquippedShoutsForActors(RE::StaticFunctionTag*,
+                                                          const RE::reference_array<RE::Actor*> akActors) {
+        PAPER_PROFILE_SCOPE("Native.GetEquippedShoutsForActors", "native");
+
+        std::vector<RE::TESShout*> shouts(akActors.size(), nullptr);
+
+        auto& equipEvents = OnEquipEvents::OnEquipEventHandler::GetSingleton().GetDefinition();
+        for (std::size_t i = 0; i < akActors.size(); ++i) {
+            if (akActors[i]) {
+                const auto shout = equipEvents.GetEquippedMagic(akActors[i]).shout;
+                shouts[i] = shout ? RE::TESForm::LookupByID<RE::TESShout>(shout) : nullptr;
+            }
+        }
+
+        return shouts;
+    }
+
+    /**
+     * Converts a window in seconds, as given by scripts, to the milliseconds of the hit telemetry.
+     */
+    std::uint32_t HitTelemetryWindow(float afSeconds) {
+        return static_cast<std::uint32_t>(std::clamp(afSeconds, 0.0f, 3600.0f * 24.0f) * 1000.0f);
+    }
+
+    /**
+     * Returns the actors that hit the given actor in the last given number of seconds, most recent first.
+     */
+    std::vector<RE::Actor*> GetRecentAttackers(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                               RE::StaticFunctionTag*, RE::Actor* akTarget, float afSeconds) {
+        PAPER_PROFILE_SCOPE("Native.GetRecentAttackers", "native");
+
+        std::vector<RE::Actor*> attackers;
+        if (!akTarget) {
+            a_vm->TraceStack("akTarget is None", a_stackID);
+            return attackers;
+        }
+
+        const auto& hitTelemetry = OnHitEvents::OnHitEventHandler::GetSingleton().GetDefinition().hitTelemetry;
+        for (const auto attacker : hitTelemetry.GetRecentAttackers(
+                 akTarget->formID, RE::GetDurationOfApplicationRunTime(), HitTelemetryWindow(afSeconds))) {
+            if (const auto actor = RE::TESForm::LookupByID<RE::Actor>(attacker)) {
+                attackers.push_back(actor);
+            }
+        }
+
+        return attackers;
+    }
+
+    /**
+     * Returns the number of hits per second of the given aggressor on the given target over the last given
+     * number of seconds.
+     */
+    float GetHitRate(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID, RE::StaticFunctionTag*,
+                     RE::Actor* akAggressor, RE::Actor* akTarget, float afSeconds) {
+        PAPER_PROFILE_SCOPE("Native.GetHitRate", "native");
+        if (!akAggressor || !akTarget) {
+            a_vm->TraceStack(akAggressor ? "akTarget is None" : "akAggressor is None", a_stackID);
+            return 0.0f;
+        }
+
+        const auto& hitTelemetry = OnHitEvents::OnHitEventHandler::GetSingleton().GetDefinition().hitTelemetry;
+        return hitTelemetry.GetHitRate(akAggressor->formID, akTarget->formID, RE::GetDurationOfApplicationRunTime(),
+                                       HitTelemetryWindow(afSeconds));
+    }
+
+    /**
+     * Returns the fraction of the hits of the given aggressor on the given target over the last given number
+     * of seconds that were blocked.
+     */
+    float GetBlockedHitRatio(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                             RE::StaticFunctionTag*, RE::Actor* akAggressor, RE::Actor* akTarget, float afSeconds) {
+        PAPER_PROFILE_SCOPE("Native.GetBlockedHitRatio", "native");
+        if (!akAggressor || !akTarget) {
+            a_vm->TraceStack(akAggressor ? "akTarget is None" : "akAggressor is None", a_stackID);
+            return 0.0f;
+        }
+
+        const auto& hitTelemetry = OnHitEvents::OnHitEventHandler::GetSingleton().GetDefinition().hitTelemetry;
+        return hitTelemetry.GetBlockedRatio(akAggressor->formID, akTarget->formID,
+                                            RE::GetDurationOfApplicationRunTime(), HitTelemetryWindow(afSeconds));
+    }
+
+    /**
+     * Returns how many of the most recent hits of the given aggressor on the given target in a row were
+     * power attacks.
+     */
+    std::int32_t GetPowerAttackStreak(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                      RE::StaticFunctionTag*, RE::Actor* akAggressor, RE::Actor* akTarget) {
+        PAPER_PROFILE_SCOPE("Native.GetPowerAttackStreak", "native");
+        if (!akAggressor || !akTarget) {
+            a_vm->TraceStack(akAggressor ? "akTarget is None" : "akAggressor is None", a_stackID);
+            return 0;
+        }
+
+        const auto& hitTelemetry = OnHitEvents::OnHitEventHandler::GetSingleton().GetDefinition().hitTelemetry;
+        return hitTelemetry.GetPowerAttackStreak(akAggressor->formID, akTarget->formID);
     }
 
     std::vector<std::int32_t> GetInventoryEventFilterIndices(RE::StaticFunctionTag*,
                                                              const RE::reference_array<RE::TESForm*> akEventItems,
                                                              RE::TESForm* akFilter) {
+        PAPER_PROFILE_SCOPE("Native.GetInventoryEventFilterIndices", "native");
         std::vector<std::int32_t> matchingIndices;
 
         auto formList = RE::TESForm::LookupByID<RE::BGSListForm>(akFilter->formID);
@@ -149,6 +315,7 @@ namespace PAPER {
                                                                 const RE::reference_array<RE::TESForm*> akEventItems,
                                                                 RE::TESForm* akFilter,
                                                                 const RE::reference_array<std::int32_t> aiIndices) {
+        PAPER_PROFILE_SCOPE("Native.UpdateInventoryEventFilterIndices", "native");
         std::vector<std::int32_t> matchingIndices;
 
         auto formList = RE::TESForm::LookupByID<RE::BGSListForm>(akFilter->formID);
@@ -172,6 +339,7 @@ namespace PAPER {
     std::vector<RE::TESForm*> ApplyInventoryEventFilterToForms(RE::StaticFunctionTag*,
                                                                const RE::reference_array<std::int32_t> aiIndicesToKeep,
                                                                const RE::reference_array<RE::TESForm*> akFormArray) {
+        PAPER_PROFILE_SCOPE("Native.ApplyInventoryEventFilterToForms", "native");
         std::vector<RE::TESForm*> remainingForms;
 
         for (int i = 0; i < aiIndicesToKeep.size(); ++i) {
@@ -184,6 +352,7 @@ namespace PAPER {
     std::vector<int32_t> ApplyInventoryEventFilterToInts(RE::StaticFunctionTag*,
                                                          const RE::reference_array<std::int32_t> aiIndicesToKeep,
                                                          const RE::reference_array<std::int32_t> aiIntArray) {
+        PAPER_PROFILE_SCOPE("Native.ApplyInventoryEventFilterToInts", "native");
         std::vector<int32_t> remainingInts;
 
         for (int i = 0; i < aiIndicesToKeep.size(); ++i) {
@@ -196,6 +365,7 @@ namespace PAPER {
     std::vector<RE::TESObjectREFR*> ApplyInventoryEventFilterToObjs(
         RE::StaticFunctionTag*, const RE::reference_array<std::int32_t> aiIndicesToKeep,
         const RE::reference_array<RE::TESObjectREFR*> akObjArray) {
+        PAPER_PROFILE_SCOPE("Native.ApplyInventoryEventFilterToObjs", "native");
 
         std::vector<RE::TESObjectREFR*> remainingObjs;
 
@@ -206,6 +376,581 @@ namespace PAPER {
         return remainingObjs;
     }
 
+    Core::InventoryEventGrouping GroupInventoryEventByFormTypeImpl(
+        const RE::reference_array<RE::TESForm*>& akEventItems) {
+        return Core::GroupInventoryEventIndices<RE::FormType>(akEventItems.size(), [&](const std::size_t i) {
+            const auto form = akEventItems[i];
+            return form ? form->GetFormType() : RE::FormType::None;
+        });
+    }
+
+    Core::InventoryEventGrouping GroupInventoryEventBySourceImpl(
+        const RE::reference_array<RE::TESObjectREFR*>& akContainers) {
+        return Core::GroupInventoryEventIndices<RE::FormID>(akContainers.size(), [&](const std::size_t i) {
+            const auto container = akContainers[i];
+            return container ? container->formID : static_cast<RE::FormID>(0);
+        });
+    }
+
+    /**
+     * Keyword groups are not ordered by first occurrence, but by the order of the keywords in akKeywords,
+     * such that group k always corresponds to akKeywords[k] (and may be empty). Every item is placed in the
+     * group of the first keyword it has, and items that have none of the keywords are left out.
+     */
+    Core::InventoryEventGrouping GroupInventoryEventByKeywordImpl(
+        const RE::reference_array<RE::TESForm*>& akEventItems, const RE::reference_array<RE::BGSKeyword*>& akKeywords) {
+        const auto numKeywords = akKeywords.size();
+        return Core::GroupInventoryEventIndicesInto(
+            akEventItems.size(), numKeywords, [&](const std::size_t i) -> std::optional<std::size_t> {
+                const auto keywordForm = akEventItems[i] ? akEventItems[i]->As<RE::BGSKeywordForm>() : nullptr;
+                if (keywordForm) {
+                    for (std::size_t k = 0; k < numKeywords; ++k) {
+                        if (akKeywords[k] && keywordForm->HasKeyword(akKeywords[k])) {
+                            return k;
+                        }
+                    }
+                }
+                return std::nullopt;
+            });
+    }
+
+    /**
+     * Returns the indices of the given inventory event items, grouped by form type.
+     */
+    std::vector<std::int32_t> GroupInventoryEventByFormType(RE::StaticFunctionTag*,
+                                                            const RE::reference_array<RE::TESForm*> akEventItems) {
+        PAPER_PROFILE_SCOPE("Native.GroupInventoryEventByFormType", "native");
+        return GroupInventoryEventByFormTypeImpl(akEventItems).groupedIndices;
+    }
+
+    /**
+     * Returns the start offsets of the groups in the array returned by GroupInventoryEventByFormType,
+     * followed by one final element holding the total number of grouped indices.
+     */
+    std::vector<std::int32_t> GetInventoryEventGroupOffsetsByFormType(
+        RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akEventItems) {
+        PAPER_PROFILE_SCOPE("Native.GetInventoryEventGroupOffsetsByFormType", "native");
+        return GroupInventoryEventByFormTypeImpl(akEventItems).groupOffsets;
+    }
+
+    /**
+     * Returns the indices of the given source (or destination) containers of an inventory event,
+     * grouped by container.
+     */
+    std::vector<std::int32_t> GroupInventoryEventBySource(RE::StaticFunctionTag*,
+                                                          const RE::reference_array<RE::TESObjectREFR*> akContainers) {
+        PAPER_PROFILE_SCOPE("Native.GroupInventoryEventBySource", "native");
+        return GroupInventoryEventBySourceImpl(akContainers).groupedIndices;
+    }
+
+    /**
+     * Returns the start offsets of the groups in the array returned by GroupInventoryEventBySource,
+     * followed by one final element holding the total number of grouped indices.
+     */
+    std::vector<std::int32_t> GetInventoryEventGroupOffsetsBySource(
+        RE::StaticFunctionTag*, const RE::reference_array<RE::TESObjectREFR*> akContainers) {
+        PAPER_PROFILE_SCOPE("Native.GetInventoryEventGroupOffsetsBySource", "native");
+        return GroupInventoryEventBySourceImpl(akContainers).groupOffsets;
+    }
+
+    /**
+     * Returns the indices of the given inventory event items, grouped by the first of the given keywords
+     * that they have.
+     */
+    std::vector<std::int32_t> GroupInventoryEventByKeyword(RE::StaticFunctionTag*,
+                                                           const RE::reference_array<RE::TESForm*> akEventItems,
+                                                           const RE::reference_array<RE::BGSKeyword*> akKeywords) {
+        PAPER_PROFILE_SCOPE("Native.GroupInventoryEventByKeyword", "native");
+        return GroupInventoryEventByKeywordImpl(akEventItems, akKeywords).groupedIndices;
+    }
+
+    /**
+     * Returns the start offsets of the groups in the array returned by GroupInventoryEventByKeyword,
+     * one per keyword, followed by one final element holding the total number of grouped indices.
+     */
+    std::vector<std::int32_t> GetInventoryEventGroupOffsetsByKeyword(
+        RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akEventItems,
+        const RE::reference_array<RE::BGSKeyword*> akKeywords) {
+        PAPER_PROFILE_SCOPE("Native.GetInventoryEventGroupOffsetsByKeyword", "native");
+        return GroupInventoryEventByKeywordImpl(akEventItems, akKeywords).groupOffsets;
+    }
+
+    /**
+     * Returns the sum of the given ints (e.g., the item counts of a batched inventory event), clamped to the
+     * range of Papyrus ints.
+     */
+    std::int32_t SumInts(RE::StaticFunctionTag*, const RE::reference_array<std::int32_t> aiValues) {
+        PAPER_PROFILE_SCOPE("Native.SumInts", "native");
+        return Core::SaturatingSum(aiValues);
+    }
+
+    /**
+     * Returns every form in the given array once, in order of first occurrence. None entries are left out.
+     */
+    std::vector<RE::TESForm*> GetUniqueForms(RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akForms) {
+        PAPER_PROFILE_SCOPE("Native.GetUniqueForms", "native");
+        return Core::UniqueKeys<RE::TESForm*>(akForms.size(), nullptr,
+                                              [&](const std::size_t i) { return akForms[i]; });
+    }
+
+    /**
+     * Returns the sum of the values of every form in the given parallel arrays, in the same order as the
+     * forms returned by GetUniqueForms (e.g., the total count of every item in a batched inventory event).
+     */
+    std::vector<std::int32_t> SumIntsByForm(RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akForms,
+                                            const RE::reference_array<std::int32_t> aiValues) {
+        PAPER_PROFILE_SCOPE("Native.SumIntsByForm", "native");
+        return Core::TotalsByKey<RE::TESForm*>(
+                   std::min(akForms.size(), aiValues.size()), nullptr,
+                   [&](const std::size_t i) { return akForms[i]; }, [&](const std::size_t i) { return aiValues[i]; })
+            .totals;
+    }
+
+    /**
+     * Returns the indices of all the occurrences of the given form in the given array.
+     */
+    std::vector<std::int32_t> FindAllForms(RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akForms,
+                                           RE::TESForm* akForm) {
+        PAPER_PROFILE_SCOPE("Native.FindAllForms", "native");
+        return Core::IndicesWhere(akForms.size(), [&](const std::size_t i) { return akForms[i] == akForm; });
+    }
+
+    /**
+     * Returns the indices of all the occurrences of the given reference in the given array.
+     */
+    std::vector<std::int32_t> FindAllObjs(RE::StaticFunctionTag*,
+                                          const RE::reference_array<RE::TESObjectREFR*> akObjs,
+                                          RE::TESObjectREFR* akObj) {
+        PAPER_PROFILE_SCOPE("Native.FindAllObjs", "native");
+        return Core::IndicesWhere(akObjs.size(), [&](const std::size_t i) { return akObjs[i] == akObj; });
+    }
+
+    /**
+     * Returns the indices of the given ints, stably sorted by their values. Pass the result to the
+     * ApplyInventoryEventFilterTo* functions to sort the parallel arrays of an event by, e.g., item count.
+     */
+    std::vector<std::int32_t> SortIndicesByInts(RE::StaticFunctionTag*,
+                                                const RE::reference_array<std::int32_t> aiValues,
+                                                bool abDescending) {
+        PAPER_PROFILE_SCOPE("Native.SortIndicesByInts", "native");
+        return Core::StableSortedIndices(aiValues, abDescending);
+    }
+
+    /**
+     * Returns the forms of the first array followed by those of the second.
+     */
+    std::vector<RE::TESForm*> ConcatForms(RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akFirst,
+                                          const RE::reference_array<RE::TESForm*> akSecond) {
+        PAPER_PROFILE_SCOPE("Native.ConcatForms", "native");
+        return Core::Concatenate<RE::TESForm*>(akFirst, akSecond);
+    }
+
+    /**
+     * Returns the ints of the first array followed by those of the second.
+     */
+    std::vector<std::int32_t> ConcatInts(RE::StaticFunctionTag*, const RE::reference_array<std::int32_t> aiFirst,
+                                         const RE::reference_array<std::int32_t> aiSecond) {
+        PAPER_PROFILE_SCOPE("Native.ConcatInts", "native");
+        return Core::Concatenate<std::int32_t>(aiFirst, aiSecond);
+    }
+
+    /**
+     * Returns the references of the first array followed by those of the second.
+     */
+    std::vector<RE::TESObjectREFR*> ConcatObjs(RE::StaticFunctionTag*,
+                                               const RE::reference_array<RE::TESObjectREFR*> akFirst,
+                                               const RE::reference_array<RE::TESObjectREFR*> akSecond) {
+        PAPER_PROFILE_SCOPE("Native.ConcatObjs", "native");
+        return Core::Concatenate<RE::TESObjectREFR*>(akFirst, akSecond);
+    }
+
+    /**
+     * Returns the forms at the indices [aiStart, aiEnd) of the given array. A negative end means the end
+     * of the array.
+     */
+    std::vector<RE::TESForm*> SliceForms(RE::StaticFunctionTag*, const RE::reference_array<RE::TESForm*> akForms,
+                                         std::int32_t aiStart, std::int32_t aiEnd) {
+        PAPER_PROFILE_SCOPE("Native.SliceForms", "native");
+        return Core::Slice<RE::TESForm*>(akForms, aiStart, aiEnd);
+    }
+
+    /**
+     * Returns the ints at the indices [aiStart, aiEnd) of the given array. A negative end means the end
+     * of the array.
+     */
+    std::vector<std::int32_t> SliceInts(RE::StaticFunctionTag*, const RE::reference_array<std::int32_t> aiValues,
+                                        std::int32_t aiStart, std::int32_t aiEnd) {
+        PAPER_PROFILE_SCOPE("Native.SliceInts", "native");
+        return Core::Slice<std::int32_t>(aiValues, aiStart, aiEnd);
+    }
+
+    /**
+     * Returns the references at the indices [aiStart, aiEnd) of the given array. A negative end means the
+     * end of the array.
+     */
+    std::vector<RE::TESObjectREFR*> SliceObjs(RE::StaticFunctionTag*,
+                                              const RE::reference_array<RE::TESObjectREFR*> akObjs,
+                                              std::int32_t aiStart, std::int32_t aiEnd) {
+        PAPER_PROFILE_SCOPE("Native.SliceObjs", "native");
+        return Core::Slice<RE::TESObjectREFR*>(akObjs, aiStart, aiEnd);
+    }
+
+    /**
+     * Returns the handle that the given reference has in the given VM, or 0 if no script is bound to it.
+     */
+    RE::VMHandle GetReferenceHandle(RE::SkyrimVM* vm, const RE::TESObjectREFR* reference) {
+        const auto handle =
+            vm->handlePolicy.GetHandleForObject(static_cast<RE::VMTypeID>(RE::FormType::Reference), reference);
+        return handle != vm->handlePolicy.EmptyHandle() ? handle : 0;
+    }
+
+    /**
+     * Returns the handle of the script object that called the native function running on the given stack:
+     * the object of the nearest frame that has one. If the native was called from a global function of a
+     * script without an object, returns the handle of the given reference instead.
+     */
+    RE::VMHandle GetCallerHandle(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                 const RE::TESObjectREFR* fallback) {
+        {
+            RE::BSSpinLockGuard locker(a_vm->runningStacksLock);
+            const auto it = a_vm->allRunningStacks.find(a_stackID);
+            if (it != a_vm->allRunningStacks.end() && it->second) {
+                for (auto frame = it->second->top; frame; frame = frame->previousFrame) {
+                    if (frame->self.IsObject()) {
+                        if (const auto object = frame->self.GetObject()) {
+                            return object->GetHandle();
+                        }
+                    }
+                }
+            }
+        }
+
+        const auto vm = RE::SkyrimVM::GetSingleton();
+        return vm ? GetReferenceHandle(vm, fallback) : 0;
+    }
+
+    /**
+     * Returns true if the given handle is that of the given reference, or of one of the aliases that it fills:
+     * the objects that the events of the reference are relayed to.
+     */
+    bool IsRelayTargetOf(RE::SkyrimVM* vm, const RE::TESObjectREFR* reference, RE::VMHandle handle) {
+        if (handle == GetReferenceHandle(vm, reference)) {
+            return true;
+        }
+
+        const auto aliases = reference->extraList.GetByType<RE::ExtraAliasInstanceArray>();
+        if (!aliases) {
+            return false;
+        }
+
+        RE::BSReadLockGuard locker(aliases->lock);
+        for (const auto instance : aliases->aliases) {
+            if (instance && instance->alias &&
+                vm->handlePolicy.GetHandleForObject(RE::BGSRefAlias::VMTYPEID, instance->alias) == handle) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Registers the object of the calling script, which must be the given container itself or one of its
+     * aliases, for OnBatchItemsTransferred events of the container. Moves between this container and another
+     * container are then no longer sent to the scripts attached to that object as OnBatchItemsAdded /
+     * OnBatchItemsRemoved events; scripts attached to the container's other objects still receive them.
+     */
+    void RegisterForBatchItemsTransferred(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                          RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer) {
+        PAPER_PROFILE_SCOPE("Native.RegisterForBatchItemsTransferred", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+
+        const auto receiver = GetCallerHandle(a_vm, a_stackID, akContainer);
+        if (receiver == 0) {
+            a_vm->TraceStack("No script to register for OnBatchItemsTransferred events", a_stackID);
+            return;
+        }
+
+        // Events of the container are only relayed to its own scripts and those of its aliases, so any other
+        // caller would lose the moves from its OnBatchItems* events without ever receiving the transfers
+        const auto vm = RE::SkyrimVM::GetSingleton();
+        if (!vm || !IsRelayTargetOf(vm, akContainer, receiver)) {
+            a_vm->TraceStack(
+                "RegisterForBatchItemsTransferred must be called from a script on akContainer or on one of its aliases",
+                a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().RegisterForItemsTransferred(
+            akContainer->formID, receiver);
+    }
+
+    /**
+     * Unregisters the object of the calling script from OnBatchItemsTransferred events of the given container.
+     */
+    void UnregisterForBatchItemsTransferred(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                            RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer) {
+        PAPER_PROFILE_SCOPE("Native.UnregisterForBatchItemsTransferred", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+
+        const auto receiver = GetCallerHandle(a_vm, a_stackID, akContainer);
+        if (receiver == 0) {
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().UnregisterForItemsTransferred(
+            akContainer->formID, receiver);
+    }
+
+    /**
+     * Makes the batched inventory events of the given container go before those of all other containers
+     * except the player and followers, when there are more than can be sent in one frame.
+     */
+    void RegisterForPriorityInventoryEvents(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                            RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer) {
+        PAPER_PROFILE_SCOPE("Native.RegisterForPriorityInventoryEvents", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().RegisterHighPriority(
+            akContainer->formID);
+    }
+
+    /**
+     * Makes the batched inventory events of the given container go in the same order as those of ordinary
+     * containers again.
+     */
+    void UnregisterForPriorityInventoryEvents(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                              RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer) {
+        PAPER_PROFILE_SCOPE("Native.UnregisterForPriorityInventoryEvents", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().UnregisterHighPriority(
+            akContainer->formID);
+    }
+
+    /**
+     * Sets how long the inventory events of the given container are batched up before they are sent to it:
+     * until the first of them is at least the given number of milliseconds old. A negative number of
+     * milliseconds makes the container use the batching window from PAPER.yaml again.
+     */
+    void SetInventoryBatchWindow(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                 RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer, std::int32_t aiMilliseconds) {
+        PAPER_PROFILE_SCOPE("Native.SetInventoryBatchWindow", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().SetBatchWindow(akContainer->formID,
+                                                                                                aiMilliseconds);
+    }
+
+    /**
+     * Registers the given form (e.g., a quest) for OnGlobalItemMovement events: one event per frame with
+     * the inventory changes of all containers in the world. If the filter contains any forms, only items
+     * that are in the filter (or in one of the form lists in it) are included.
+     */
+    void RegisterForGlobalItemMovement(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                       RE::StaticFunctionTag*, RE::TESForm* akReceiver,
+                                       const RE::reference_array<RE::TESForm*> akFilter) {
+        PAPER_PROFILE_SCOPE("Native.RegisterForGlobalItemMovement", "native");
+        if (!akReceiver) {
+            a_vm->TraceStack("akReceiver is None", a_stackID);
+            return;
+        }
+
+        Core::GlobalItemMovementFilter filter;
+        for (const auto form : akFilter) {
+            if (!form) {
+                continue;
+            }
+
+            if (form->Is(RE::FormType::FormList)) {
+                filter.itemLists.push_back(form->formID);
+            } else {
+                filter.items.push_back(form->formID);
+            }
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().RegisterForGlobalItemMovement(
+            akReceiver->formID, std::move(filter));
+    }
+
+    /**
+     * Unregisters the given form from OnGlobalItemMovement events.
+     */
+    void UnregisterForGlobalItemMovement(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                         RE::StaticFunctionTag*, RE::TESForm* akReceiver) {
+        PAPER_PROFILE_SCOPE("Native.UnregisterForGlobalItemMovement", "native");
+        if (!akReceiver) {
+            a_vm->TraceStack("akReceiver is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().UnregisterForGlobalItemMovement(
+            akReceiver->formID);
+    }
+
+    /**
+     * Watches the count of the given item in the given container. Whenever the count goes from below the
+     * threshold to at least the threshold (or the other way around), the container receives an
+     * OnItemCountThresholdCrossed event. The count is read from the inventory once, and kept up to date
+     * from inventory events after that.
+     */
+    void WatchItemCount(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                        RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer, RE::TESForm* akBaseItem,
+                        std::int32_t aiThreshold) {
+        PAPER_PROFILE_SCOPE("Native.WatchItemCount", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+        if (!akBaseItem) {
+            a_vm->TraceStack("akBaseItem is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().WatchItemCount(
+            akContainer->formID, akBaseItem->formID, aiThreshold);
+    }
+
+    /**
+     * Stops watching the count of the given item in the given container for the given threshold.
+     */
+    void UnwatchItemCount(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                          RE::StaticFunctionTag*, RE::TESObjectREFR* akContainer, RE::TESForm* akBaseItem,
+                          std::int32_t aiThreshold) {
+        PAPER_PROFILE_SCOPE("Native.UnwatchItemCount", "native");
+        if (!akContainer) {
+            a_vm->TraceStack("akContainer is None", a_stackID);
+            return;
+        }
+        if (!akBaseItem) {
+            a_vm->TraceStack("akBaseItem is None", a_stackID);
+            return;
+        }
+
+        OnContainerChangedEvents::OnContainerChangedEventHandler::GetSingleton().UnwatchItemCount(
+            akContainer->formID, akBaseItem->formID, aiThreshold);
+    }
+
+    /**
+     * Adds a filter for the OnBatchMagicEffectsApplied events of the given target: a magic effect, or a form
+     * list of magic effects. Once a target has any filters, only effects that pass one of them are sent to it.
+     */
+    void AddBatchMagicEffectsFilter(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                    RE::StaticFunctionTag*, RE::TESObjectREFR* akTarget, RE::TESForm* akFilter) {
+        PAPER_PROFILE_SCOPE("Native.AddBatchMagicEffectsFilter", "native");
+        if (!akTarget) {
+            a_vm->TraceStack("akTarget is None", a_stackID);
+            return;
+        }
+        if (!akFilter) {
+            a_vm->TraceStack("akFilter is None", a_stackID);
+            return;
+        }
+
+        OnMagicEffectApplyEvents::OnMagicEffectApplyEventHandler::GetSingleton().GetDefinition().AddFilter(
+            akTarget->formID, akFilter->formID);
+    }
+
+    /**
+     * Removes all filters for the OnBatchMagicEffectsApplied events of the given target.
+     */
+    void RemoveAllBatchMagicEffectsFilters(RE::BSScript::Internal::VirtualMachine* a_vm, RE::VMStackID a_stackID,
+                                           RE::StaticFunctionTag*, RE::TESObjectREFR* akTarget) {
+        PAPER_PROFILE_SCOPE("Native.RemoveAllBatchMagicEffectsFilters", "native");
+        if (!akTarget) {
+            a_vm->TraceStack("akTarget is None", a_stackID);
+            return;
+        }
+
+        OnMagicEffectApplyEvents::OnMagicEffectApplyEventHandler::GetSingleton().GetDefinition().RemoveAllFilters(
+            akTarget->formID);
+    }
+
+    /**
+     * Returns the performance counters and latency histograms of PAPER, one line per event handler / histogram.
+     */
+    std::vector<std::string> GetPaperStats(RE::StaticFunctionTag*) {
+        return PerfStats::PerfStatsRegistry::GetSingleton().Report();
+    }
+
+    /**
+     * Enables or disables recording of performance counters and latency histograms.
+     */
+    void SetPaperStatsEnabled(RE::StaticFunctionTag*, bool abEnabled) {
+        PerfStats::PerfStatsRegistry::GetSingleton().SetEnabled(abEnabled);
+    }
+
+    /**
+     * Resets all performance counters and latency histograms to zero.
+     */
+    void ResetPaperStats(RE::StaticFunctionTag*) { PerfStats::PerfStatsRegistry::GetSingleton().Reset(); }
+
+    /**
+     * Enables or disables recording of trace spans.
+     */
+    void SetPaperTracingEnabled(RE::StaticFunctionTag*, bool abEnabled) {
+        Tracing::TraceRecorder::GetSingleton().SetEnabled(abEnabled);
+    }
+
+    /**
+     * Sets the frame time (in milliseconds) above which the recorded trace is written to a file
+     * automatically. 0 disables writing traces on slow frames.
+     */
+    void SetPaperSlowFrameThreshold(RE::StaticFunctionTag*, float afMilliseconds) {
+        Tracing::TraceRecorder::GetSingleton().SetSlowFrameThreshold(
+            std::chrono::microseconds(static_cast<std::int64_t>(std::max(afMilliseconds, 0.0f) * 1000.0f)));
+    }
+
+    /**
+     * Writes the recorded trace to a file in the SKSE log directory, and returns the file's name
+     * (or an empty string if nothing was recorded).
+     */
+    std::string DumpPaperTrace(RE::StaticFunctionTag*) {
+        return Tracing::TraceRecorder::GetSingleton().Flush("manual").filename().string();
+    }
+
+    /**
+     * Sets the level of log messages written for the given category (Global, Events, Cosave, Stats, Trace,
+     * or an empty string for all of them), from 0 (trace) to 6 (off). Returns false if there is no such category.
+     */
+    bool SetPaperLogLevel(RE::StaticFunctionTag*, std::string asCategory, std::int32_t aiLevel) {
+        const auto level = static_cast<spdlog::level::level_enum>(std::clamp(aiLevel, 0, 6));
+        return Logging::SetLevel(asCategory, level);
+    }
+
+    /**
+     * Reloads Data/SKSE/Plugins/PAPER.yaml. Returns false (and keeps the current settings)
+     * if the file is missing or invalid.
+     */
+    bool ReloadPaperSettings(RE::StaticFunctionTag*) { return SettingsLoader::Load(); }
+
+    /**
+     * Starts recording the engine events that PAPER receives to a new file in the SKSE log directory,
+     * and returns the file's name (or an empty string if it could not be created).
+     */
+    std::string StartPaperEventRecording(RE::StaticFunctionTag*) {
+        return Recording::EventRecorder::GetSingleton().Start().filename().string();
+    }
+
+    /**
+     * Stops recording engine events.
+     */
+    void StopPaperEventRecording(RE::StaticFunctionTag*) { Recording::EventRecorder::GetSingleton().Stop(); }
+
 	/**
 	 * Provide bindings for all our Papyrus functions.
 	 */
@@ -213,9 +958,23 @@ namespace PAPER {
         // Resources
         vm->RegisterFunction("ResourceExists", PaperSKSEFunctions, ResourceExists, true);
         vm->RegisterFunction("GetInstalledResources", PaperSKSEFunctions, GetInstalledResources, false);
+        vm->RegisterFunction("ValidateFormAssets", PaperSKSEFunctions, ValidateFormAssets, false);
 
         // ActorBase
 		vm->RegisterFunction("GetWarpaintColors", PaperSKSEFunctions, GetWarpaintColors, false);
+        vm->RegisterFunction("RegisterForWarpaintChanged", PaperSKSEFunctions, RegisterForWarpaintChanged, false);
+        vm->RegisterFunction("UnregisterForWarpaintChanged", PaperSKSEFunctions, UnregisterForWarpaintChanged, false);
+        vm->RegisterFunction("RecheckWarpaint", PaperSKSEFunctions, RecheckWarpaint, false);
+
+        // Actor
+        vm->RegisterFunction("GetEquippedSpellsForActors", PaperSKSEFunctions, GetEquippedSpellsForActors, false);
+        vm->RegisterFunction("GetEquippedShoutsForActors", PaperSKSEFunctions, GetEquippedShoutsForActors, false);
+
+        // Hit telemetry
+        vm->RegisterFunction("GetRecentAttackers", PaperSKSEFunctions, GetRecentAttackers, false);
+        vm->RegisterFunction("GetHitRate", PaperSKSEFunctions, GetHitRate, false);
+        vm->RegisterFunction("GetBlockedHitRatio", PaperSKSEFunctions, GetBlockedHitRatio, false);
+        vm->RegisterFunction("GetPowerAttackStreak", PaperSKSEFunctions, GetPowerAttackStreak, false);
 
         // Helper functions for filtering arguments of Inventory Events
         vm->RegisterFunction("GetInventoryEventFilterIndices", PaperSKSEFunctions, GetInventoryEventFilterIndices,
@@ -229,8 +988,67 @@ namespace PAPER {
         vm->RegisterFunction("ApplyInventoryEventFilterToObjs", PaperSKSEFunctions, ApplyInventoryEventFilterToObjs,
                              false);
 
+        // Helper functions for grouping arguments of Inventory Events
+        vm->RegisterFunction("GroupInventoryEventByFormType", PaperSKSEFunctions, GroupInventoryEventByFormType, false);
+        vm->RegisterFunction("GetInventoryEventGroupOffsetsByFormType", PaperSKSEFunctions,
+                             GetInventoryEventGroupOffsetsByFormType, false);
+        vm->RegisterFunction("GroupInventoryEventBySource", PaperSKSEFunctions, GroupInventoryEventBySource, false);
+        vm->RegisterFunction("GetInventoryEventGroupOffsetsBySource", PaperSKSEFunctions,
+                             GetInventoryEventGroupOffsetsBySource, false);
+        vm->RegisterFunction("GroupInventoryEventByKeyword", PaperSKSEFunctions, GroupInventoryEventByKeyword, false);
+        vm->RegisterFunction("GetInventoryEventGroupOffsetsByKeyword", PaperSKSEFunctions,
+                             GetInventoryEventGroupOffsetsByKeyword, false);
+
+        // Helper functions for arrays of Batched Events (pure functions of their arguments, so no-wait)
+        vm->RegisterFunction("SumInts", PaperSKSEFunctions, SumInts, true);
+        vm->RegisterFunction("GetUniqueForms", PaperSKSEFunctions, GetUniqueForms, true);
+        vm->RegisterFunction("SumIntsByForm", PaperSKSEFunctions, SumIntsByForm, true);
+        vm->RegisterFunction("FindAllForms", PaperSKSEFunctions, FindAllForms, true);
+        vm->RegisterFunction("FindAllObjs", PaperSKSEFunctions, FindAllObjs, true);
+        vm->RegisterFunction("SortIndicesByInts", PaperSKSEFunctions, SortIndicesByInts, true);
+        vm->RegisterFunction("ConcatForms", PaperSKSEFunctions, ConcatForms, true);
+        vm->RegisterFunction("ConcatInts", PaperSKSEFunctions, ConcatInts, true);
+        vm->RegisterFunction("ConcatObjs", PaperSKSEFunctions, ConcatObjs, true);
+        vm->RegisterFunction("SliceForms", PaperSKSEFunctions, SliceForms, true);
+        vm->RegisterFunction("SliceInts", PaperSKSEFunctions, SliceInts, true);
+        vm->RegisterFunction("SliceObjs", PaperSKSEFunctions, SliceObjs, true);
+
+        // Registrations for Inventory Events
+        vm->RegisterFunction("RegisterForBatchItemsTransferred", PaperSKSEFunctions, RegisterForBatchItemsTransferred,
+                             false);
+        vm->RegisterFunction("UnregisterForBatchItemsTransferred", PaperSKSEFunctions,
+                             UnregisterForBatchItemsTransferred, false);
+        vm->RegisterFunction("SetInventoryBatchWindow", PaperSKSEFunctions, SetInventoryBatchWindow, false);
+        vm->RegisterFunction("RegisterForPriorityInventoryEvents", PaperSKSEFunctions,
+                             RegisterForPriorityInventoryEvents, false);
+        vm->RegisterFunction("UnregisterForPriorityInventoryEvents", PaperSKSEFunctions,
+                             UnregisterForPriorityInventoryEvents, false);
+        vm->RegisterFunction("RegisterForGlobalItemMovement", PaperSKSEFunctions, RegisterForGlobalItemMovement,
+                             false);
+        vm->RegisterFunction("UnregisterForGlobalItemMovement", PaperSKSEFunctions, UnregisterForGlobalItemMovement,
+                             false);
+        vm->RegisterFunction("WatchItemCount", PaperSKSEFunctions, WatchItemCount, false);
+        vm->RegisterFunction("UnwatchItemCount", PaperSKSEFunctions, UnwatchItemCount, false);
+
+        // Filters for Magic Effect Events
+        vm->RegisterFunction("AddBatchMagicEffectsFilter", PaperSKSEFunctions, AddBatchMagicEffectsFilter, true);
+        vm->RegisterFunction("RemoveAllBatchMagicEffectsFilters", PaperSKSEFunctions,
+                             RemoveAllBatchMagicEffectsFilters, true);
+
+        // Performance stats
+        vm->RegisterFunction("GetPaperStats", PaperSKSEFunctions, GetPaperStats, true);
+        vm->RegisterFunction("SetPaperStatsEnabled", PaperSKSEFunctions, SetPaperStatsEnabled, true);
+        vm->RegisterFunction("ResetPaperStats", PaperSKSEFunctions, ResetPaperStats, true);
+        vm->RegisterFunction("SetPaperTracingEnabled", PaperSKSEFunctions, SetPaperTracingEnabled, true);
+        vm->RegisterFunction("SetPaperSlowFrameThreshold", PaperSKSEFunctions, SetPaperSlowFrameThreshold, true);
+        vm->RegisterFunction("DumpPaperTrace", PaperSKSEFunctions, DumpPaperTrace, false);
+        vm->RegisterFunction("StartPaperEventRecording", PaperSKSEFunctions, StartPaperEventRecording, false);
+        vm->RegisterFunction("StopPaperEventRecording", PaperSKSEFunctions, StopPaperEventRecording, false);
+
         // Other
         vm->RegisterFunction("GetPaperVersion", PaperSKSEFunctions, GetPaperVersion, true);
+        vm->RegisterFunction("SetPaperLogLevel", PaperSKSEFunctions, SetPaperLogLevel, true);
+        vm->RegisterFunction("ReloadPaperSettings", PaperSKSEFunctions, ReloadPaperSettings, false);
 
         return true;
     }
@@ -0,0 +1,171 @@
+#include <Logging.h>
+#include <PerfStats.h>
+
+#include <algorithm>
+#include <bit>
+
+using namespace PerfStats;
+
+namespace {
+    constexpr std::string_view HandlerNames[] = {"ContainerChanged", "Equip", "Hit", "MagicEffectApply"};
+
+    std::string FormatMicroseconds(std::uint64_t nanoseconds) {
+        return spdlog::fmt_lib::format("{:.1f}us", static_cast<double>(nanoseconds) / 1000.0);
+    }
+}
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t nanoseconds) {
+    if (nanoseconds < SubBucketCount) {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+
+    // The top SubBucketBits + 1 bits of the value select the bucket within its power of two
+    const unsigned msb = static_cast<unsigned>(std::bit_width(nanoseconds)) - 1;
+    const unsigned shift = msb - SubBucketBits;
+    const auto subBucket = (nanoseconds >> shift) - SubBucketCount;
+    return static_cast<std::size_t>((shift + 1) * SubBucketCount + subBucket);
+}
+
+std::uint64_t LatencyHistogram::BucketUpperBound(std::size_t index) {
+    if (index < SubBucketCount) {
+        return index;
+    }
+
+    const auto shift = static_cast<unsigned>(index / SubBucketCount) - 1;
+    const auto subBucket = index % SubBucketCount;
+    return ((SubBucketCount + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::uint64_t nanoseconds) {
+    buckets[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto currentMax = max.load(std::memory_order_relaxed);
+    while (nanoseconds > currentMax &&
+           !max.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t LatencyHistogram::Mean() const {
+    const auto n = Count();
+    return n > 0 ? totalNanoseconds.load(std::memory_order_relaxed) / n : 0;
+}
+
+std::uint64_t LatencyHistogram::Percentile(double fraction) const {
+    const auto n = Count();
+    if (n == 0) {
+        return 0;
+    }
+
+    const auto target = static_cast<std::uint64_t>(fraction * static_cast<double>(n));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < NumBuckets; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            return std::min(BucketUpperBound(i), Max());
+        }
+    }
+
+    return Max();
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    totalNanoseconds.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+PerfStatsRegistry& PerfStatsRegistry::GetSingleton() noexcept {
+    static PerfStatsRegistry instance;
+    return instance;
+}
+
+LatencyHistogram& PerfStatsRegistry::Histogram(std::string_view name) {
+    std::lock_guard<std::mutex> lockGuard(histogramsMutex);
+
+    for (auto& namedHistogram : histograms) {
+        if (namedHistogram.name == name) {
+            return namedHistogram.histogram;
+        }
+    }
+
+    return histograms.emplace_back(name).histogram;
+}
+
+std::vector<std::string> PerfStatsRegistry::Report() const {
+    std::vector<std::string> lines;
+
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+        const auto& handlerCounters = counters[i];
+        lines.push_back(spdlog::fmt_lib::format(
+            "{}: seen={} dispatched={} filtered={} variables={}", HandlerNames[i],
+            handlerCounters.eventsSeen.load(std::memory_order_relaxed),
+            handlerCounters.eventsDispatched.load(std::memory_order_relaxed),
+            handlerCounters.eventsFiltered.load(std::memory_order_relaxed),
+            handlerCounters.variablesPacked.load(std::memory_order_relaxed)));
+    }
+
+    std::lock_guard<std::mutex> lockGuard(histogramsMutex);
+    for (const auto& namedHistogram : histograms) {
+        const auto& histogram = namedHistogram.histogram;
+        if (histogram.Count() == 0) {
+            continue;
+        }
+
+        lines.push_back(spdlog::fmt_lib::format(
+            "{}: n={} mean={} p50={} p99={} max={}", namedHistogram.name, histogram.Count(),
+            FormatMicroseconds(histogram.Mean()), FormatMicroseconds(histogram.Percentile(0.5)),
+            FormatMicroseconds(histogram.Percentile(0.99)), FormatMicroseconds(histogram.Max())));
+    }
+
+    return lines;
+}
+
+void PerfStatsRegistry::Reset() {
+    for (auto& handlerCounters : counters) {
+        handlerCounters.eventsSeen.store(0, std::memory_order_relaxed);
+        handlerCounters.eventsDispatched.store(0, std::memory_order_relaxed);
+        handlerCounters.eventsFiltered.store(0, std::memory_order_relaxed);
+        handlerCounters.variablesPacked.store(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lockGuard(histogramsMutex);
+    for (auto& namedHistogram : histograms) {
+        namedHistogram.histogram.Reset();
+    }
+}
+
+void PerfStatsRegistry::SetDumpInterval(std::chrono::seconds interval) {
+    dumpIntervalNanoseconds.store(std::chrono::nanoseconds(interval).count(), std::memory_order_relaxed);
+    nextDumpNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+void PerfStatsRegistry::MaybeDumpToLog(std::chrono::steady_clock::time_point now) {
+    const auto interval = dumpIntervalNanoseconds.load(std::memory_order_relaxed);
+    if (interval <= 0) {
+        return;
+    }
+
+    const auto nowNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    auto nextDump = nextDumpNanoseconds.load(std::memory_order_relaxed);
+    if (nextDump == 0) {
+        // First call since the interval was (re)set: start counting from now
+        nextDumpNanoseconds.compare_exchange_strong(nextDump, nowNanoseconds + interval, std::memory_order_relaxed);
+        return;
+    }
+
+    if (nowNanoseconds < nextDump ||
+        !nextDumpNanoseconds.compare_exchange_strong(nextDump, nowNanoseconds + interval,
+                                                     std::memory_order_relaxed)) {
+        // Not time yet, or another thread is already dumping
+        return;
+    }
+
+    for (const auto& line : Report()) {
+        Logging::info(Logging::Category::kStats, "{}", line);
+    }
+}
@@ -0,0 +1,19 @@
+#include <Settings.h>
+
+using namespace Core;
+
+SettingsStore::SettingsStore() {
+    snapshots.push_back(std::make_unique<const Settings>());
+    current.store(snapshots.back().get(), std::memory_order_release);
+}
+
+SettingsStore& SettingsStore::GetSingleton() noexcept {
+    static SettingsStore instance;
+    return instance;
+}
+
+void SettingsStore::Publish(Settings settings) {
+    std::lock_guard<std::mutex> lockGuard(publishMutex);
+    snapshots.push_back(std::make_unique<const Settings>(std::move(settings)));
+    current.store(snapshots.back().get(), std::memory_order_release);
+}
@@ -0,0 +1,145 @@
+#include <SettingsLoader.h>
+#include <Logging.h>
+#include <PerfStats.h>
+#include <TraceRecorder.h>
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+
+namespace {
+    /**
+     * Error callback for rapidyaml, which would otherwise abort the game on malformed files.
+     */
+    [[noreturn]] void OnYamlError(const char* msg, std::size_t length, ryml::Location location, void*) {
+        throw std::runtime_error(std::format("line {}: {}", location.line, std::string_view(msg, length)));
+    }
+
+    /**
+     * Reads the value of the given key of a map node into value, if the key is there.
+     */
+    template <class T>
+    void ReadSetting(ryml::ConstNodeRef node, ryml::csubstr key, T& value) {
+        if (node.is_map() && node.has_child(key)) {
+            node[key] >> value;
+        }
+    }
+
+    Core::Settings ParseSettings(std::string& contents) {
+        Core::Settings settings;
+
+        const ryml::Tree tree = ryml::parse_in_place(ryml::to_substr(contents));
+        const auto root = tree.crootref();
+        if (!root.is_map()) {
+            return settings;
+        }
+
+        if (root.has_child("inventoryEvents")) {
+            const auto node = root["inventoryEvents"];
+            auto& inventoryEvents = settings.inventoryEvents;
+            ReadSetting(node, "enabled", inventoryEvents.enabled);
+            ReadSetting(node, "batchWindowFrames", inventoryEvents.batchWindowFrames);
+            ReadSetting(node, "batchWindowMilliseconds", inventoryEvents.batchWindowMilliseconds);
+            ReadSetting(node, "maxBatchSize", inventoryEvents.maxBatchSize);
+            ReadSetting(node, "maxContainersPerFrame", inventoryEvents.maxContainersPerFrame);
+            ReadSetting(node, "maxEventsPerContainer", inventoryEvents.maxEventsPerContainer);
+            ReadSetting(node, "parallelPreparationThreshold", inventoryEvents.parallelPreparationThreshold);
+        }
+
+        if (root.has_child("equipEvents")) {
+            const auto node = root["equipEvents"];
+            auto& equipEvents = settings.equipEvents;
+            ReadSetting(node, "enabled", equipEvents.enabled);
+            ReadSetting(node, "suppressLoadStorms", equipEvents.suppressLoadStorms);
+            ReadSetting(node, "loadSuppressionFrames", equipEvents.loadSuppressionFrames);
+            ReadSetting(node, "summarizeLoadChanges", equipEvents.summarizeLoadChanges);
+        }
+
+        if (root.has_child("hitEvents")) {
+            const auto node = root["hitEvents"];
+            ReadSetting(node, "enabled", settings.hitEvents.enabled);
+            ReadSetting(node, "deduplicateSameFrame", settings.hitEvents.deduplicateSameFrame);
+            ReadSetting(node, "telemetryEnabled", settings.hitEvents.telemetryEnabled);
+            ReadSetting(node, "telemetryPairs", settings.hitEvents.telemetryPairs);
+        }
+
+        if (root.has_child("magicEffectEvents")) {
+            ReadSetting(root["magicEffectEvents"], "enabled", settings.magicEffectEvents.enabled);
+        }
+
+        if (root.has_child("instrumentation")) {
+            const auto node = root["instrumentation"];
+            auto& instrumentation = settings.instrumentation;
+            ReadSetting(node, "stats", instrumentation.statsEnabled);
+            ReadSetting(node, "statsDumpIntervalSeconds", instrumentation.statsDumpIntervalSeconds);
+            ReadSetting(node, "tracing", instrumentation.tracingEnabled);
+            ReadSetting(node, "slowFrameThresholdMs", instrumentation.slowFrameThresholdMilliseconds);
+        }
+
+        if (root.has_child("logLevels") && root["logLevels"].is_map()) {
+            for (const auto child : root["logLevels"].children()) {
+                std::string category(child.key().str, child.key().len);
+                std::string level;
+                child >> level;
+                settings.logLevels.emplace_back(std::move(category), std::move(level));
+            }
+        }
+
+        return settings;
+    }
+
+    /**
+     * Applies the settings that are not read from the hot paths, but pushed to their owners.
+     */
+    void ApplySettings(const Core::Settings& settings) {
+        const auto& instrumentation = settings.instrumentation;
+
+        auto& perfStats = PerfStats::PerfStatsRegistry::GetSingleton();
+        perfStats.SetEnabled(instrumentation.statsEnabled);
+        perfStats.SetDumpInterval(std::chrono::seconds(instrumentation.statsDumpIntervalSeconds));
+
+        auto& traceRecorder = Tracing::TraceRecorder::GetSingleton();
+        traceRecorder.SetEnabled(instrumentation.tracingEnabled);
+        traceRecorder.SetSlowFrameThreshold(std::chrono::microseconds(
+            static_cast<std::int64_t>(std::max(instrumentation.slowFrameThresholdMilliseconds, 0.0f) * 1000.0f)));
+
+        for (const auto& [category, levelName] : settings.logLevels) {
+            const auto level = spdlog::level::from_str(levelName);
+            if (!Logging::SetLevel(category, level)) {
+                Logging::warn(Logging::Category::kGeneral, "Unknown logging category {} in {}.", category,
+                              SettingsLoader::SettingsPath);
+            }
+        }
+    }
+}
+
+bool SettingsLoader::Load() {
+    std::ifstream file(SettingsPath, std::ios::in | std::ios::binary);
+    if (!file) {
+        Logging::info(Logging::Category::kGeneral, "No {} found, using default settings.", SettingsPath);
+        return false;
+    }
+
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Core::Settings settings;
+    try {
+        const auto previousCallbacks = ryml::get_callbacks();
+        ryml::set_callbacks(ryml::Callbacks(nullptr, nullptr, nullptr, OnYamlError));
+        try {
+            settings = ParseSettings(contents);
+        } catch (...) {
+            ryml::set_callbacks(previousCallbacks);
+            throw;
+        }
+        ryml::set_callbacks(previousCallbacks);
+    } catch (const std::exception& e) {
+        Logging::error(Logging::Category::kGeneral, "Unable to parse {}, keeping the current settings: {}",
+                       SettingsPath, e.what());
+        return false;
+    }
+
+    ApplySettings(settings);
+    Core::SettingsStore::GetSingleton().Publish(std::move(settings));
+    Logging::info(Logging::Category::kGeneral, "Loaded settings from {}.", SettingsPath);
+    return true;
+}
@@ -0,0 +1,186 @@
+#include <Logging.h>
+#include <TraceRecorder.h>
+
+#include <fstream>
+#include <thread>
+
+using namespace Tracing;
+
+namespace {
+    /** Don't flush more than once per this many seconds because of slow frames */
+    constexpr auto SlowFrameFlushCooldown = std::chrono::seconds(10);
+
+    struct ThreadEvents {
+        std::uint32_t threadID;
+        std::string threadName;
+        std::vector<TraceEvent> events;
+    };
+
+    void WriteJsonString(std::ofstream& out, std::string_view str) {
+        out << '"';
+        for (const auto c : str) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    /**
+     * Writes the events in Chrome's trace_event JSON format. Timestamps are in microseconds.
+     */
+    void WriteTraceFile(const std::filesystem::path& path, const std::vector<ThreadEvents>& threads) {
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out) {
+            Logging::error(Logging::Category::kTrace, "Unable to open trace file {} for writing.", path.string());
+            return;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+
+        for (const auto& thread : threads) {
+            if (!thread.threadName.empty()) {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                    << thread.threadID << ",\"args\":{\"name\":";
+                WriteJsonString(out, thread.threadName);
+                out << "}}";
+                first = false;
+            }
+
+            for (const auto& event : thread.events) {
+                out << (first ? "" : ",") << "\n{\"name\":";
+                WriteJsonString(out, event.name);
+                out << ",\"cat\":";
+                WriteJsonString(out, event.category);
+                out << ",\"pid\":1,\"tid\":" << thread.threadID
+                    << ",\"ts\":" << static_cast<double>(event.startNanoseconds) / 1000.0;
+
+                if (event.durationNanoseconds >= 0) {
+                    out << ",\"ph\":\"X\",\"dur\":" << static_cast<double>(event.durationNanoseconds) / 1000.0 << "}";
+                } else {
+                    out << ",\"ph\":\"i\",\"s\":\"g\"}";
+                }
+                first = false;
+            }
+        }
+
+        out << "\n]}\n";
+        Logging::info(Logging::Category::kTrace, "Wrote trace file {}.", path.string());
+    }
+}
+
+void ThreadTraceBuffer::Push(const TraceEvent& event) {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    events[numWritten % Capacity] = event;
+    ++numWritten;
+}
+
+void ThreadTraceBuffer::CopyTo(std::vector<TraceEvent>& out) const {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+
+    const auto numEvents = numWritten < Capacity ? numWritten : Capacity;
+    out.reserve(out.size() + numEvents);
+    for (auto i = numWritten - numEvents; i < numWritten; ++i) {
+        out.push_back(events[i % Capacity]);
+    }
+}
+
+void ThreadTraceBuffer::Clear() {
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    numWritten = 0;
+}
+
+TraceRecorder& TraceRecorder::GetSingleton() noexcept {
+    static TraceRecorder instance;
+    return instance;
+}
+
+void TraceRecorder::SetEnabled(bool enable) {
+    if (enable && !IsEnabled()) {
+        // Start with a clean slate, so old events don't end up in new traces
+        std::lock_guard<std::mutex> lockGuard(threadBuffersMutex);
+        for (auto& threadBuffer : threadBuffers) {
+            threadBuffer->Clear();
+        }
+    }
+
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void TraceRecorder::SetOutputDirectory(std::filesystem::path directory) {
+    std::lock_guard<std::mutex> lockGuard(threadBuffersMutex);
+    outputDirectory = std::move(directory);
+}
+
+void TraceRecorder::SetSlowFrameThreshold(std::chrono::microseconds threshold) {
+    slowFrameThresholdNanoseconds.store(std::chrono::nanoseconds(threshold).count(), std::memory_order_relaxed);
+}
+
+ThreadTraceBuffer& TraceRecorder::GetThreadBuffer() {
+    thread_local ThreadTraceBuffer* threadBuffer = nullptr;
+
+    if (!threadBuffer) {
+        std::lock_guard<std::mutex> lockGuard(threadBuffersMutex);
+        threadBuffers.push_back(std::make_unique<ThreadTraceBuffer>(static_cast<std::uint32_t>(threadBuffers.size())));
+        threadBuffer = threadBuffers.back().get();
+    }
+
+    return *threadBuffer;
+}
+
+void TraceRecorder::RecordSpan(const char* name, const char* category, std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end) {
+    GetThreadBuffer().Push({name, category, ToTraceTime(start), ToTraceTime(end) - ToTraceTime(start)});
+}
+
+void TraceRecorder::OnFrameBoundary() {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    auto& threadBuffer = GetThreadBuffer();
+    if (threadBuffer.threadName.empty()) {
+        std::lock_guard<std::mutex> lockGuard(threadBuffersMutex);
+        threadBuffer.threadName = "Main thread";
+    }
+    threadBuffer.Push({"Frame", "frame", ToTraceTime(now), -1});
+
+    const auto threshold = std::chrono::nanoseconds(slowFrameThresholdNanoseconds.load(std::memory_order_relaxed));
+    if (threshold.count() > 0 && lastFrameBoundary.time_since_epoch().count() != 0 &&
+        now - lastFrameBoundary > threshold && now - lastSlowFrameFlush > SlowFrameFlushCooldown) {
+        lastSlowFrameFlush = now;
+        Flush("slowframe");
+    }
+
+    lastFrameBoundary = now;
+}
+
+std::filesystem::path TraceRecorder::Flush(const char* reason) {
+    std::vector<ThreadEvents> threads;
+    std::filesystem::path path;
+
+    {
+        std::lock_guard<std::mutex> lockGuard(threadBuffersMutex);
+
+        std::size_t numEvents = 0;
+        for (const auto& threadBuffer : threadBuffers) {
+            auto& thread = threads.emplace_back(threadBuffer->threadID, threadBuffer->threadName);
+            threadBuffer->CopyTo(thread.events);
+            numEvents += thread.events.size();
+        }
+
+        if (numEvents == 0) {
+            return {};
+        }
+
+        path = outputDirectory / ("PAPER_trace_" + std::to_string(numFlushes.fetch_add(1)) + "_" + reason + ".json");
+    }
+
+    // Formatting and writing the file can take a while, so don't make the game wait for it
+    std::thread([path, threads = std::move(threads)]() { WriteTraceFile(path, threads); }).detach();
+
+    return path;
+}
@@ -0,0 +1,151 @@
+#include <VMHandleCache.h>
+#include <Logging.h>
+#include <SKSE/SKSE.h>
+
+using namespace VMHandles;
+
+namespace {
+    /** Number of bits of the generation we store in the keys of cache entries */
+    constexpr std::uint32_t GenerationBits = 24;
+    constexpr std::uint32_t GenerationMask = (1u << GenerationBits) - 1;
+
+    /**
+     * Hooks for the virtual functions of the VM's handle policy that change
+     * which handles are valid.
+     */
+    struct PersistHandleHook {
+        static void thunk(RE::BSScript::IObjectHandlePolicy* a_policy, RE::VMHandle a_handle) {
+            func(a_policy, a_handle);
+            VMHandleCache::GetSingleton().InvalidateHandle(a_handle);
+        }
+
+        static inline REL::Relocation<decltype(thunk)> func;
+        static constexpr std::size_t idx = 0x9;
+    };
+
+    struct ReleaseHandleHook {
+        static void thunk(RE::BSScript::IObjectHandlePolicy* a_policy, RE::VMHandle a_handle) {
+            func(a_policy, a_handle);
+            VMHandleCache::GetSingleton().InvalidateHandle(a_handle);
+        }
+
+        static inline REL::Relocation<decltype(thunk)> func;
+        static constexpr std::size_t idx = 0xA;
+    };
+}
+
+VMHandleCache& VMHandleCache::GetSingleton() noexcept {
+    static VMHandleCache instance;
+    return instance;
+}
+
+std::size_t VMHandleCache::GetEntryIndex(RE::VMTypeID typeID, RE::FormID formID) {
+    // Fibonacci hashing of the form ID, with the type mixed in
+    const auto hash = (static_cast<std::uint64_t>(formID) ^ (static_cast<std::uint64_t>(typeID) << 24)) *
+                      0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(hash >> 52) & (NumEntries - 1);
+}
+
+std::uint64_t VMHandleCache::MakeKey(RE::VMTypeID typeID, RE::FormID formID) const {
+    const auto currentGeneration = generation.load(std::memory_order_acquire) & GenerationMask;
+    return (static_cast<std::uint64_t>(currentGeneration) << 40) | (static_cast<std::uint64_t>(typeID & 0xFF) << 32) |
+           static_cast<std::uint64_t>(formID);
+}
+
+RE::VMHandle VMHandleCache::GetHandleForObject(RE::SkyrimVM* vm, RE::VMTypeID typeID, const RE::TESForm* form) {
+    const auto key = MakeKey(typeID, form->formID);
+    auto& entry = entries[GetEntryIndex(typeID, form->formID)];
+
+    const auto sequenceBefore = entry.sequence.load(std::memory_order_acquire);
+    if ((sequenceBefore & 1) == 0) {
+        const auto cachedKey = entry.key.load(std::memory_order_relaxed);
+        const auto cachedHandle = entry.handle.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (cachedKey == key && entry.sequence.load(std::memory_order_relaxed) == sequenceBefore) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return cachedHandle;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    const auto handle = vm->handlePolicy.GetHandleForObject(typeID, form);
+
+    if (handle && handle != vm->handlePolicy.EmptyHandle()) {
+        // Only fill the entry if no other thread is writing it at the same time
+        auto sequence = entry.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) == 0 &&
+            entry.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+            entry.key.store(key, std::memory_order_relaxed);
+            entry.handle.store(handle, std::memory_order_relaxed);
+            entry.sequence.store(sequence + 2, std::memory_order_release);
+        }
+    }
+
+    return handle;
+}
+
+void VMHandleCache::InvalidateHandle(RE::VMHandle handle) {
+    // Handles for forms hold the form ID in their low 32 bits, and the VM type above that.
+    // Handles for anything else simply will not match the entry we find here.
+    const auto formID = static_cast<RE::FormID>(handle & 0xFFFFFFFF);
+    const auto typeID = static_cast<RE::VMTypeID>((handle >> 32) & 0xFF);
+    auto& entry = entries[GetEntryIndex(typeID, formID)];
+
+    if (entry.handle.load(std::memory_order_relaxed) != handle) {
+        return;
+    }
+
+    auto sequence = entry.sequence.load(std::memory_order_relaxed);
+    while (true) {
+        if ((sequence & 1) == 0 &&
+            entry.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            break;
+        }
+        sequence = entry.sequence.load(std::memory_order_relaxed);
+    }
+
+    if (entry.handle.load(std::memory_order_relaxed) == handle) {
+        entry.key.store(0, std::memory_order_relaxed);
+        entry.handle.store(0, std::memory_order_relaxed);
+    }
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void VMHandleCache::InvalidateAll() {
+    auto currentGeneration = generation.load(std::memory_order_relaxed);
+    std::uint32_t nextGeneration;
+    do {
+        nextGeneration = currentGeneration + 1;
+        if ((nextGeneration & GenerationMask) == 0) {
+            // Generation 0 would allow empty entries to match, skip it
+            ++nextGeneration;
+        }
+    } while (!generation.compare_exchange_weak(currentGeneration, nextGeneration, std::memory_order_release));
+}
+
+CacheStats VMHandleCache::GetStats() const {
+    return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+}
+
+void VMHandleCache::InstallHooks() {
+    auto vm = RE::SkyrimVM::GetSingleton();
+    if (!vm) {
+        Logging::error(Logging::Category::kGeneral, "Unable to hook handle policy, the VM does not exist yet.");
+        return;
+    }
+
+    REL::Relocation<std::uintptr_t> vtbl{*reinterpret_cast<std::uintptr_t*>(&vm->handlePolicy)};
+    PersistHandleHook::func = vtbl.write_vfunc(PersistHandleHook::idx, PersistHandleHook::thunk);
+    ReleaseHandleHook::func = vtbl.write_vfunc(ReleaseHandleHook::idx, ReleaseHandleHook::thunk);
+
+    Logging::trace(Logging::Category::kGeneral, "Handle policy hooked for VM handle cache.");
+}
+
+void VMHandleCache::OnRevert(SKSE::SerializationInterface*) {
+    auto& singleton = GetSingleton();
+    singleton.InvalidateAll();
+
+    const auto stats = singleton.GetStats();
+    Logging::debug(Logging::Category::kGeneral, "VM handle cache: {} hits, {} misses.", stats.hits, stats.misses);
+}
@@ -0,0 +1,156 @@
+#include <WarpaintTracker.h>
+#include <Logging.h>
+
+#include <algorithm>
+#include <bit>
+
+using namespace Core;
+
+std::uint64_t Core::HashWarpaintLayers(std::span<const WarpaintLayer> layers) {
+    // FNV-1a over the fields of every layer; there are only a handful of layers per face
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto mix = [&hash](std::uint32_t value) {
+        for (int byte = 0; byte < 4; ++byte) {
+            hash ^= (value >> (8 * byte)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (const auto& layer : layers) {
+        mix(layer.tintIndex);
+        mix(layer.color);
+        mix(std::bit_cast<std::uint32_t>(layer.interpolation));
+    }
+
+    return hash;
+}
+
+void WarpaintTracker::Register(FormID receiver, FormID actorBase) {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    auto& receivers = trackedActorBases[actorBase].receivers;
+    if (std::find(receivers.begin(), receivers.end(), receiver) == receivers.end()) {
+        receivers.push_back(receiver);
+    }
+
+    haveTrackedActorBases.store(true, std::memory_order_relaxed);
+}
+
+void WarpaintTracker::Unregister(FormID receiver, FormID actorBase) {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    const auto it = trackedActorBases.find(actorBase);
+    if (it == trackedActorBases.end()) {
+        return;
+    }
+
+    auto& receivers = it->second.receivers;
+    receivers.erase(std::remove(receivers.begin(), receivers.end(), receiver), receivers.end());
+    if (receivers.empty()) {
+        trackedActorBases.erase(it);
+    }
+
+    haveTrackedActorBases.store(!trackedActorBases.empty(), std::memory_order_relaxed);
+}
+
+bool WarpaintTracker::IsTracked(FormID actorBase) const {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+    return trackedActorBases.contains(actorBase);
+}
+
+std::vector<FormID> WarpaintTracker::GetTrackedActorBases() const {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    std::vector<FormID> actorBases;
+    actorBases.reserve(trackedActorBases.size());
+    for (const auto& [actorBase, tracked] : trackedActorBases) {
+        actorBases.push_back(actorBase);
+    }
+
+    return actorBases;
+}
+
+std::vector<FormID> WarpaintTracker::UpdateHash(FormID actorBase, std::uint64_t hash) {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    const auto it = trackedActorBases.find(actorBase);
+    if (it == trackedActorBases.end()) {
+        return {};
+    }
+
+    auto& tracked = it->second;
+    const bool changed = tracked.hashed && tracked.hash != hash;
+    tracked.hash = hash;
+    tracked.hashed = true;
+
+    return changed ? tracked.receivers : std::vector<FormID>{};
+}
+
+void WarpaintTracker::Revert() {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+    trackedActorBases.clear();
+    haveTrackedActorBases.store(false, std::memory_order_relaxed);
+}
+
+void WarpaintTracker::Save(ISerializationInterface& serde) {
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    if (!serde.OpenRecord(WarpaintRecord, 0)) {
+        Logging::error(Logging::Category::kCosave, "Unable to open record to write cosave data.");
+        return;
+    }
+
+    std::size_t numActorBases = trackedActorBases.size();
+    serde.WriteRecordData(numActorBases);
+    for (const auto& [actorBase, tracked] : trackedActorBases) {
+        serde.WriteRecordData(actorBase);
+        serde.WriteRecordData(tracked.hash);
+        serde.WriteRecordData(tracked.hashed);
+
+        std::size_t numReceivers = tracked.receivers.size();
+        serde.WriteRecordData(numReceivers);
+        for (const auto receiver : tracked.receivers) {
+            serde.WriteRecordData(receiver);
+        }
+    }
+}
+
+bool WarpaintTracker::LoadRecord(ISerializationInterface& serde, std::uint32_t type) {
+    if (type != WarpaintRecord) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(trackedActorBasesMutex);
+
+    std::size_t numActorBases;
+    serde.ReadRecordData(numActorBases);
+
+    for (; numActorBases > 0; --numActorBases) {
+        FormID actorBaseForm;
+        serde.ReadRecordData(actorBaseForm);
+        FormID newActorBaseForm;
+        const bool resolvedActorBaseForm = serde.ResolveFormID(actorBaseForm, newActorBaseForm);
+
+        TrackedActorBase tracked;
+        serde.ReadRecordData(tracked.hash);
+        serde.ReadRecordData(tracked.hashed);
+
+        std::size_t numReceivers;
+        serde.ReadRecordData(numReceivers);
+        for (; numReceivers > 0; --numReceivers) {
+            FormID receiverForm;
+            serde.ReadRecordData(receiverForm);
+            FormID newReceiverForm;
+            if (serde.ResolveFormID(receiverForm, newReceiverForm)) {
+                tracked.receivers.push_back(newReceiverForm);
+            }
+        }
+
+        if (resolvedActorBaseForm && !tracked.receivers.empty()) {
+            trackedActorBases[newActorBaseForm] = std::move(tracked);
+        }
+    }
+
+    haveTrackedActorBases.store(!trackedActorBases.empty(), std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,52 @@
+#include <AssetValidation.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using Core::AssetKind;
+using Core::NormalizeAssetPath;
+
+TEST(NormalizeAssetPathTest, PrefixesTheFolderOfTheKind) {
+    EXPECT_EQ(NormalizeAssetPath("Armor\\Iron\\Cuirass.nif", AssetKind::kModel), "meshes\\Armor\\Iron\\Cuirass.nif");
+    EXPECT_EQ(NormalizeAssetPath("Actors\\Skin.dds", AssetKind::kTexture), "textures\\Actors\\Skin.dds");
+}
+
+TEST(NormalizeAssetPathTest, KeepsAnExistingFolderInAnyCase) {
+    EXPECT_EQ(NormalizeAssetPath("Meshes\\Clutter\\Bowl.nif", AssetKind::kModel), "Meshes\\Clutter\\Bowl.nif");
+    EXPECT_EQ(NormalizeAssetPath("TEXTURES\\Sky\\Moon.dds", AssetKind::kTexture), "TEXTURES\\Sky\\Moon.dds");
+    // Only a whole first folder counts
+    EXPECT_EQ(NormalizeAssetPath("meshesextra\\Bowl.nif", AssetKind::kModel), "meshes\\meshesextra\\Bowl.nif");
+    EXPECT_EQ(NormalizeAssetPath("meshes\\Bowl.nif", AssetKind::kTexture), "textures\\meshes\\Bowl.nif");
+}
+
+TEST(NormalizeAssetPathTest, UsesBackslashesWithoutLeadingOnes) {
+    EXPECT_EQ(NormalizeAssetPath("/meshes/Clutter/Bowl.nif", AssetKind::kModel), "meshes\\Clutter\\Bowl.nif");
+    EXPECT_EQ(NormalizeAssetPath("\\\\Clutter\\Bowl.nif", AssetKind::kModel), "meshes\\Clutter\\Bowl.nif");
+}
+
+TEST(NormalizeAssetPathTest, LeavesEmptyPathsEmpty) {
+    EXPECT_EQ(NormalizeAssetPath("", AssetKind::kModel), "");
+    EXPECT_EQ(NormalizeAssetPath("\\/", AssetKind::kTexture), "");
+}
+
+TEST(AssetPathValidatorTest, ChecksEveryDistinctPathOnce) {
+    Core::AssetPathValidator validator;
+    validator.AddPath(0, "Clutter\\Bowl.nif", AssetKind::kModel);
+    validator.AddPath(1, "meshes/Clutter/Bowl.nif", AssetKind::kModel);
+    validator.AddPath(1, "Clutter\\Missing.dds", AssetKind::kTexture);
+    validator.AddPath(2, "", AssetKind::kModel);
+    validator.AddPath(3, "Clutter\\Missing.dds", AssetKind::kTexture);
+    ASSERT_EQ(validator.NumPaths(), 2);
+
+    std::atomic<int> numChecks = 0;
+    const auto missing = validator.FindFormsWithMissingAssets([&numChecks](const std::string& path) {
+        ++numChecks;
+        return path == "meshes\\Clutter\\Bowl.nif";
+    });
+
+    EXPECT_EQ(numChecks, 2);
+    EXPECT_EQ(missing, (std::vector<std::int32_t>{1, 3}));
+}
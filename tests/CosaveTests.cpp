@@ -0,0 +1,200 @@
+#include "MockEngine.h"
+
+#include <ItemCountWatcher.h>
+#include <ItemEventBatcher.h>
+
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID ContainerA = 0x100;
+    constexpr Core::FormID ContainerB = 0x200;
+    constexpr Core::FormID ContainerC = 0x300;
+    constexpr Core::FormID ItemA = 0x1000;
+    constexpr Core::FormID ItemB = 0x1001;
+
+    /**
+     * In-memory cosave of a load order that changed since it was written: some forms got a new ID,
+     * and others no longer exist.
+     */
+    class ChangedLoadOrderCosave : public InMemoryCosave {
+
+    public:
+        virtual bool ResolveFormID(Core::FormID oldFormID, Core::FormID& newFormID) override {
+            if (removedForms.contains(oldFormID)) {
+                return false;
+            }
+            const auto it = movedForms.find(oldFormID);
+            newFormID = it != movedForms.end() ? it->second : oldFormID;
+            return true;
+        }
+
+        std::unordered_map<Core::FormID, Core::FormID> movedForms;
+        std::unordered_set<Core::FormID> removedForms;
+    };
+
+    /**
+     * Two batchers, for saving the state of one and loading it into the other, as when loading a
+     * game in a new session.
+     */
+    class CosaveTest : public ::testing::Test {
+
+    protected:
+        CosaveTest() {
+            for (const auto container : {ContainerA, ContainerB, ContainerC, ContainerC + 1}) {
+                forms.AddReference(container);
+            }
+            forms.AddForm(ItemA);
+            forms.AddForm(ItemB);
+        }
+
+        /** Saves the first batcher, without sending anything it has pending, and loads it into the second */
+        void SaveAndLoad(InMemoryCosave& cosave) {
+            tasks.DiscardFrame();
+            saved.Save(cosave);
+            Load(cosave);
+        }
+
+        void Load(InMemoryCosave& cosave) {
+            cosave.Rewind();
+            loaded.Revert();
+
+            std::uint32_t type;
+            std::uint32_t version;
+            std::uint32_t length;
+            while (cosave.GetNextRecordInfo(type, version, length)) {
+                EXPECT_TRUE(loaded.LoadRecord(cosave, type));
+            }
+            loaded.FinishLoad();
+        }
+
+        std::vector<RecordingEventSender::SentItemEvent> SentTo(Core::ItemEventKind kind,
+                                                                Core::VMHandle handle) const {
+            std::vector<RecordingEventSender::SentItemEvent> sent;
+            for (const auto& event : sender.itemEvents) {
+                if (event.kind == kind && event.handle == handle) {
+                    sent.push_back(event);
+                }
+            }
+            return sent;
+        }
+
+        MockFormLookup forms;
+        MockHandlePolicy handles;
+        RecordingEventSender sender;
+        FrameTaskQueue tasks;
+        Core::ItemEventBatcher saved{{forms, handles, sender, tasks}};
+        Core::ItemEventBatcher loaded{{forms, handles, sender, tasks}};
+    };
+}  // namespace
+
+TEST_F(CosaveTest, PendingEventsSurviveARoundTrip) {
+    saved.RegisterForItemsTransferred(ContainerB, ContainerB);
+    saved.RecordEvent(0, ContainerA, ItemA, 1);
+    saved.RecordEvent(ContainerA, ContainerB, ItemB, 2);
+
+    InMemoryCosave cosave;
+    SaveAndLoad(cosave);
+    tasks.RunFrame();
+
+    const auto added = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(added.size(), 1);
+    EXPECT_EQ(added[0].baseItems, (std::vector<Core::FormID>{ItemA}));
+
+    const auto removed = SentTo(Core::ItemEventKind::kRemoved, ContainerA);
+    ASSERT_EQ(removed.size(), 1);
+    EXPECT_EQ(removed[0].itemCounts, (std::vector<std::int32_t>{2}));
+
+    const auto transfers = SentTo(Core::ItemEventKind::kTransferred, ContainerB);
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].baseItems, (std::vector<Core::FormID>{ItemB}));
+    EXPECT_EQ(transfers[0].receivers, (std::vector<Core::VMHandle>{ContainerB}));
+}
+
+TEST_F(CosaveTest, NothingPendingSendsNothing) {
+    InMemoryCosave cosave;
+    SaveAndLoad(cosave);
+    tasks.RunFrame();
+
+    EXPECT_TRUE(sender.itemEvents.empty());
+}
+
+TEST_F(CosaveTest, DropsEventsOfFormsThatNoLongerExist) {
+    saved.RecordEvent(0, ContainerA, ItemA, 1);
+    saved.RecordEvent(0, ContainerA, ItemB, 2);
+    saved.RecordEvent(0, ContainerB, ItemA, 3);
+    saved.RegisterForItemsTransferred(ContainerC, ContainerC);
+    saved.RecordEvent(ContainerC, ContainerB, ItemA, 4);
+
+    ChangedLoadOrderCosave cosave;
+    cosave.removedForms = {ItemB, ContainerB};
+    SaveAndLoad(cosave);
+    tasks.RunFrame();
+
+    const auto added = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(added.size(), 1);
+    EXPECT_EQ(added[0].baseItems, (std::vector<Core::FormID>{ItemA}));
+
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kAdded, ContainerB).empty());
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kTransferred, ContainerC).empty());
+}
+
+TEST_F(CosaveTest, TransferRegistrationsFollowTheirFormsToNewIDs) {
+    // The script on an alias of the container: only the form ID in its lower half changes
+    constexpr Core::FormID Quest = 0x5000;
+    constexpr Core::FormID MovedQuest = 0x5001;
+    constexpr Core::VMHandle AliasType = Core::VMHandle{0x3} << 32;
+
+    saved.RegisterForItemsTransferred(ContainerC, AliasType | Quest);
+
+    ChangedLoadOrderCosave cosave;
+    cosave.movedForms = {{ContainerC, ContainerC + 1}, {Quest, MovedQuest}};
+    SaveAndLoad(cosave);
+
+    loaded.RecordEvent(ContainerC + 1, ContainerA, ItemA, 1);
+    tasks.RunFrame();
+
+    const auto transfers = SentTo(Core::ItemEventKind::kTransferred, ContainerC + 1);
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].receivers, (std::vector<Core::VMHandle>{AliasType | MovedQuest}));
+}
+
+TEST(ItemCountWatcherCosaveTest, WatchesSurviveARoundTrip) {
+    MockFormLookup forms;
+    MockInventoryLookup inventory;
+    MockHandlePolicy handles;
+    RecordingEventSender sender;
+    FrameTaskQueue tasks;
+    forms.AddReference(ContainerA);
+    forms.AddForm(ItemA);
+    inventory.SetItemCount(ContainerA, ItemA, 4);
+
+    Core::ItemCountWatcher saved{{forms, inventory, handles, sender, tasks}};
+    saved.Watch(ContainerA, ItemA, 5);
+
+    InMemoryCosave cosave;
+    saved.Save(cosave);
+    cosave.Rewind();
+
+    Core::ItemCountWatcher loaded{{forms, inventory, handles, sender, tasks}};
+    std::uint32_t type;
+    std::uint32_t version;
+    std::uint32_t length;
+    while (cosave.GetNextRecordInfo(type, version, length)) {
+        EXPECT_TRUE(loaded.LoadRecord(cosave, type));
+    }
+    loaded.FinishLoad();
+    tasks.RunFrame();
+
+    loaded.RecordEvent(0, ContainerA, ItemA, 1);
+    tasks.RunFrame();
+
+    ASSERT_EQ(sender.itemCountEvents.size(), 1);
+    EXPECT_EQ(sender.itemCountEvents[0].handle, ContainerA);
+    EXPECT_EQ(sender.itemCountEvents[0].threshold, 5);
+    EXPECT_EQ(sender.itemCountEvents[0].itemCount, 5);
+}
@@ -0,0 +1,94 @@
+#include "MockEngine.h"
+
+#include <DispatchScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID Player = MockFormLookup::PlayerFormID;
+    constexpr Core::FormID Follower = 0x100;
+    constexpr Core::FormID Registered = 0x200;
+    constexpr Core::FormID Other = 0x300;
+
+    using KeyedClass = std::pair<std::uint64_t, Core::DispatchClass>;
+
+    /** Batches with the given keys and classes, in the given order */
+    std::vector<Core::ScheduledBatch> MakeBatches(std::initializer_list<KeyedClass> keyedClasses) {
+        std::vector<Core::ScheduledBatch> batches;
+        for (const auto& [key, dispatchClass] : keyedClasses) {
+            batches.push_back({key, nullptr, dispatchClass});
+        }
+        return batches;
+    }
+
+    /** The keys of the first numBatches batches */
+    std::vector<std::uint64_t> KeysOf(const std::vector<Core::ScheduledBatch>& batches, std::size_t numBatches) {
+        std::vector<std::uint64_t> keys;
+        for (std::size_t i = 0; i < numBatches; ++i) {
+            keys.push_back(batches[i].key);
+        }
+        return keys;
+    }
+}  // namespace
+
+TEST(DispatchSchedulerTest, ClassifiesContainers) {
+    MockFormLookup forms;
+    forms.AddPlayerTeammate(Follower);
+    Core::DispatchScheduler scheduler(forms);
+    scheduler.RegisterHighPriority(Registered);
+
+    EXPECT_EQ(scheduler.Classify(Player), Core::DispatchClass::kPlayer);
+    EXPECT_EQ(scheduler.Classify(Follower), Core::DispatchClass::kFollower);
+    EXPECT_EQ(scheduler.Classify(Registered), Core::DispatchClass::kRegistered);
+    EXPECT_EQ(scheduler.Classify(Other), Core::DispatchClass::kOther);
+    EXPECT_EQ(scheduler.ClassifyPair(Other, Player), Core::DispatchClass::kPlayer);
+
+    scheduler.UnregisterHighPriority(Registered);
+    EXPECT_EQ(scheduler.Classify(Registered), Core::DispatchClass::kOther);
+}
+
+TEST(DispatchSchedulerTest, SendsThePlayerFirst) {
+    using enum Core::DispatchClass;
+    auto batches = MakeBatches({{1, kOther}, {2, kRegistered}, {3, kFollower}, {4, kOther}, {Player, kPlayer}});
+    std::uint64_t cursor = 0;
+
+    ASSERT_EQ(Core::DispatchScheduler::Schedule(batches, 0, cursor), 5);
+    EXPECT_EQ(batches[0].dispatchClass, kPlayer);
+    EXPECT_EQ(batches[1].dispatchClass, kFollower);
+    EXPECT_EQ(batches[2].dispatchClass, kRegistered);
+    EXPECT_EQ(batches[3].dispatchClass, kOther);
+    EXPECT_EQ(batches[4].dispatchClass, kOther);
+}
+
+TEST(DispatchSchedulerTest, LeavesRoomForAnOtherContainerInEveryFrame) {
+    using enum Core::DispatchClass;
+    auto batches = MakeBatches({{1, kOther}, {2, kFollower}, {3, kFollower}, {Player, kPlayer}});
+    std::uint64_t cursor = 0;
+
+    ASSERT_EQ(Core::DispatchScheduler::Schedule(batches, 3, cursor), 3);
+    EXPECT_EQ(batches[0].key, Player);
+    EXPECT_EQ(batches[1].dispatchClass, kFollower);
+    EXPECT_EQ(batches[2].key, 1);
+}
+
+TEST(DispatchSchedulerTest, TakesTurnsBetweenOtherContainers) {
+    using enum Core::DispatchClass;
+    std::uint64_t cursor = 0;
+    const auto schedule = [&cursor]() {
+        auto batches =
+            MakeBatches({{5, kOther}, {3, kOther}, {Player, kPlayer}, {1, kOther}, {4, kOther}, {2, kOther}});
+        const auto numToSend = Core::DispatchScheduler::Schedule(batches, 3, cursor);
+        return KeysOf(batches, numToSend);
+    };
+
+    EXPECT_EQ(schedule(), (std::vector<std::uint64_t>{Player, 1, 2}));
+    EXPECT_EQ(cursor, 2);
+    EXPECT_EQ(schedule(), (std::vector<std::uint64_t>{Player, 3, 4}));
+    EXPECT_EQ(schedule(), (std::vector<std::uint64_t>{Player, 5, 1}));
+}
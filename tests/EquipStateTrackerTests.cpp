@@ -0,0 +1,155 @@
+#include "MockEngine.h"
+
+#include <EquipStateTracker.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID ActorA = 0x100;
+    constexpr Core::FormID ActorB = 0x200;
+    constexpr Core::FormID SpellA = 0x1000;
+    constexpr Core::FormID SpellB = 0x1001;
+    constexpr Core::FormID ShoutA = 0x2000;
+
+    /**
+     * A tracker that already knows the state of ActorA: SpellA equipped.
+     */
+    class EquipStateTrackerTest : public ::testing::Test {
+
+    protected:
+        EquipStateTrackerTest() { tracker.RecordEquip(ActorA, SpellA, true); }
+
+        /** Advances the windows by the given number of frames, and returns the changes they reported */
+        std::vector<Core::EquipChange> AdvanceFrames(std::size_t frames) {
+            std::vector<Core::EquipChange> changes;
+            for (; frames > 0; --frames) {
+                tracker.AdvanceFrame(changes);
+            }
+            return changes;
+        }
+
+        Core::EquipStateTracker tracker;
+    };
+}  // namespace
+
+TEST_F(EquipStateTrackerTest, SendsEventsOutsideOfWindows) {
+    EXPECT_TRUE(tracker.RecordEquip(ActorA, SpellB, true));
+    EXPECT_TRUE(tracker.RecordEquip(ActorB, SpellA, true));
+}
+
+TEST_F(EquipStateTrackerTest, HoldsBackEventsUntilTheActorWindowCloses) {
+    tracker.BeginActorWindow(ActorA, 2);
+    EXPECT_FALSE(tracker.RecordEquip(ActorA, SpellB, true));
+    // Other actors are not in the window
+    EXPECT_TRUE(tracker.RecordEquip(ActorB, SpellB, true));
+
+    std::vector<Core::EquipChange> changes;
+    EXPECT_TRUE(tracker.AdvanceFrame(changes));
+    EXPECT_TRUE(tracker.AdvanceFrame(changes));
+    EXPECT_TRUE(changes.empty());
+
+    EXPECT_FALSE(tracker.AdvanceFrame(changes));
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].actor, ActorA);
+    EXPECT_EQ(changes[0].form, SpellB);
+    EXPECT_TRUE(changes[0].equipped);
+
+    EXPECT_TRUE(tracker.RecordEquip(ActorA, SpellB, false));
+}
+
+TEST_F(EquipStateTrackerTest, ReportsOnlyTheNetChanges) {
+    tracker.BeginActorWindow(ActorA, 0);
+    // The usual storm: everything is unequipped and equipped again
+    tracker.RecordEquip(ActorA, SpellA, false);
+    tracker.RecordEquip(ActorA, SpellA, true);
+    tracker.RecordEquip(ActorA, SpellB, true);
+    tracker.RecordEquip(ActorA, SpellB, false);
+    tracker.RecordEquip(ActorA, ShoutA, true);
+
+    const auto changes = AdvanceFrames(1);
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].form, ShoutA);
+    EXPECT_TRUE(changes[0].equipped);
+}
+
+TEST_F(EquipStateTrackerTest, KeepsTheLoadWindowOpenUntilTheGameIsLoaded) {
+    tracker.BeginLoadWindow();
+    EXPECT_FALSE(tracker.RecordEquip(ActorA, SpellA, false));
+    EXPECT_TRUE(AdvanceFrames(10).empty());
+
+    tracker.EndLoadWindow(1);
+    EXPECT_TRUE(AdvanceFrames(1).empty());
+
+    const auto changes = AdvanceFrames(1);
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].form, SpellA);
+    EXPECT_FALSE(changes[0].equipped);
+}
+
+TEST_F(EquipStateTrackerTest, SeedsActorsWithoutAKnownStateSilently) {
+    tracker.BeginActorWindow(ActorB, 0);
+    EXPECT_FALSE(tracker.RecordEquip(ActorB, SpellA, true));
+    EXPECT_TRUE(AdvanceFrames(1).empty());
+
+    // Once seeded, the state of the actor is known
+    tracker.BeginActorWindow(ActorB, 0);
+    tracker.RecordEquip(ActorB, SpellA, true);
+    tracker.RecordEquip(ActorB, SpellB, true);
+    const auto changes = AdvanceFrames(1);
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].form, SpellB);
+}
+
+TEST_F(EquipStateTrackerTest, ForgottenActorsAreSeededAgain) {
+    tracker.ForgetActor(ActorA);
+
+    tracker.BeginActorWindow(ActorA, 0);
+    tracker.RecordEquip(ActorA, SpellB, true);
+    EXPECT_TRUE(AdvanceFrames(1).empty());
+}
+
+TEST_F(EquipStateTrackerTest, StatesSurviveARoundTrip) {
+    // An actor with nothing equipped is still known
+    tracker.RecordEquip(ActorB, SpellA, true);
+    tracker.RecordEquip(ActorB, SpellA, false);
+
+    InMemoryCosave cosave;
+    tracker.Save(cosave);
+    cosave.Rewind();
+
+    Core::EquipStateTracker loaded;
+    loaded.BeginLoadWindow();
+    std::uint32_t type;
+    std::uint32_t version;
+    std::uint32_t length;
+    while (cosave.GetNextRecordInfo(type, version, length)) {
+        EXPECT_TRUE(loaded.LoadRecord(cosave, type));
+    }
+
+    // The re-equips of the load only report what changed
+    loaded.RecordEquip(ActorA, SpellA, true);
+    loaded.RecordEquip(ActorB, SpellB, true);
+    loaded.EndLoadWindow(0);
+
+    std::vector<Core::EquipChange> changes;
+    EXPECT_FALSE(loaded.AdvanceFrame(changes));
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].actor, ActorB);
+    EXPECT_EQ(changes[0].form, SpellB);
+}
+
+TEST_F(EquipStateTrackerTest, LoadsWithoutOurRecordAsASeed) {
+    Core::EquipStateTracker loaded;
+    loaded.BeginLoadWindow();
+    loaded.RecordEquip(ActorA, SpellA, true);
+    loaded.RecordEquip(ActorB, SpellB, true);
+    loaded.EndLoadWindow(0);
+
+    std::vector<Core::EquipChange> changes;
+    loaded.AdvanceFrame(changes);
+    EXPECT_TRUE(changes.empty());
+}
@@ -0,0 +1,55 @@
+#include "MockEngine.h"
+
+#include <HitEventDeduplicator.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+namespace {
+    constexpr float FrameTime = 1.0f / 60.0f;
+
+    /**
+     * A deduplicator with a few actors to hit each other.
+     */
+    class HitEventDeduplicatorTest : public ::testing::Test {
+
+    protected:
+        HitEventDeduplicatorTest() {
+            for (std::size_t i = 0; i < actors.size(); ++i) {
+                actors[i].formID = static_cast<Core::FormID>(0x100 + i);
+            }
+        }
+
+        /** Runs a hit through the deduplicator the way the hit event sink does; returns true if it was sent */
+        bool Hit(const RE::TESObjectREFR& target, const RE::TESObjectREFR& cause, float applicationRuntime) {
+            if (deduplicator.IsDuplicate(&target, &cause, applicationRuntime)) {
+                return false;
+            }
+            deduplicator.RecordHit(&target, &cause, applicationRuntime);
+            return true;
+        }
+
+        std::array<RE::TESObjectREFR, 3> actors;
+        Core::HitEventDeduplicator deduplicator;
+    };
+}  // namespace
+
+TEST_F(HitEventDeduplicatorTest, SkipsTheSameHitInTheSameFrame) {
+    EXPECT_TRUE(Hit(actors[0], actors[1], FrameTime));
+    EXPECT_FALSE(Hit(actors[0], actors[1], FrameTime));
+    EXPECT_FALSE(Hit(actors[0], actors[1], FrameTime));
+}
+
+TEST_F(HitEventDeduplicatorTest, KeepsHitsOfOtherPairs) {
+    EXPECT_TRUE(Hit(actors[0], actors[1], FrameTime));
+    EXPECT_TRUE(Hit(actors[1], actors[0], FrameTime));
+    EXPECT_TRUE(Hit(actors[0], actors[2], FrameTime));
+    EXPECT_TRUE(Hit(actors[2], actors[1], FrameTime));
+}
+
+TEST_F(HitEventDeduplicatorTest, ForgetsHitsOfEarlierFrames) {
+    EXPECT_TRUE(Hit(actors[0], actors[1], FrameTime));
+    EXPECT_TRUE(Hit(actors[0], actors[1], 2 * FrameTime));
+    EXPECT_FALSE(Hit(actors[0], actors[1], 2 * FrameTime));
+}
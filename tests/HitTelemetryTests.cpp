@@ -0,0 +1,121 @@
+#include <HitTelemetry.h>
+#include <Settings.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+    constexpr Core::FormID AggressorA = 0x100;
+    constexpr Core::FormID AggressorB = 0x200;
+    constexpr Core::FormID AggressorC = 0x300;
+    constexpr Core::FormID Target = 0x1000;
+
+    /**
+     * A hit telemetry with the default settings, unless a test publishes others.
+     */
+    class HitTelemetryTest : public ::testing::Test {
+
+    protected:
+        ~HitTelemetryTest() override { Core::SettingsStore::GetSingleton().Publish({}); }
+
+        static void PublishTelemetryPairs(std::uint32_t telemetryPairs) {
+            Core::Settings settings;
+            settings.hitEvents.telemetryPairs = telemetryPairs;
+            Core::SettingsStore::GetSingleton().Publish(std::move(settings));
+        }
+
+        Core::HitTelemetry telemetry;
+    };
+}  // namespace
+
+TEST_F(HitTelemetryTest, CountsTheHitsInTheWindow) {
+    for (const std::uint32_t time : {1000, 1500, 2000, 2500}) {
+        telemetry.RecordHit(AggressorA, Target, 0, time);
+    }
+
+    // The window includes its start
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 2500, 1000), 3.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 2500, 4000), 1.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 10000, 1000), 0.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 2500, 0), 0.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorB, Target, 2500, 1000), 0.0f);
+}
+
+TEST_F(HitTelemetryTest, MergesTheHitsOfAPairInTheSameFrame) {
+    telemetry.RecordHit(AggressorA, Target, 0, 1000);
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kHitBlocked, 1000);
+
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 1000, 1000), 1.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetBlockedRatio(AggressorA, Target, 1000, 1000), 1.0f);
+}
+
+TEST_F(HitTelemetryTest, KeepsTheLastHitsOfEveryPair) {
+    for (std::uint32_t time = 1; time <= 3 * Core::HitTelemetry::HitsPerPair; ++time) {
+        telemetry.RecordHit(AggressorA, Target, 0, time);
+    }
+
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 1000, 1000),
+                    static_cast<float>(Core::HitTelemetry::HitsPerPair));
+}
+
+TEST_F(HitTelemetryTest, ComputesTheBlockedRatioInTheWindow) {
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kHitBlocked, 100);
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kHitBlocked, 1000);
+    telemetry.RecordHit(AggressorA, Target, 0, 1100);
+    telemetry.RecordHit(AggressorA, Target, 0, 1200);
+    telemetry.RecordHit(AggressorA, Target, 0, 1300);
+
+    EXPECT_FLOAT_EQ(telemetry.GetBlockedRatio(AggressorA, Target, 1300, 500), 0.25f);
+    EXPECT_FLOAT_EQ(telemetry.GetBlockedRatio(AggressorA, Target, 5000, 500), 0.0f);
+}
+
+TEST_F(HitTelemetryTest, CountsTheMostRecentPowerAttacks) {
+    EXPECT_EQ(telemetry.GetPowerAttackStreak(AggressorA, Target), 0);
+
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kPowerAttack, 100);
+    telemetry.RecordHit(AggressorA, Target, 0, 200);
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kPowerAttack, 300);
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kPowerAttack | Core::HitFlags::kSneakAttack, 400);
+    EXPECT_EQ(telemetry.GetPowerAttackStreak(AggressorA, Target), 2);
+
+    telemetry.RecordHit(AggressorA, Target, Core::HitFlags::kBashAttack, 500);
+    EXPECT_EQ(telemetry.GetPowerAttackStreak(AggressorA, Target), 0);
+}
+
+TEST_F(HitTelemetryTest, ListsTheRecentAttackersMostRecentFirst) {
+    telemetry.RecordHit(AggressorB, Target, 0, 100);
+    telemetry.RecordHit(AggressorA, Target, 0, 200);
+    telemetry.RecordHit(AggressorC, Target, 0, 300);
+    telemetry.RecordHit(AggressorB, Target, 0, 400);
+    // Hits on others are not attacks on the target
+    telemetry.RecordHit(Target, AggressorA, 0, 500);
+
+    EXPECT_EQ(telemetry.GetRecentAttackers(Target, 500, 1000),
+              (std::vector<Core::FormID>{AggressorB, AggressorC, AggressorA}));
+    EXPECT_EQ(telemetry.GetRecentAttackers(Target, 500, 250), (std::vector<Core::FormID>{AggressorB, AggressorC}));
+}
+
+TEST_F(HitTelemetryTest, NewPairsTakeOverTheSlotOfTheOldestPair) {
+    PublishTelemetryPairs(2);
+
+    telemetry.RecordHit(AggressorA, Target, 0, 100);
+    telemetry.RecordHit(AggressorB, Target, 0, 200);
+    // Hits of existing pairs do not change which pair was added longest ago
+    telemetry.RecordHit(AggressorA, Target, 0, 300);
+    telemetry.RecordHit(AggressorC, Target, 0, 400);
+
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 400, 1000), 0.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorB, Target, 400, 1000), 1.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorC, Target, 400, 1000), 1.0f);
+    EXPECT_EQ(telemetry.GetRecentAttackers(Target, 400, 1000), (std::vector<Core::FormID>{AggressorC, AggressorB}));
+}
+
+TEST_F(HitTelemetryTest, ChangingTheNumberOfPairsForgetsAllHits) {
+    telemetry.RecordHit(AggressorA, Target, 0, 100);
+    PublishTelemetryPairs(8);
+    telemetry.RecordHit(AggressorB, Target, 0, 200);
+
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorA, Target, 200, 1000), 0.0f);
+    EXPECT_FLOAT_EQ(telemetry.GetHitRate(AggressorB, Target, 200, 1000), 1.0f);
+}
@@ -0,0 +1,43 @@
+#include <InventoryEventGrouping.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace {
+    constexpr std::array<int, 7> Keys{30, 10, 30, 20, 10, 30, 40};
+}  // namespace
+
+TEST(InventoryEventGroupingTest, GroupsByFirstOccurrenceOfTheKey) {
+    const auto grouping =
+        Core::GroupInventoryEventIndices<int>(Keys.size(), [](const std::size_t i) { return Keys[i]; });
+
+    EXPECT_EQ(grouping.groupOffsets, (std::vector<std::int32_t>{0, 3, 5, 6, 7}));
+    EXPECT_EQ(grouping.groupedIndices, (std::vector<std::int32_t>{0, 2, 5, 1, 4, 3, 6}));
+}
+
+TEST(InventoryEventGroupingTest, GroupsNothingIntoNothing) {
+    const auto grouping = Core::GroupInventoryEventIndices<int>(0, [](const std::size_t) { return 0; });
+
+    EXPECT_EQ(grouping.groupOffsets, (std::vector<std::int32_t>{0}));
+    EXPECT_TRUE(grouping.groupedIndices.empty());
+}
+
+TEST(InventoryEventGroupingTest, GroupsIntoFixedGroupsAndLeavesOutTheRest) {
+    // Group 0 for 10 and group 2 for 30, leaving group 1 empty and the other keys out
+    const auto grouping =
+        Core::GroupInventoryEventIndicesInto(Keys.size(), 3, [](const std::size_t i) -> std::optional<std::size_t> {
+            if (Keys[i] == 10) {
+                return 0;
+            }
+            if (Keys[i] == 30) {
+                return 2;
+            }
+            return std::nullopt;
+        });
+
+    EXPECT_EQ(grouping.groupOffsets, (std::vector<std::int32_t>{0, 2, 2, 5}));
+    EXPECT_EQ(grouping.groupedIndices, (std::vector<std::int32_t>{1, 4, 0, 2, 5}));
+}
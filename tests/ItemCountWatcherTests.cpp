@@ -0,0 +1,98 @@
+#include "MockEngine.h"
+
+#include <ItemCountWatcher.h>
+
+#include <gtest/gtest.h>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID ContainerA = 0x100;
+    constexpr Core::FormID ContainerB = 0x200;
+    constexpr Core::FormID ItemA = 0x1000;
+    constexpr Core::FormID ItemB = 0x1001;
+
+    /**
+     * A watcher whose ContainerA holds 4 of ItemA, with a watch for 5 of them.
+     */
+    class ItemCountWatcherTest : public ::testing::Test {
+
+    protected:
+        ItemCountWatcherTest() {
+            forms.AddReference(ContainerA);
+            forms.AddReference(ContainerB);
+            forms.AddForm(ItemA);
+            forms.AddForm(ItemB);
+            inventory.SetItemCount(ContainerA, ItemA, 4);
+            watcher.Watch(ContainerA, ItemA, 5);
+        }
+
+        MockFormLookup forms;
+        MockInventoryLookup inventory;
+        MockHandlePolicy handles;
+        RecordingEventSender sender;
+        FrameTaskQueue tasks;
+        Core::ItemCountWatcher watcher{{forms, inventory, handles, sender, tasks}};
+    };
+}  // namespace
+
+TEST_F(ItemCountWatcherTest, ReportsCrossingsInBothDirections) {
+    watcher.RecordEvent(0, ContainerA, ItemA, 1);
+    tasks.RunFrame();
+    watcher.RecordEvent(ContainerA, ContainerB, ItemA, 3);
+    tasks.RunFrame();
+
+    ASSERT_EQ(sender.itemCountEvents.size(), 2);
+    EXPECT_EQ(sender.itemCountEvents[0].handle, ContainerA);
+    EXPECT_EQ(sender.itemCountEvents[0].baseItem, ItemA);
+    EXPECT_EQ(sender.itemCountEvents[0].threshold, 5);
+    EXPECT_EQ(sender.itemCountEvents[0].itemCount, 5);
+    EXPECT_EQ(sender.itemCountEvents[1].itemCount, 2);
+}
+
+TEST_F(ItemCountWatcherTest, OnlyReportsEdges) {
+    // Staying above the threshold is not a crossing
+    watcher.RecordEvent(0, ContainerA, ItemA, 2);
+    tasks.RunFrame();
+    watcher.RecordEvent(0, ContainerA, ItemA, 10);
+    tasks.RunFrame();
+
+    EXPECT_EQ(sender.itemCountEvents.size(), 1);
+}
+
+TEST_F(ItemCountWatcherTest, ComparesOncePerFrame) {
+    // Crossing and crossing back within a frame is no change
+    watcher.RecordEvent(0, ContainerA, ItemA, 3);
+    watcher.RecordEvent(ContainerA, 0, ItemA, 3);
+    tasks.RunFrame();
+
+    EXPECT_TRUE(sender.itemCountEvents.empty());
+}
+
+TEST_F(ItemCountWatcherTest, ReportsEveryThresholdCrossed) {
+    watcher.Watch(ContainerA, ItemA, 10);
+    watcher.Watch(ContainerA, ItemA, 20);
+
+    watcher.RecordEvent(0, ContainerA, ItemA, 8);
+    tasks.RunFrame();
+
+    ASSERT_EQ(sender.itemCountEvents.size(), 2);
+    EXPECT_EQ(sender.itemCountEvents[0].threshold, 5);
+    EXPECT_EQ(sender.itemCountEvents[1].threshold, 10);
+}
+
+TEST_F(ItemCountWatcherTest, IgnoresUnwatchedCounts) {
+    watcher.RecordEvent(0, ContainerA, ItemB, 10);
+    watcher.RecordEvent(0, ContainerB, ItemA, 10);
+    tasks.RunFrame();
+
+    EXPECT_TRUE(sender.itemCountEvents.empty());
+}
+
+TEST_F(ItemCountWatcherTest, StopsReportingOnceUnwatched) {
+    watcher.Unwatch(ContainerA, ItemA, 5);
+    watcher.RecordEvent(0, ContainerA, ItemA, 1);
+    tasks.RunFrame();
+
+    EXPECT_TRUE(sender.itemCountEvents.empty());
+}
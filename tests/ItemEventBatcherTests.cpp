@@ -0,0 +1,258 @@
+#include "MockEngine.h"
+
+#include <ItemEventBatcher.h>
+#include <Settings.h>
+
+#include <gtest/gtest.h>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID ContainerA = 0x100;
+    constexpr Core::FormID ContainerB = 0x200;
+    constexpr Core::FormID ItemA = 0x1000;
+    constexpr Core::FormID ItemB = 0x1001;
+
+    /** Handle of a script on an alias that points to ContainerA (in the game, quest form ID and alias ID) */
+    constexpr Core::VMHandle AliasOfContainerA = (Core::VMHandle{0x3} << 32) | 0x5000;
+
+    /**
+     * A batcher with mocks that know about a handful of containers and items, and that records everything
+     * it sends.
+     */
+    class ItemEventBatcherTest : public ::testing::Test {
+
+    protected:
+        ItemEventBatcherTest() {
+            for (Core::FormID container = ContainerA; container < ContainerA + 0x1000; container += 0x100) {
+                forms.AddReference(container);
+            }
+            forms.AddForm(ItemA);
+            forms.AddForm(ItemB);
+        }
+
+        ~ItemEventBatcherTest() override { Core::SettingsStore::GetSingleton().Publish({}); }
+
+        static void PublishInventorySettings(const Core::Settings::InventoryEvents& inventoryEvents) {
+            Core::Settings settings;
+            settings.inventoryEvents = inventoryEvents;
+            Core::SettingsStore::GetSingleton().Publish(std::move(settings));
+        }
+
+        /** The events sent of the given kind to the given handle */
+        std::vector<RecordingEventSender::SentItemEvent> SentTo(Core::ItemEventKind kind,
+                                                                Core::VMHandle handle) const {
+            std::vector<RecordingEventSender::SentItemEvent> sent;
+            for (const auto& event : sender.itemEvents) {
+                if (event.kind == kind && event.handle == handle) {
+                    sent.push_back(event);
+                }
+            }
+            return sent;
+        }
+
+        MockFormLookup forms;
+        MockHandlePolicy handles;
+        RecordingEventSender sender;
+        FrameTaskQueue tasks;
+        Core::ItemEventBatcher batcher{{forms, handles, sender, tasks}};
+    };
+}  // namespace
+
+TEST_F(ItemEventBatcherTest, BatchesEventsPerContainerUntilTheEndOfTheFrame) {
+    batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    batcher.RecordEvent(0, ContainerA, ItemB, 2);
+    batcher.RecordEvent(0, ContainerB, ItemA, 3);
+    EXPECT_TRUE(sender.itemEvents.empty());
+
+    tasks.RunFrame();
+
+    const auto sentToA = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(sentToA.size(), 1);
+    EXPECT_EQ(sentToA[0].baseItems, (std::vector<Core::FormID>{ItemA, ItemB}));
+    EXPECT_EQ(sentToA[0].itemCounts, (std::vector<std::int32_t>{1, 2}));
+
+    const auto sentToB = SentTo(Core::ItemEventKind::kAdded, ContainerB);
+    ASSERT_EQ(sentToB.size(), 1);
+    EXPECT_EQ(sentToB[0].itemCounts, (std::vector<std::int32_t>{3}));
+
+    EXPECT_EQ(sender.itemEvents.size(), 2);
+}
+
+TEST_F(ItemEventBatcherTest, SendsMovesAsRemovedAndAdded) {
+    batcher.RecordEvent(ContainerA, ContainerB, ItemA, 4);
+    tasks.RunFrame();
+
+    EXPECT_EQ(SentTo(Core::ItemEventKind::kRemoved, ContainerA).size(), 1);
+    EXPECT_EQ(SentTo(Core::ItemEventKind::kAdded, ContainerB).size(), 1);
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kTransferred, ContainerA).empty());
+}
+
+TEST_F(ItemEventBatcherTest, TransferRegistrationsOnlyApplyToTheRegisteredAlias) {
+    batcher.RegisterForItemsTransferred(ContainerA, AliasOfContainerA);
+
+    batcher.RecordEvent(ContainerA, ContainerB, ItemA, 1);
+    batcher.RecordEvent(0, ContainerA, ItemB, 2);
+    tasks.RunFrame();
+
+    // Only the scripts of the registered alias receive the transfer
+    const auto transfers = SentTo(Core::ItemEventKind::kTransferred, ContainerA);
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].receivers, (std::vector<Core::VMHandle>{AliasOfContainerA}));
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kTransferred, ContainerB).empty());
+
+    // The scripts attached to the container itself still receive the move as a removed item
+    const auto removed = SentTo(Core::ItemEventKind::kRemoved, ContainerA);
+    ASSERT_EQ(removed.size(), 1);
+    EXPECT_EQ(removed[0].excludedReceivers, (std::vector<Core::VMHandle>{AliasOfContainerA}));
+
+    // The registered alias receives the added item that did not come from another container separately
+    const auto added = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(added.size(), 2);
+    EXPECT_EQ(added[0].excludedReceivers, (std::vector<Core::VMHandle>{AliasOfContainerA}));
+    EXPECT_EQ(added[1].receivers, (std::vector<Core::VMHandle>{AliasOfContainerA}));
+    EXPECT_EQ(added[1].baseItems, (std::vector<Core::FormID>{ItemB}));
+
+    // The other side of the move is not registered at all
+    const auto addedToB = SentTo(Core::ItemEventKind::kAdded, ContainerB);
+    ASSERT_EQ(addedToB.size(), 1);
+    EXPECT_TRUE(addedToB[0].excludedReceivers.empty());
+}
+
+TEST_F(ItemEventBatcherTest, UnregisteringStopsItemTransferredEvents) {
+    batcher.RegisterForItemsTransferred(ContainerA, ContainerA);
+    batcher.UnregisterForItemsTransferred(ContainerA, ContainerA);
+
+    batcher.RecordEvent(ContainerA, ContainerB, ItemA, 1);
+    tasks.RunFrame();
+
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kTransferred, ContainerA).empty());
+    const auto removed = SentTo(Core::ItemEventKind::kRemoved, ContainerA);
+    ASSERT_EQ(removed.size(), 1);
+    EXPECT_TRUE(removed[0].excludedReceivers.empty());
+}
+
+TEST_F(ItemEventBatcherTest, DropsEventsBeyondTheMaxPerContainer) {
+    PublishInventorySettings({.maxEventsPerContainer = 2});
+
+    for (int i = 0; i < 5; ++i) {
+        batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    }
+    tasks.RunFrame();
+
+    const auto added = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(added.size(), 1);
+    EXPECT_EQ(added[0].baseItems.size(), 2);
+}
+
+TEST_F(ItemEventBatcherTest, SpreadsContainersOverFramesBeyondTheBudget) {
+    PublishInventorySettings({.maxContainersPerFrame = 2});
+
+    for (Core::FormID container = ContainerA; container < ContainerA + 5 * 0x100; container += 0x100) {
+        batcher.RecordEvent(0, container, ItemA, 1);
+    }
+
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 2);
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 4);
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 5);
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 5);
+    EXPECT_FALSE(tasks.Overran());
+}
+
+TEST_F(ItemEventBatcherTest, SharesTheBudgetBetweenTheTasksOfAFrame) {
+    PublishInventorySettings({.maxContainersPerFrame = 2});
+
+    batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    batcher.RecordEvent(0, ContainerB, ItemA, 1);
+    tasks.AddTask([this]() {
+        // Queues up another send task in the same frame, after the first one used up the budget
+        batcher.RecordEvent(0, ContainerA + 0x200, ItemA, 1);
+        batcher.RecordEvent(0, ContainerA + 0x300, ItemA, 1);
+    });
+
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 2);
+    tasks.RunFrame();
+    EXPECT_EQ(sender.itemEvents.size(), 4);
+    EXPECT_FALSE(tasks.Overran());
+}
+
+TEST_F(ItemEventBatcherTest, WaitsForTheBatchWindow) {
+    PublishInventorySettings({.batchWindowFrames = 2});
+
+    batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    tasks.RunFrame();
+    batcher.RecordEvent(0, ContainerA, ItemB, 1);
+    tasks.RunFrame();
+    EXPECT_TRUE(sender.itemEvents.empty());
+
+    tasks.RunFrame();
+    const auto added = SentTo(Core::ItemEventKind::kAdded, ContainerA);
+    ASSERT_EQ(added.size(), 1);
+    EXPECT_EQ(added[0].baseItems, (std::vector<Core::FormID>{ItemA, ItemB}));
+    EXPECT_FALSE(tasks.Overran());
+}
+
+TEST_F(ItemEventBatcherTest, ChecksTheBatchWindowOncePerFrame) {
+    PublishInventorySettings({.batchWindowMilliseconds = 60000});
+
+    batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    batcher.RecordEvent(ContainerA, ContainerB, ItemA, 1);
+    batcher.RegisterForItemsTransferred(ContainerB, ContainerB);
+    batcher.RecordEvent(ContainerA, ContainerB, ItemB, 1);
+    for (int i = 0; i < 3; ++i) {
+        tasks.RunFrame();
+    }
+
+    // Waiting batches wait for the next frame, rather than being checked over and over in the same one
+    EXPECT_TRUE(sender.itemEvents.empty());
+    EXPECT_FALSE(tasks.Overran());
+}
+
+TEST_F(ItemEventBatcherTest, FlushesFullBatchesBeforeTheEndOfTheWindow) {
+    PublishInventorySettings({.batchWindowFrames = 10, .maxBatchSize = 2});
+
+    batcher.RecordEvent(0, ContainerA, ItemA, 1);
+    batcher.RecordEvent(0, ContainerA, ItemB, 1);
+    batcher.RecordEvent(0, ContainerB, ItemA, 1);
+    tasks.RunFrame();
+
+    EXPECT_EQ(SentTo(Core::ItemEventKind::kAdded, ContainerA).size(), 1);
+    EXPECT_TRUE(SentTo(Core::ItemEventKind::kAdded, ContainerB).empty());
+}
+
+TEST_F(ItemEventBatcherTest, PreparesLargeFramesInParallel) {
+    PublishInventorySettings({.parallelPreparationThreshold = 1});
+
+    for (Core::FormID container = ContainerA; container < ContainerA + 0x1000; container += 0x100) {
+        batcher.RecordEvent(0, container, ItemA, 1);
+        batcher.RecordEvent(0, container, ItemB, 2);
+    }
+    tasks.RunFrame();
+
+    ASSERT_EQ(sender.itemEvents.size(), 16);
+    for (const auto& event : sender.itemEvents) {
+        EXPECT_EQ(event.baseItems, (std::vector<Core::FormID>{ItemA, ItemB}));
+        EXPECT_EQ(event.itemCounts, (std::vector<std::int32_t>{1, 2}));
+    }
+}
+
+TEST_F(ItemEventBatcherTest, SendsFilteredGlobalItemMovements) {
+    constexpr Core::FormID Receiver = 0x7000;
+    forms.AddForm(Receiver);
+    batcher.RegisterForGlobalItemMovement(Receiver, {{ItemB}, {}});
+
+    batcher.RecordEvent(ContainerA, ContainerB, ItemA, 1);
+    batcher.RecordEvent(ContainerA, ContainerB, ItemB, 2);
+    tasks.RunFrame();
+    tasks.RunFrame();
+
+    const auto movements = SentTo(Core::ItemEventKind::kGlobalMovement, Receiver);
+    ASSERT_EQ(movements.size(), 1);
+    EXPECT_EQ(movements[0].baseItems, (std::vector<Core::FormID>{ItemB, ItemB}));
+    EXPECT_EQ(movements[0].itemCounts, (std::vector<std::int32_t>{-2, 2}));
+}
@@ -0,0 +1,90 @@
+#include "MockEngine.h"
+
+#include <WarpaintTracker.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+using namespace MockEngine;
+
+namespace {
+    constexpr Core::FormID ActorBaseA = 0x100;
+    constexpr Core::FormID ActorBaseB = 0x200;
+    constexpr Core::FormID ReceiverA = 0x1000;
+    constexpr Core::FormID ReceiverB = 0x1001;
+
+    constexpr std::array<Core::WarpaintLayer, 2> Warpaint{{{3, 0x802010, 0.5f}, {7, 0x000000, 1.0f}}};
+}  // namespace
+
+TEST(WarpaintTrackerTest, TheFirstHashOnlySeeds) {
+    Core::WarpaintTracker tracker;
+    tracker.Register(ReceiverA, ActorBaseA);
+
+    EXPECT_TRUE(tracker.UpdateHash(ActorBaseA, Core::HashWarpaintLayers(Warpaint)).empty());
+    EXPECT_TRUE(tracker.UpdateHash(ActorBaseA, Core::HashWarpaintLayers(Warpaint)).empty());
+}
+
+TEST(WarpaintTrackerTest, NotifiesAllReceiversOfChangedHashes) {
+    Core::WarpaintTracker tracker;
+    tracker.Register(ReceiverA, ActorBaseA);
+    tracker.Register(ReceiverB, ActorBaseA);
+    tracker.Register(ReceiverB, ActorBaseB);
+    (void)tracker.UpdateHash(ActorBaseA, Core::HashWarpaintLayers(Warpaint));
+
+    auto changed = Warpaint;
+    changed[1].color = 0x000001;
+    EXPECT_EQ(tracker.UpdateHash(ActorBaseA, Core::HashWarpaintLayers(changed)),
+              (std::vector<Core::FormID>{ReceiverA, ReceiverB}));
+    EXPECT_TRUE(tracker.UpdateHash(ActorBaseA, Core::HashWarpaintLayers(changed)).empty());
+}
+
+TEST(WarpaintTrackerTest, HashesTellLayersApart) {
+    const auto hash = Core::HashWarpaintLayers(Warpaint);
+
+    auto fainter = Warpaint;
+    fainter[0].interpolation = 0.25f;
+    EXPECT_NE(Core::HashWarpaintLayers(fainter), hash);
+
+    auto otherMask = Warpaint;
+    otherMask[0].tintIndex = 4;
+    EXPECT_NE(Core::HashWarpaintLayers(otherMask), hash);
+
+    const std::array<Core::WarpaintLayer, 2> reordered{Warpaint[1], Warpaint[0]};
+    EXPECT_NE(Core::HashWarpaintLayers(reordered), hash);
+
+    EXPECT_NE(Core::HashWarpaintLayers(std::span<const Core::WarpaintLayer>(Warpaint).first(1)), hash);
+}
+
+TEST(WarpaintTrackerTest, ForgetsActorBasesWithoutReceivers) {
+    Core::WarpaintTracker tracker;
+    tracker.Register(ReceiverA, ActorBaseA);
+    (void)tracker.UpdateHash(ActorBaseA, 1);
+    tracker.Unregister(ReceiverA, ActorBaseA);
+
+    EXPECT_FALSE(tracker.IsTracked(ActorBaseA));
+    EXPECT_FALSE(tracker.HasTrackedActorBases());
+    EXPECT_TRUE(tracker.UpdateHash(ActorBaseA, 2).empty());
+}
+
+TEST(WarpaintTrackerTest, HashesSurviveARoundTrip) {
+    Core::WarpaintTracker saved;
+    saved.Register(ReceiverA, ActorBaseA);
+    (void)saved.UpdateHash(ActorBaseA, 1);
+
+    InMemoryCosave cosave;
+    saved.Save(cosave);
+    cosave.Rewind();
+
+    Core::WarpaintTracker loaded;
+    std::uint32_t type;
+    std::uint32_t version;
+    std::uint32_t length;
+    while (cosave.GetNextRecordInfo(type, version, length)) {
+        EXPECT_TRUE(loaded.LoadRecord(cosave, type));
+    }
+
+    // A change while the game was not running is still noticed
+    EXPECT_EQ(loaded.UpdateHash(ActorBaseA, 2), std::vector<Core::FormID>{ReceiverA});
+}